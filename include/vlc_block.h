@@ -637,6 +637,107 @@ static inline void vlc_fifo_Cleanup(void *fifo)
 }
 #define vlc_fifo_CleanupPush(fifo) vlc_cleanup_push(vlc_fifo_Cleanup, fifo)
 
+/**
+ * @}
+ * \defgroup spsc_fifo Single producer single consumer block FIFO
+ * Lock-free block queue for exactly one producer and one consumer thread
+ *
+ * This is a faster alternative to the block FIFO when a queue only ever has
+ * one thread queueing and one thread dequeueing, such as the input of a
+ * decoder or an output thread. It does not have a lock, so it cannot be
+ * combined with other conditions as vlc_fifo_WaitCond() allows.
+ * @{
+ */
+
+typedef struct vlc_spsc_fifo vlc_spsc_fifo_t;
+
+/**
+ * Creates a single producer single consumer FIFO queue of blocks.
+ *
+ * The created queue must be released with vlc_spsc_fifo_Delete().
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API vlc_spsc_fifo_t *vlc_spsc_fifo_New(void) VLC_USED VLC_MALLOC;
+
+/**
+ * Destroys a FIFO created by vlc_spsc_fifo_New().
+ *
+ * @note Any queued blocks are also destroyed.
+ * @warning No other threads may be using the FIFO when this function is
+ * called. Otherwise, undefined behaviour will occur.
+ */
+VLC_API void vlc_spsc_fifo_Delete(vlc_spsc_fifo_t *);
+
+/**
+ * Queues a linked-list of blocks at the end of a FIFO.
+ *
+ * Each block is queued separately, as with vlc_fifo_QueueUnlocked().
+ * If the consumer is waiting in vlc_spsc_fifo_Get(), it is woken up.
+ *
+ * @note This function is not a cancellation point.
+ * @warning Only the producer thread may call this function.
+ *
+ * @param block the head of the list of blocks (may be NULL)
+ * @retval VLC_SUCCESS all blocks were queued
+ * @retval VLC_ENOMEM some blocks could not be queued and were released
+ */
+VLC_API int vlc_spsc_fifo_Queue(vlc_spsc_fifo_t *, block_t *block);
+
+/**
+ * Dequeues the first block from a FIFO, if any.
+ *
+ * @note This function is not a cancellation point.
+ * @warning Only the consumer thread may call this function.
+ *
+ * @return the first block in the FIFO or NULL if the FIFO is empty
+ */
+VLC_API block_t *vlc_spsc_fifo_Dequeue(vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Dequeues all blocks from a FIFO.
+ *
+ * @note This function is not a cancellation point.
+ * @warning Only the consumer thread may call this function.
+ *
+ * @return a linked-list of all blocks in the FIFO (possibly NULL)
+ */
+VLC_API block_t *vlc_spsc_fifo_DequeueAll(vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Dequeues the first block from the FIFO. If necessary, wait until there is
+ * one block in the queue. This function is (always) cancellation point.
+ *
+ * @warning Only the consumer thread may call this function.
+ *
+ * @return a valid block
+ */
+VLC_API block_t *vlc_spsc_fifo_Get(vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Counts blocks in a FIFO.
+ *
+ * The value is exact from the producer or consumer thread if the other one
+ * is not running concurrently, and a snapshot otherwise.
+ *
+ * @note This function is not cancellation point.
+ */
+VLC_API size_t vlc_spsc_fifo_GetCount(const vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Counts bytes in a FIFO.
+ *
+ * See vlc_spsc_fifo_GetCount().
+ *
+ * @note This function is not cancellation point.
+ */
+VLC_API size_t vlc_spsc_fifo_GetBytes(const vlc_spsc_fifo_t *) VLC_USED;
+
+VLC_USED static inline bool vlc_spsc_fifo_IsEmpty(const vlc_spsc_fifo_t *fifo)
+{
+    return vlc_spsc_fifo_GetCount(fifo) == 0;
+}
+
 /** @} */
 
 /** @} */
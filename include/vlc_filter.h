@@ -480,6 +480,42 @@ VLC_API picture_t *filter_chain_VideoFilter(filter_chain_t *chain,
  */
 VLC_API void filter_chain_VideoFlush( filter_chain_t * );
 
+/**
+ * Runs the filters of a video chain in a pipeline.
+ *
+ * The filters are split in up to \p stages groups of consecutive filters,
+ * each group running on its own thread, with bounded picture queues in
+ * between. The pipeline is started by the next filter_chain_VideoFilter()
+ * call, and stopped whenever filters are added or removed.
+ *
+ * filter_chain_VideoFilter() then queues the picture and returns a filtered
+ * picture if one is ready, without waiting for it, so the output is delayed.
+ * It blocks while the first queue is full, unless the output queue is full.
+ * As without pipeline, it must be called again with NULL until it returns
+ * NULL, to take the other output pictures, else the pipeline stalls once
+ * the output queue is full. filter_chain_VideoDrain() waits for the
+ * pictures still in the pipeline.
+ *
+ * Pictures keep their order. Flushes, mouse events and
+ * filter_chain_ForEach() are serialized with the filtering of each stage.
+ *
+ * \param chain video filter chain
+ * \param stages maximum number of threads (0 or 1 disables the pipeline)
+ */
+VLC_API void filter_chain_SetPipeline(filter_chain_t *chain, unsigned stages);
+
+/**
+ * Gets the pictures still held by a video filter chain.
+ *
+ * For a pipelined chain, this waits until a picture is filtered, or until
+ * all queued pictures have been processed. Otherwise, this is the same as
+ * filter_chain_VideoFilter() with a NULL picture.
+ *
+ * \param chain pointer to filter chain
+ * \return a filtered picture, or NULL if the chain holds no more pictures
+ */
+VLC_API picture_t *filter_chain_VideoDrain(filter_chain_t *chain);
+
 /**
  * Generate subpictures from a chain of subpicture source "filters".
  *
@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * vlc_slice.h: slice-parallel work sharing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SLICE_H
+#define VLC_SLICE_H 1
+
+/**
+ * \defgroup slice Slice dispatch
+ * \ingroup cext
+ * Splits one job, typically a picture, across several threads
+ *
+ * A slice pool owns a set of worker threads. vlc_slice_dispatch() runs a
+ * callback once per slice index, on the workers and on the calling thread,
+ * and returns when all slices are done. Slices are started in increasing
+ * index order, so a slice may wait for the progress of a lower slice.
+ * @{
+ * \file
+ * Slice dispatch functions
+ */
+
+typedef struct vlc_slice_pool vlc_slice_pool_t;
+
+/**
+ * Creates a slice pool.
+ *
+ * @param threads number of threads, including the dispatching thread,
+ *                or 0 for the number of CPUs
+ * @return the pool or NULL on error
+ */
+VLC_API vlc_slice_pool_t *vlc_slice_pool_New(unsigned threads) VLC_USED;
+
+/**
+ * Creates a slice pool sized with the "filter-threads" option of an object.
+ */
+VLC_API vlc_slice_pool_t *vlc_slice_pool_Inherit(vlc_object_t *) VLC_USED;
+#define vlc_slice_pool_Inherit(o) vlc_slice_pool_Inherit(VLC_OBJECT(o))
+
+/**
+ * Destroys a slice pool.
+ *
+ * @note No dispatch may be pending.
+ */
+VLC_API void vlc_slice_pool_Delete(vlc_slice_pool_t *);
+
+/**
+ * Gets the number of threads of a slice pool.
+ *
+ * This is the number of slices that can run concurrently.
+ *
+ * @param pool slice pool (NULL is the same as a single thread pool)
+ */
+VLC_API unsigned vlc_slice_pool_GetThreads(const vlc_slice_pool_t *pool);
+
+/**
+ * Runs slices in parallel.
+ *
+ * Calls run(opaque, index, count) for each index from 0 to count - 1, and
+ * waits for all calls to return. The calling thread runs slices too.
+ * Dispatches from different threads to the same pool are serialized.
+ *
+ * @param pool slice pool (if NULL, the slices run on the calling thread)
+ * @param count number of slices
+ */
+VLC_API void vlc_slice_dispatch(vlc_slice_pool_t *pool, unsigned count,
+                                void (*run)(void *opaque, unsigned index,
+                                            unsigned count),
+                                void *opaque);
+
+/**
+ * Computes the range of rows of a slice.
+ *
+ * The rows are split as evenly as possible, with slice boundaries on
+ * multiples of align (e.g. 2 for 4:2:0 pictures).
+ *
+ * @param first first row of the slice [OUT]
+ * @param end row after the last row of the slice [OUT]
+ */
+static inline void vlc_slice_GetRows(unsigned index, unsigned count,
+                                     unsigned rows, unsigned align,
+                                     unsigned *restrict first,
+                                     unsigned *restrict end)
+{
+    unsigned units = (rows + align - 1) / align;
+
+    *first = (unsigned)((uint64_t)units * index / count) * align;
+    *end = (unsigned)((uint64_t)units * (index + 1) / count) * align;
+    if (*first > rows)
+        *first = rows;
+    if (*end > rows)
+        *end = rows;
+}
+
+/** @} */
+
+#endif
@@ -186,6 +186,7 @@ enum sout_stream_query_e {
     SOUT_STREAM_EMPTY,    /* arg1=bool *,       res=can fail (assume true) */
     SOUT_STREAM_WANTS_SUBSTREAMS,  /* arg1=bool *, res=can fail (assume false) */
     SOUT_STREAM_ID_SPU_HIGHLIGHT,  /* arg1=void *, arg2=const vlc_spu_highlight_t *, res=can fail */
+    SOUT_STREAM_ID_DECODER_GROUP,  /* arg1=void *, arg2=const void *, res=can fail */
 };
 
 struct sout_stream_t
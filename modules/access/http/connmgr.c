@@ -102,19 +102,25 @@ struct vlc_http_mgr
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< Signaled when a connection attempt ends */
     struct vlc_http_conn *conn;
+    bool connecting; /**< A TLS connection is being established */
+    bool h2; /**< Last HTTPS connection negotiated HTTP/2 */
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
                                                const char *host, unsigned port)
 {
     (void) host; (void) port;
+    vlc_mutex_assert(&mgr->lock);
     return mgr->conn;
 }
 
 static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
                                  struct vlc_http_conn *conn)
 {
+    vlc_mutex_assert(&mgr->lock);
     assert(mgr->conn == conn);
     mgr->conn = NULL;
 
@@ -126,13 +132,21 @@ struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req)
 {
+    struct vlc_http_stream *stream = NULL;
+
+    vlc_mutex_lock(&mgr->lock);
     struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
+    if (conn != NULL)
+        stream = vlc_http_stream_open(conn, req);
+    vlc_mutex_unlock(&mgr->lock);
+
     if (conn == NULL)
         return NULL;
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req);
     if (stream != NULL)
     {
+        /* Wait for the response without the lock, so that other HTTP/2
+         * streams can be opened on the connection meanwhile. */
         struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
         if (m != NULL)
             return m;
@@ -143,7 +157,10 @@ struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
          * fine here). */
     }
     /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->conn == conn)
+        vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
     return NULL;
 }
 
@@ -154,21 +171,44 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->creds == NULL && mgr->conn != NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL; /* switch from HTTP to HTTPS not implemented */
+    }
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
             return NULL;
+        }
     }
+    vlc_mutex_unlock(&mgr->lock);
 
     /* TODO? non-idempotent request support */
     struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
     if (resp != NULL)
         return resp; /* existing connection reused */
 
+    /* Connect once, for all the requests waiting for a connection. The
+     * handshake is done without the lock, so that the requests on the
+     * current connection, if any, are not blocked meanwhile. */
+    vlc_mutex_lock(&mgr->lock);
+    while (mgr->connecting)
+        vlc_cond_wait(&mgr->wait, &mgr->lock);
+    if (mgr->conn != NULL)
+    {
+        vlc_mutex_unlock(&mgr->lock);
+        return vlc_http_mgr_reuse(mgr, host, port, req);
+    }
+    mgr->connecting = true;
+    vlc_mutex_unlock(&mgr->lock);
+
+    struct vlc_http_conn *conn = NULL;
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
     {
@@ -180,9 +220,7 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         tls = vlc_https_connect(mgr->creds, host, port, &http2);
 
     if (tls == NULL)
-        return NULL;
-
-    struct vlc_http_conn *conn;
+        goto out;
 
     /* For HTTPS, TLS-ALPN determines whether HTTP version 2.0 ("h2") or 1.1
      * ("http/1.1") is used.
@@ -197,13 +235,22 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         conn = vlc_h1_conn_create(mgr->logger, tls, false);
 
     if (unlikely(conn == NULL))
-    {
         vlc_tls_Close(tls);
-        return NULL;
+out:
+    vlc_mutex_lock(&mgr->lock);
+    mgr->connecting = false;
+    vlc_cond_broadcast(&mgr->wait);
+    if (conn != NULL)
+    {
+        if (mgr->conn != NULL) /* connected meanwhile by an HTTP request */
+            vlc_http_mgr_release(mgr, mgr->conn);
+        mgr->conn = conn;
+        mgr->h2 = http2;
     }
+    vlc_mutex_unlock(&mgr->lock);
 
-    mgr->conn = conn;
-
+    if (conn == NULL)
+        return NULL;
     return vlc_http_mgr_reuse(mgr, host, port, req);
 }
 
@@ -211,7 +258,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const char *host, unsigned port,
                                              const struct vlc_http_msg *req)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    bool https = mgr->creds != NULL && mgr->conn != NULL;
+    vlc_mutex_unlock(&mgr->lock);
+    if (https)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
@@ -252,7 +302,11 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->conn != NULL) /* connected meanwhile by another request */
+        vlc_http_mgr_release(mgr, mgr->conn);
     mgr->conn = conn;
+    vlc_mutex_unlock(&mgr->lock);
     return resp;
 }
 
@@ -271,6 +325,14 @@ struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
     return mgr->jar;
 }
 
+bool vlc_http_mgr_is_h2(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool h2 = mgr->h2;
+    vlc_mutex_unlock(&mgr->lock);
+    return h2;
+}
+
 struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
                                          struct vlc_http_cookie_jar_t *jar)
 {
@@ -282,14 +344,20 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
+    vlc_mutex_init(&mgr->lock);
+    vlc_cond_init(&mgr->wait);
     mgr->conn = NULL;
+    mgr->connecting = false;
+    mgr->h2 = false;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
+    vlc_mutex_lock(&mgr->lock);
     if (mgr->conn != NULL)
         vlc_http_mgr_release(mgr, mgr->conn);
+    vlc_mutex_unlock(&mgr->lock);
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
@@ -38,7 +38,8 @@ struct vlc_http_cookie_jar_t;
  *
  * Sends an HTTP request, by either reusing an existing HTTP connection or
  * establishing a new one. If succesful, the initial HTTP response header is
- * returned.
+ * returned. This can be called from several threads: the response is waited
+ * for without blocking the other requests.
  *
  * @param mgr HTTP connection manager
  * @param https whether to use HTTPS (true) or unencrypted HTTP (false)
@@ -54,6 +55,14 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Tells whether the last HTTPS connection negotiated HTTP/2
+ *
+ * Only HTTP/2 connections serve concurrent requests. The manager keeps a
+ * single connection, which concurrent HTTP/1.x requests would replace.
+ */
+bool vlc_http_mgr_is_h2(struct vlc_http_mgr *);
+
 /**
  * Creates an HTTP connection manager
  *
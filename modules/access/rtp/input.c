@@ -45,11 +45,13 @@
 #endif
 
 #define DEFAULT_MRU (1500u - (20 + 8))
+#define MRU_MAX 65535u
 
 /**
- * Processes a packet received from the RTP socket.
+ * Checks and decrypts a packet received from the RTP socket.
+ * @return the packet to queue, or NULL if it was dropped.
  */
-static void rtp_process (demux_t *demux, block_t *block)
+static block_t *rtp_preprocess (demux_t *demux, block_t *block)
 {
     demux_sys_t *sys = demux->p_sys;
 
@@ -78,11 +80,22 @@ static void rtp_process (demux_t *demux, block_t *block)
         rtp_autodetect (demux, sys->session, block);
         sys->autodetect = false;
     }
-
-    rtp_queue (demux, sys->session, block);
-    return;
+    return block;
 drop:
     block_Release (block);
+    return NULL;
+}
+
+/**
+ * Processes a packet received from the RTP socket.
+ */
+static void rtp_process (demux_t *demux, block_t *block)
+{
+    demux_sys_t *sys = demux->p_sys;
+
+    block = rtp_preprocess (demux, block);
+    if (block != NULL)
+        rtp_queue (demux, sys->session, block);
 }
 
 static int rtp_timeout (vlc_tick_t deadline)
@@ -100,6 +113,105 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+#ifdef HAVE_RECVMMSG
+/* Maximum number of packets received with a single system call */
+# define RTP_BATCH 32
+
+struct rtp_batch
+{
+    block_t *blocks[RTP_BATCH];
+    struct mmsghdr msgs[RTP_BATCH];
+    struct iovec iovecs[RTP_BATCH];
+};
+
+static void rtp_batch_cleanup (void *data)
+{
+    struct rtp_batch *batch = data;
+
+    if (batch == NULL)
+        return;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (batch->blocks[i] != NULL)
+            block_Release (batch->blocks[i]);
+    free (batch);
+}
+
+/**
+ * Receives all pending packets from the RTP socket, up to RTP_BATCH,
+ * and queues them at once.
+ * @return 0 on success, -1 if the receive buffers cannot be allocated.
+ */
+static int rtp_recv_batch (demux_t *demux, int fd, struct rtp_batch *batch,
+                           size_t *restrict mru)
+{
+    demux_sys_t *sys = demux->p_sys;
+    block_t *queue[RTP_BATCH];
+    size_t count = 0;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+    {
+        block_t *block = batch->blocks[i];
+
+        if (block != NULL && block->i_buffer < *mru)
+        {   /* MRU was increased since the allocation */
+            block_Release (block);
+            block = NULL;
+        }
+
+        if (block == NULL)
+        {
+            block = block_Alloc (*mru);
+            if (unlikely(block == NULL))
+            {
+                if (*mru == DEFAULT_MRU)
+                    return -1; /* we are totallly screwed */
+                *mru = DEFAULT_MRU;
+                return 0; /* retry with shrunk MRU */
+            }
+            batch->blocks[i] = block;
+        }
+
+        batch->iovecs[i].iov_base = block->p_buffer;
+        batch->iovecs[i].iov_len = block->i_buffer;
+        batch->msgs[i].msg_hdr.msg_iov = &batch->iovecs[i];
+        batch->msgs[i].msg_hdr.msg_iovlen = 1;
+        batch->msgs[i].msg_hdr.msg_flags = 0;
+    }
+
+    int n = recvmmsg (fd, batch->msgs, RTP_BATCH, MSG_DONTWAIT, NULL);
+    if (n == -1)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            msg_Warn (demux, "RTP network error: %s", vlc_strerror_c(errno));
+        return 0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        block_t *block = batch->blocks[i];
+        size_t len = batch->msgs[i].msg_len;
+
+        batch->blocks[i] = NULL;
+        if (batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+        {
+            msg_Err (demux, "packet truncated (MRU was %zu)", *mru);
+            block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            *mru = MRU_MAX;
+        }
+        else
+            block->i_buffer = len;
+
+        block = rtp_preprocess (demux, block);
+        if (block != NULL)
+            queue[count++] = block;
+    }
+
+    rtp_queue_batch (demux, sys->session, queue, count);
+    return 0;
+}
+#endif
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -129,6 +241,15 @@ void *rtp_dgram_thread (void *opaque)
     ufd[0].fd = rtp_fd;
     ufd[0].events = POLLIN;
 
+#ifdef HAVE_RECVMMSG
+    struct rtp_batch *batch = NULL;
+    size_t mru = DEFAULT_MRU;
+
+    if (var_InheritBool (demux, "rtp-batch"))
+        batch = calloc (1, sizeof (*batch));
+    vlc_cleanup_push (rtp_batch_cleanup, batch);
+#endif
+
     for (;;)
     {
         int n = poll (ufd, 1, rtp_timeout (deadline));
@@ -145,6 +266,15 @@ void *rtp_dgram_thread (void *opaque)
             if (unlikely(ufd[0].revents & POLLHUP))
                 break; /* RTP socket dead (DCCP only) */
 
+#ifdef HAVE_RECVMMSG
+            if (batch != NULL)
+            {
+                if (rtp_recv_batch (demux, rtp_fd, batch, &mru))
+                    break;
+                goto dequeue;
+            }
+#endif
+
             block_t *block = block_Alloc (iov.iov_len);
             if (unlikely(block == NULL))
             {
@@ -185,6 +315,10 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_pop ();
+    rtp_batch_cleanup (batch);
+#endif
     return NULL;
 }
 
@@ -82,6 +82,11 @@
     "(between 96 and 127) if it can't be determined otherwise with " \
     "out-of-band mappings (SDP)" )
 
+#define RTP_BATCH_TEXT N_("Receive RTP packets in batches")
+#define RTP_BATCH_LONGTEXT N_( \
+    "Receive all pending RTP packets with a single system call, and queue " \
+    "them at once. This reduces the CPU load of high bit rate streams." )
+
 static const char *const dynamic_pt_list[] = { "theora" };
 static const char *const dynamic_pt_list_text[] = { "Theora Encoded Video" };
 
@@ -125,6 +130,9 @@ vlc_module_begin ()
     add_string ("rtp-dynamic-pt", NULL, RTP_DYNAMIC_PT_TEXT,
                 RTP_DYNAMIC_PT_LONGTEXT, true)
         change_string_list (dynamic_pt_list, dynamic_pt_list_text)
+#ifdef HAVE_RECVMMSG
+    add_bool ("rtp-batch", true, RTP_BATCH_TEXT, RTP_BATCH_LONGTEXT, true)
+#endif
 
     /*add_shortcut ("sctp")*/
     add_shortcut ("dccp", "rtptcp", /* "tcp" is already taken :( */
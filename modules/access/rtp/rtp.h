@@ -54,6 +54,7 @@ void xiph_decode (demux_t *demux, void *data, block_t *block);
 rtp_session_t *rtp_session_create (demux_t *);
 void rtp_session_destroy (demux_t *, rtp_session_t *);
 void rtp_queue (demux_t *, rtp_session_t *, block_t *);
+void rtp_queue_batch (demux_t *, rtp_session_t *, block_t *const *, size_t);
 bool rtp_dequeue (demux_t *, const rtp_session_t *, vlc_tick_t *);
 void rtp_dequeue_force (demux_t *, const rtp_session_t *);
 int rtp_add_type (demux_t *demux, rtp_session_t *ses, const rtp_pt_t *pt);
@@ -228,15 +228,21 @@ rtp_find_ptype (const rtp_session_t *session, rtp_source_t *source,
     return NULL;
 }
 
+/** Position of the last packet queued by rtp_queue_hinted() */
+struct rtp_queue_hint
+{
+    rtp_source_t *src;
+    block_t     **pp; /**< link to the last queued packet */
+};
+
 /**
  * Receives an RTP packet and queues it. Not a cancellation point.
- *
- * @param demux VLC demux object
- * @param session RTP session receiving the packet
- * @param block RTP packet including the RTP header
+ * If a hint is provided, the re-ordering queue lookup starts from the
+ * previously queued packet when possible.
  */
-void
-rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
+static void
+rtp_queue_hinted (demux_t *demux, rtp_session_t *session, block_t *block,
+                  struct rtp_queue_hint *hint)
 {
     demux_sys_t *p_sys = demux->p_sys;
 
@@ -274,6 +280,8 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         /* RTP source garbage collection */
         if ((tmp->last_rx + p_sys->timeout) < now)
         {
+            if (hint != NULL && hint->src == tmp)
+                hint->src = NULL;
             rtp_source_destroy (demux, session, tmp);
             if (--session->srcc > 0)
                 session->srcv[i] = session->srcv[session->srcc - 1];
@@ -339,6 +347,8 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
             msg_Warn (demux, "sequence resynchronized");
             block_ChainRelease (src->blocks);
             src->blocks = NULL;
+            if (hint != NULL && hint->src == src)
+                hint->src = NULL;
         }
         else
         {
@@ -353,6 +363,13 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     /* Queues the block in sequence order,
      * hence there is a single queue for all payload types. */
     block_t **pp = &src->blocks;
+
+    /* Packets mostly come in order: resume after the previous packet of the
+     * batch if it is earlier in sequence. */
+    if (hint != NULL && hint->src == src && hint->pp != NULL
+     && *hint->pp != NULL && (int16_t)(seq - rtp_seq (*hint->pp)) > 0)
+        pp = hint->pp;
+
     for (block_t *prev = *pp; prev != NULL; prev = *pp)
     {
         delta_seq = seq - rtp_seq (prev);
@@ -368,6 +385,12 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     block->p_next = *pp;
     *pp = block;
 
+    if (hint != NULL)
+    {
+        hint->src = src;
+        hint->pp = pp;
+    }
+
     /*rtp_decode (demux, session, src);*/
     return;
 
@@ -375,6 +398,39 @@ drop:
     block_Release (block);
 }
 
+/**
+ * Receives an RTP packet and queues it. Not a cancellation point.
+ *
+ * @param demux VLC demux object
+ * @param session RTP session receiving the packet
+ * @param block RTP packet including the RTP header
+ */
+void
+rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
+{
+    rtp_queue_hinted (demux, session, block, NULL);
+}
+
+/**
+ * Receives a batch of RTP packets and queues them. Not a cancellation point.
+ * The re-ordering queues are walked once for the whole batch if the packets
+ * are in sequence order, rather than once per packet.
+ *
+ * @param demux VLC demux object
+ * @param session RTP session receiving the packets
+ * @param blocks RTP packets including the RTP header
+ * @param count number of packets
+ */
+void
+rtp_queue_batch (demux_t *demux, rtp_session_t *session,
+                 block_t *const *blocks, size_t count)
+{
+    struct rtp_queue_hint hint = { NULL, NULL };
+
+    for (size_t i = 0; i < count; i++)
+        rtp_queue_hinted (demux, session, blocks[i], &hint);
+}
+
 
 static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 
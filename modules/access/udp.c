@@ -35,6 +35,8 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
@@ -53,10 +55,36 @@
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Initial size of the batch receive buffers. This covers a full Ethernet
+ * frame. If a larger datagram shows up, the buffers are grown to MRU. */
+# define UDP_SLOT_SIZE 2048u
+# define UDP_BATCH_MAX 256
+
+struct udp_batch {
+    unsigned count; /* number of slots */
+    unsigned head; /* next received block to hand out */
+    unsigned tail; /* number of received blocks in the ring */
+    size_t slot_size;
+
+    block_t **blocks;
+    struct mmsghdr *msgs;
+    struct iovec *iovecs;
+
+    /* statistics */
+    uint64_t calls;
+    uint64_t datagrams;
+    unsigned max_fill;
+};
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
+#ifdef HAVE_RECVMMSG
+    struct udp_batch batch;
+#endif
     size_t length;
     char *offset;
     char buf[MRU];
@@ -132,6 +160,132 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
     return val;
 }
 
+#ifdef HAVE_RECVMMSG
+static int BatchInit(stream_t *access, struct udp_batch *b, unsigned count)
+{
+    b->count = count;
+    b->head = b->tail = 0;
+    b->slot_size = UDP_SLOT_SIZE;
+    b->calls = b->datagrams = 0;
+    b->max_fill = 0;
+
+    b->blocks = vlc_obj_calloc(VLC_OBJECT(access), count, sizeof (*b->blocks));
+    b->msgs = vlc_obj_calloc(VLC_OBJECT(access), count, sizeof (*b->msgs));
+    b->iovecs = vlc_obj_calloc(VLC_OBJECT(access), count, sizeof (*b->iovecs));
+    if (unlikely(b->blocks == NULL || b->msgs == NULL || b->iovecs == NULL))
+        return VLC_ENOMEM;
+
+    for (unsigned i = 0; i < count; i++) {
+        b->msgs[i].msg_hdr.msg_iov = &b->iovecs[i];
+        b->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    return VLC_SUCCESS;
+}
+
+static void BatchClean(struct udp_batch *b)
+{
+    for (unsigned i = 0; i < b->count; i++)
+        if (b->blocks[i] != NULL)
+            block_Release(b->blocks[i]);
+}
+
+/**
+ * Refills the empty slots of the ring, then receives as many pending
+ * datagrams as possible with a single system call.
+ *
+ * \return the number of received datagrams, 0 if none was pending,
+ * or -1 on fatal error.
+ */
+static int BatchRecv(stream_t *access, struct udp_batch *b, int fd)
+{
+    for (unsigned i = 0; i < b->count; i++) {
+        block_t *block = b->blocks[i];
+
+        if (block != NULL && block->i_size < b->slot_size) {
+            block_Release(block);
+            block = NULL;
+        }
+
+        if (block == NULL) {
+            block = block_Alloc(b->slot_size);
+            if (unlikely(block == NULL)) {
+                b->blocks[i] = NULL;
+                return -1;
+            }
+            b->blocks[i] = block;
+        }
+
+        b->iovecs[i].iov_base = block->p_buffer;
+        b->iovecs[i].iov_len = block->i_buffer;
+        b->msgs[i].msg_hdr.msg_flags = 0;
+    }
+
+    int val = recvmmsg(fd, b->msgs, b->count, MSG_DONTWAIT, NULL);
+    if (val < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+               ? 0 : -1;
+
+    b->calls++;
+    b->datagrams += val;
+    if ((unsigned)val > b->max_fill)
+        b->max_fill = val;
+
+    unsigned n = 0;
+
+    for (int i = 0; i < val; i++) {
+        block_t *block = b->blocks[i];
+
+        if (b->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            /* The datagram is lost. Grow the buffers for the next batch. */
+            msg_Warn(access, "datagram larger than %zu bytes truncated",
+                     b->slot_size);
+            b->slot_size = MRU;
+            block_Release(block);
+            b->blocks[i] = NULL;
+            continue;
+        }
+
+        block->i_buffer = b->msgs[i].msg_len;
+        b->blocks[i] = NULL;
+        b->blocks[n++] = block; /* pack received blocks in order */
+    }
+
+    b->head = 0;
+    b->tail = n;
+    return n;
+}
+
+static block_t *BlockRecv(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    struct udp_batch *b = &sys->batch;
+
+    if (b->head >= b->tail) {
+        struct pollfd ufd[1];
+
+        ufd[0].fd = sys->fd;
+        ufd[0].events = POLLIN;
+
+        switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+            case 0:
+                msg_Err(access, "receive time-out");
+                *eof = true;
+                /* fall through */
+            case -1:
+                return NULL;
+        }
+
+        if (BatchRecv(access, b, sys->fd) <= 0)
+            return NULL;
+    }
+
+    block_t *block = b->blocks[b->head];
+
+    b->blocks[b->head++] = NULL;
+    return block;
+}
+#endif
+
 /*****************************************************************************
  * Open: open the socket
  *****************************************************************************/
@@ -217,6 +371,28 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch.count = 0;
+
+    int64_t i_batch = var_InheritInteger( p_access, "udp-batch" );
+    if( i_batch > 1 )
+    {
+        if( i_batch > UDP_BATCH_MAX )
+            i_batch = UDP_BATCH_MAX;
+
+        if( BatchInit( p_access, &sys->batch, i_batch ) )
+        {
+            net_Close( sys->fd );
+            return VLC_ENOMEM;
+        }
+
+        p_access->pf_read = NULL;
+        p_access->pf_block = BlockRecv;
+        msg_Dbg( p_access, "receiving up to %"PRId64" datagrams per call",
+                 i_batch );
+    }
+#endif
+
     return VLC_SUCCESS;
 }
 
@@ -228,10 +404,26 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    struct udp_batch *b = &sys->batch;
+
+    if( b->count > 0 )
+    {
+        if( b->calls > 0 )
+            msg_Dbg( p_access, "received %"PRIu64" datagrams in %"PRIu64
+                     " calls (average %.1f, max %u per call)", b->datagrams,
+                     b->calls, (double)b->datagrams / b->calls, b->max_fill );
+        BatchClean( b );
+    }
+#endif
     net_Close( sys->fd );
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Receive batch size")
+#define BATCH_LONGTEXT N_( \
+    "Maximum number of datagrams received with a single system call. " \
+    "Set to 0 or 1 to receive one datagram at a time." )
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -242,6 +434,10 @@ vlc_module_begin()
     add_obsolete_integer("server-port") /* since 2.0.0 */
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL, true)
+#ifdef HAVE_RECVMMSG
+    add_integer_with_range("udp-batch", 32, 0, UDP_BATCH_MAX,
+                           BATCH_TEXT, BATCH_LONGTEXT, true)
+#endif
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
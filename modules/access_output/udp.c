@@ -70,6 +70,12 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define BATCH_TEXT N_("Batch window (ms)")
+#define BATCH_LONGTEXT N_("Packets due within this time window are sent " \
+                          "with a single system call. Larger values lower " \
+                          "the CPU load at the expense of pacing accuracy. " \
+                          "Set to 0 to send packets one by one." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -78,6 +84,10 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+#ifdef HAVE_SENDMMSG
+    add_integer_with_range( SOUT_CFG_PREFIX "batch", 0, 0, 100,
+                            BATCH_TEXT, BATCH_LONGTEXT, true )
+#endif
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -91,6 +101,9 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+#ifdef HAVE_SENDMMSG
+    "batch",
+#endif
     NULL
 };
 
@@ -106,6 +119,12 @@ static ssize_t Write   ( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
+#ifdef HAVE_SENDMMSG
+static void* ThreadWriteBatch( void * );
+
+/* Maximum number of datagrams per sendmmsg() call */
+#define BATCH_MAX 64
+#endif
 
 typedef struct
 {
@@ -117,6 +136,9 @@ typedef struct
     block_fifo_t *p_fifo;
     block_t      *p_buffer;
 
+#ifdef HAVE_SENDMMSG
+    vlc_tick_t    i_batch_window;
+#endif
     vlc_thread_t  thread;
 } sout_access_out_sys_t;
 
@@ -209,7 +231,15 @@ static int Open( vlc_object_t *p_this )
     p_sys->p_fifo = block_FifoNew();
     p_sys->p_buffer = NULL;
 
-    if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
+    void *(*pf_thread)( void * ) = ThreadWrite;
+#ifdef HAVE_SENDMMSG
+    p_sys->i_batch_window = VLC_TICK_FROM_MS(
+                     var_GetInteger( p_access, SOUT_CFG_PREFIX "batch" ) );
+    if( p_sys->i_batch_window > 0 )
+        pf_thread = ThreadWriteBatch;
+#endif
+
+    if( vlc_clone( &p_sys->thread, pf_thread, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
@@ -419,3 +449,163 @@ static void* ThreadWrite( void *data )
     }
     return NULL;
 }
+
+#ifdef HAVE_SENDMMSG
+struct udp_batch
+{
+    block_t *p_held; /* first packet of the next batch */
+    block_t *pp_pk[BATCH_MAX];
+    unsigned i_count;
+};
+
+static void BatchCleanup( void *data )
+{
+    struct udp_batch *b = data;
+
+    for( unsigned i = 0; i < b->i_count; i++ )
+        block_Release( b->pp_pk[i] );
+    b->i_count = 0;
+    if( b->p_held != NULL )
+        block_Release( b->p_held );
+    b->p_held = NULL;
+}
+
+/*****************************************************************************
+ * ThreadWriteBatch: Write the packets due in the batch window at once.
+ *****************************************************************************
+ * As in ThreadWrite(), packets are sent by groups, waiting only for the date
+ * of the last packet of each group, and always for the date of a packet
+ * carrying a clock reference: the batch ends before such a packet.
+ *****************************************************************************/
+static void* ThreadWriteBatch( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    const vlc_tick_t i_window = p_sys->i_batch_window;
+    const unsigned i_group = __MAX( 1, var_GetInteger( p_access,
+                                                SOUT_CFG_PREFIX "group" ) );
+    struct udp_batch batch = { .p_held = NULL, .i_count = 0 };
+    struct mmsghdr msgs[BATCH_MAX];
+    struct iovec iov[BATCH_MAX];
+    vlc_tick_t i_date_last = -1;
+    unsigned i_dropped_packets = 0;
+
+    memset( msgs, 0, sizeof( msgs ) );
+    for( unsigned i = 0; i < BATCH_MAX; i++ )
+    {
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    vlc_cleanup_push( BatchCleanup, &batch );
+    for (;;)
+    {
+        block_t *p_pk = batch.p_held;
+        vlc_tick_t i_date;
+
+        batch.p_held = NULL;
+        if( p_pk == NULL )
+            p_pk = block_FifoGet( p_sys->p_fifo );
+
+        i_date = p_sys->i_caching + p_pk->i_dts;
+        if( i_date_last > 0 && i_date - i_date_last > VLC_TICK_FROM_SEC(2) )
+        {
+            if( !i_dropped_packets )
+                msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                         i_date - i_date_last );
+
+            block_Release( p_pk );
+
+            i_date_last = i_date;
+            i_dropped_packets++;
+            continue;
+        }
+
+        batch.pp_pk[batch.i_count++] = p_pk;
+        i_date_last = i_date;
+
+        /* Complete the group with the queued packets */
+        vlc_fifo_Lock( p_sys->p_fifo );
+        while( batch.i_count < __MIN( i_group, BATCH_MAX )
+            && !(p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+        {
+            p_pk = vlc_fifo_DequeueUnlocked( p_sys->p_fifo );
+            if( p_pk == NULL )
+                break;
+
+            i_date = p_sys->i_caching + p_pk->i_dts;
+            if( i_date - i_date_last > VLC_TICK_FROM_SEC(2) )
+            {
+                batch.p_held = p_pk;
+                break;
+            }
+            batch.pp_pk[batch.i_count++] = p_pk;
+            i_date_last = i_date;
+        }
+        vlc_fifo_Unlock( p_sys->p_fifo );
+
+        vlc_tick_wait( i_date_last );
+
+        /* Collect the queued packets that are due within the window */
+        const vlc_tick_t i_deadline = vlc_tick_now() + i_window;
+
+        vlc_fifo_Lock( p_sys->p_fifo );
+        while( batch.p_held == NULL && batch.i_count < BATCH_MAX )
+        {
+            p_pk = vlc_fifo_DequeueUnlocked( p_sys->p_fifo );
+            if( p_pk == NULL )
+                break;
+
+            i_date = p_sys->i_caching + p_pk->i_dts;
+            if( i_date > i_deadline
+             || i_date - i_date_last > VLC_TICK_FROM_SEC(2)
+             || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+            {
+                batch.p_held = p_pk;
+                break;
+            }
+            batch.pp_pk[batch.i_count++] = p_pk;
+            i_date_last = i_date;
+        }
+        vlc_fifo_Unlock( p_sys->p_fifo );
+
+        for( unsigned i = 0; i < batch.i_count; i++ )
+        {
+            iov[i].iov_base = batch.pp_pk[i]->p_buffer;
+            iov[i].iov_len = batch.pp_pk[i]->i_buffer;
+        }
+
+        for( unsigned i_done = 0; i_done < batch.i_count; )
+        {
+            int val = sendmmsg( p_sys->i_handle, msgs + i_done,
+                                batch.i_count - i_done, 0 );
+            if( val <= 0 )
+            {
+                /* Skip the packet that failed */
+                msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+                val = 1;
+            }
+            i_done += val;
+        }
+
+        if( i_dropped_packets )
+        {
+            msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
+            i_dropped_packets = 0;
+        }
+
+        i_date = vlc_tick_now() - i_date_last;
+        if ( i_date > VLC_TICK_FROM_MS(20) )
+        {
+            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                     i_date );
+        }
+
+        for( unsigned i = 0; i < batch.i_count; i++ )
+            block_Release( batch.pp_pk[i] );
+        batch.i_count = 0;
+    }
+    vlc_cleanup_pop();
+    return NULL;
+}
+#endif
@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/HybridAdaptationLogic.hpp"
 #include "logic/BufferingLogic.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_stream.h>
@@ -816,6 +817,16 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             if(predictivelogic)
                 conn->setDownloadRateObserver(predictivelogic);
             logic = predictivelogic;
+            break;
+        }
+        case AbstractAdaptationLogic::Hybrid:
+        {
+            HybridAdaptationLogic *hybridlogic =
+                    new (std::nothrow) HybridAdaptationLogic(obj);
+            if(hybridlogic)
+                conn->setDownloadRateObserver(hybridlogic);
+            logic = hybridlogic;
+            break;
         }
 
         default:
@@ -842,6 +853,7 @@ AbstractBufferingLogic *PlaylistManager::createBufferingLogic() const
         v = var_InheritInteger(p_demux, "adaptive-maxbuffer");
         if(v)
             bl->setUserMaxBuffering(VLC_TICK_FROM_MS(v));
+        bl->setUserLookahead(var_InheritInteger(p_demux, "adaptive-lookahead"));
     }
     return bl;
 }
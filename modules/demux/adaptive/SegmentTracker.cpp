@@ -164,6 +164,7 @@ bool SegmentTracker::segmentsListReady() const
 
 void SegmentTracker::reset()
 {
+    flushLookahead();
     notify(SegmentTrackerEvent(curRepresentation, NULL));
     curRepresentation = NULL;
     init_sent = false;
@@ -202,6 +203,8 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
 
     if(rep != curRepresentation)
     {
+        /* Cancel the downloads of the previous representation */
+        flushLookahead();
         notify(SegmentTrackerEvent(curRepresentation, rep));
         prevRep = curRepresentation;
         curRepresentation = rep;
@@ -262,7 +265,13 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         init_sent = true;
         segment = rep->getSegment(BaseRepresentation::INFOTYPE_INIT);
         if(segment)
-            return segment->toChunk(resources, connManager, next, rep);
+        {
+            SegmentChunk *chunk = segment->toChunk(resources, connManager, next, rep);
+            /* Media segments are only known after the index is loaded */
+            if(chunk && !rep->getSegment(BaseRepresentation::INFOTYPE_INDEX))
+                fillLookahead(rep, connManager);
+            return chunk;
+        }
     }
 
     if(!index_sent)
@@ -274,10 +283,35 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     }
 
     bool b_gap = false;
-    segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
-    if(!segment)
+    SegmentChunk *chunk;
+    vlc_tick_t duration = 0;
+    if(!lookahead.empty() && lookahead.front().rep == rep &&
+       lookahead.front().requested == next)
     {
-        return NULL;
+        const PrefetchedChunk &prefetched = lookahead.front();
+        chunk = prefetched.chunk;
+        next = prefetched.number;
+        b_gap = prefetched.gap;
+        duration = prefetched.duration;
+        lookahead.pop_front();
+    }
+    else
+    {
+        /* Not the sequence we prefetched */
+        flushLookahead();
+
+        segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
+        if(!segment)
+        {
+            return NULL;
+        }
+
+        chunk = segment->toChunk(resources, connManager, next, rep);
+        if(chunk)
+        {
+            const Timescale timescale = rep->inheritTimescale();
+            duration = timescale.ToTime(segment->duration.Get());
+        }
     }
 
     if(initializing)
@@ -287,14 +321,10 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         initializing = false;
     }
 
-    SegmentChunk *chunk = segment->toChunk(resources, connManager, next, rep);
-
     /* Notify new segment length for stats / logic */
     if(chunk)
     {
-        const Timescale timescale = rep->inheritTimescale();
-        notify(SegmentTrackerEvent(rep->getAdaptationSet()->getID(),
-                                   timescale.ToTime(segment->duration.Get())));
+        notify(SegmentTrackerEvent(rep->getAdaptationSet()->getID(), duration));
     }
 
     /* We need to check segment/chunk format changes, as we can't rely on representation's (HLS)*/
@@ -314,11 +344,55 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     {
         curNumber = next;
         next++;
+        fillLookahead(rep, connManager);
     }
 
     return chunk;
 }
 
+void SegmentTracker::fillLookahead(BaseRepresentation *rep,
+                                   AbstractConnectionManager *connManager)
+{
+    uint64_t number = lookahead.empty() ? next : lookahead.back().number + 1;
+
+    while(lookahead.size() < bufferingLogic->getLookahead())
+    {
+        PrefetchedChunk prefetched;
+        prefetched.rep = rep;
+        prefetched.requested = number;
+        prefetched.gap = false;
+
+        ISegment *segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA,
+                                                number, &prefetched.number,
+                                                &prefetched.gap);
+        if(!segment)
+            break;
+
+        /* Never request beyond the live edge */
+        if(rep->getPlaylist()->isLive() && rep->getMinAheadTime(prefetched.number) == 0)
+            break;
+
+        prefetched.chunk = segment->toChunk(resources, connManager, prefetched.number, rep);
+        if(!prefetched.chunk)
+            break;
+
+        const Timescale timescale = rep->inheritTimescale();
+        prefetched.duration = timescale.ToTime(segment->duration.Get());
+        lookahead.push_back(prefetched);
+        number = prefetched.number + 1;
+    }
+}
+
+void SegmentTracker::flushLookahead()
+{
+    /* Deleting the chunks cancels their downloads */
+    while(!lookahead.empty())
+    {
+        delete lookahead.front().chunk;
+        lookahead.pop_front();
+    }
+}
+
 bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool tryonly)
 {
     uint64_t segnumber;
@@ -346,6 +420,8 @@ bool SegmentTracker::setPositionByTime(vlc_tick_t time, bool restarted, bool try
 
 void SegmentTracker::setPositionByNumber(uint64_t segnumber, bool restarted)
 {
+    if(restarted || segnumber != next)
+        flushLookahead();
     if(restarted)
     {
         initializing = true;
@@ -142,8 +142,20 @@ namespace adaptive
             bool bufferingAvailable() const;
 
         private:
+            class PrefetchedChunk
+            {
+                public:
+                    SegmentChunk *chunk;
+                    BaseRepresentation *rep;
+                    uint64_t requested; /* number it was looked up with */
+                    uint64_t number;
+                    bool gap;
+                    vlc_tick_t duration;
+            };
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const SegmentTrackerEvent &) const;
+            void fillLookahead(BaseRepresentation *, AbstractConnectionManager *);
+            void flushLookahead();
             bool first;
             bool initializing;
             bool index_sent;
@@ -157,6 +169,7 @@ namespace adaptive
             BaseAdaptationSet *adaptationSet;
             BaseRepresentation *curRepresentation;
             std::list<SegmentTrackerListenerInterface *> listeners;
+            std::list<PrefetchedChunk> lookahead; /* already downloading */
     };
 }
 
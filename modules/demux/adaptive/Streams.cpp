@@ -677,6 +677,19 @@ void AbstractStream::trackerEvent(const SegmentTrackerEvent &event)
             }
             break;
 
+        case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+            /* Lets the downloader favor the most starving stream */
+            if(connManager)
+                connManager->updateBufferingLevel(*event.u.buffering_level.id,
+                                                  event.u.buffering_level.current,
+                                                  event.u.buffering_level.target);
+            break;
+
+        case SegmentTrackerEvent::BUFFERING_STATE:
+            if(connManager && !event.u.buffering.enabled)
+                connManager->removeBufferingLevel(*event.u.buffering.id);
+            break;
+
         default:
             break;
     }
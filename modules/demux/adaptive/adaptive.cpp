@@ -82,6 +82,18 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
+#define ADAPT_DOWNLOADS_TEXT N_("Concurrent downloads")
+#define ADAPT_DOWNLOADS_LONGTEXT N_("Maximum number of segments downloaded at once. " \
+                                    "The most starving stream is downloaded first.")
+
+#define ADAPT_HTTP2_TEXT N_("Use HTTP/2")
+#define ADAPT_HTTP2_LONGTEXT N_("Send the HTTPS requests as HTTP/2 streams of a " \
+                                "single connection, when the server supports it")
+
+#define ADAPT_LOOKAHEAD_TEXT N_("Segments lookahead")
+#define ADAPT_LOOKAHEAD_LONGTEXT N_("Number of upcoming segments downloaded " \
+                                    "ahead of the current one")
+
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
@@ -89,6 +101,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
                                 AbstractAdaptationLogic::NearOptimal,
+                                AbstractAdaptationLogic::Hybrid,
                                 AbstractAdaptationLogic::RateBased,
                                 AbstractAdaptationLogic::FixedRate,
                                 AbstractAdaptationLogic::AlwaysLowest,
@@ -98,6 +111,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "hybrid",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -106,6 +120,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Hybrid Bandwidth/Buffer"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -137,12 +152,19 @@ vlc_module_begin ()
                      ADAPT_HEIGHT_TEXT, ADAPT_HEIGHT_TEXT, false )
         add_integer( "adaptive-bw",     250, ADAPT_BW_TEXT,     ADAPT_BW_LONGTEXT,     false )
         add_bool   ( "adaptive-use-access", false, ADAPT_ACCESS_TEXT, ADAPT_ACCESS_LONGTEXT, true );
+        add_bool   ( "adaptive-http2", true, ADAPT_HTTP2_TEXT, ADAPT_HTTP2_LONGTEXT, true );
         add_integer( "adaptive-livedelay",
                      MS_FROM_VLC_TICK(AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING),
                      ADAPT_BUFFER_TEXT, ADAPT_BUFFER_LONGTEXT, true );
         add_integer( "adaptive-maxbuffer",
                      MS_FROM_VLC_TICK(AbstractBufferingLogic::DEFAULT_MAX_BUFFERING),
                      ADAPT_MAXBUFFER_TEXT, NULL, true );
+        add_integer( "adaptive-downloads", 3,
+                     ADAPT_DOWNLOADS_TEXT, ADAPT_DOWNLOADS_LONGTEXT, true );
+            change_integer_range( 1, 8 )
+        add_integer( "adaptive-lookahead", 1,
+                     ADAPT_LOOKAHEAD_TEXT, ADAPT_LOOKAHEAD_LONGTEXT, true )
+            change_integer_range( 0, 10 )
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT, true );
             change_integer_list(rgi_latency, ppsz_latency)
         set_callbacks( Open, Close )
@@ -222,10 +222,11 @@ block_t * HTTPChunkSource::read(size_t readsize)
     {
         p_block->i_buffer = (size_t) ret;
         consumed += p_block->i_buffer;
-        if((size_t)ret < readsize)
+        /* connections can return data before filling the whole request */
+        if(ret == 0 || (contentLength && consumed >= contentLength))
             eof = true;
         if(ret && time)
-            connManager->updateDownloadRate(sourceid, p_block->i_buffer, time);
+            connManager->updateDownloadRate(sourceid, p_block->i_buffer, time, 1);
     }
 
     return p_block;
@@ -265,13 +266,10 @@ bool HTTPChunkSource::prepare()
         {
             if(requeststatus == RequestStatus::Redirection)
             {
-                HTTPConnection *httpconn = dynamic_cast<HTTPConnection *>(connection);
-                if(httpconn)
-                    connparams = httpconn->getRedirection();
+                connparams = connection->getRedirection();
                 connection->setUsed(false);
                 connection = NULL;
-                if(httpconn)
-                    continue;
+                continue;
             }
             break;
         }
@@ -302,7 +300,8 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
     done = false;
     eof = false;
     held = false;
-    downloadstart = 0;
+    downloadtime = 0;
+    concurrencytime = 0;
 }
 
 HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
@@ -344,8 +343,10 @@ void HTTPChunkBufferedSource::release()
     vlc_cond_signal(&avail);
 }
 
-void HTTPChunkBufferedSource::bufferize(size_t readsize)
+void HTTPChunkBufferedSource::bufferize(size_t readsize, unsigned concurrency)
 {
+    vlc_tick_t start = vlc_tick_now();
+
     vlc_mutex_lock(&lock);
     if(!prepare())
     {
@@ -375,50 +376,53 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     {
         size_t size;
         vlc_tick_t time;
-    } rate = {0,0};
+        unsigned concurrency;
+    } rate = {0,0,1};
 
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
+
+    /* Only count the time this source was actually transferred,
+     * as it shares the downloader with other sources */
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    vlc_mutex_lock(&lock);
+    downloadtime += elapsed;
+    concurrencytime += elapsed * concurrency;
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = NULL;
-        vlc_mutex_locker locker( &lock );
         done = true;
-        rate.size = buffered + consumed;
-        rate.time = vlc_tick_now() - downloadstart;
-        downloadstart = 0;
     }
     else
     {
         p_block->i_buffer = (size_t) ret;
-        vlc_mutex_locker locker( &lock );
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
-        if((size_t) ret < readsize)
-        {
+        /* chunked transfers are queued as they arrive, until last one */
+        if(contentLength && buffered + consumed >= contentLength)
             done = true;
-            rate.size = buffered + consumed;
-            rate.time = vlc_tick_now() - downloadstart;
-            downloadstart = 0;
-        }
     }
 
-    if(rate.size && rate.time)
+    if(done && downloadtime)
     {
-        connManager->updateDownloadRate(sourceid, rate.size, rate.time);
+        rate.size = buffered + consumed;
+        rate.time = downloadtime;
+        rate.concurrency = (concurrencytime + downloadtime / 2) / downloadtime;
+        if(rate.concurrency < 1)
+            rate.concurrency = 1;
+        downloadtime = 0;
+        concurrencytime = 0;
     }
+    vlc_mutex_unlock(&lock);
 
-    vlc_cond_signal(&avail);
-}
-
-bool HTTPChunkBufferedSource::prepare()
-{
-    if(!prepared)
+    if(rate.size && rate.time)
     {
-        downloadstart = vlc_tick_now();
-        return HTTPChunkSource::prepare();
+        connManager->updateDownloadRate(sourceid, rate.size, rate.time,
+                                        rate.concurrency);
     }
-    return true;
+
+    vlc_cond_signal(&avail);
 }
 
 bool HTTPChunkBufferedSource::hasMoreData() const
@@ -130,8 +130,7 @@ namespace adaptive
                 void               release();
 
             protected:
-                virtual bool       prepare(); /* reimpl */
-                void               bufferize(size_t);
+                void               bufferize(size_t, unsigned = 1);
                 bool               isDone() const;
 
             private:
@@ -140,7 +139,8 @@ namespace adaptive
                 size_t              buffered; /* read cache size */
                 bool                done;
                 bool                eof;
-                vlc_tick_t          downloadstart;
+                vlc_tick_t          downloadtime; /* time spent transferring */
+                vlc_tick_t          concurrencytime; /* same, times concurrent downloads */
                 vlc_cond_t          avail;
                 bool                held;
         };
@@ -25,39 +25,41 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned maxthreads_)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&waitcond);
+    vlc_cond_init(&updatedcond);
     killed = false;
-    thread_handle_valid = false;
+    maxthreads = maxthreads_ ? maxthreads_ : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(threads.size() < maxthreads)
     {
-        return false;
+        vlc_thread_t thread;
+        if(vlc_clone(&thread, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        threads.push_back(thread);
     }
-    thread_handle_valid = true;
-    return true;
+    return !threads.empty();
 }
 
 Downloader::~Downloader()
 {
     vlc_mutex_lock( &lock );
     killed = true;
-    vlc_cond_signal(&waitcond);
+    vlc_cond_broadcast(&waitcond);
     vlc_mutex_unlock( &lock );
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, NULL);
+    for(size_t i=0; i<threads.size(); i++)
+        vlc_join(threads[i], NULL);
 }
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
@@ -71,11 +73,26 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
-    source->release();
     chunks.remove(source);
+    /* wait for the worker currently downloading it */
+    while(isDownloading(source))
+        vlc_cond_wait(&updatedcond, &lock);
+    source->release();
     vlc_mutex_unlock(&lock);
 }
 
+void Downloader::updateBufferingLevel(const ID &id, vlc_tick_t current, vlc_tick_t target)
+{
+    vlc_mutex_locker locker(&lock);
+    levels[id] = (target > 0) ? (double) current / target : 0.0;
+}
+
+void Downloader::removeBufferingLevel(const ID &id)
+{
+    vlc_mutex_locker locker(&lock);
+    levels.erase(id);
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     Downloader *instance = static_cast<Downloader *>(opaque);
@@ -85,10 +102,42 @@ void * Downloader::downloaderThread(void *opaque)
     return NULL;
 }
 
-void Downloader::DownloadSource(HTTPChunkBufferedSource *source)
+void Downloader::DownloadSource(HTTPChunkBufferedSource *source, unsigned concurrency)
 {
     if(!source->isDone())
-        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE, concurrency);
+}
+
+bool Downloader::isDownloading(const HTTPChunkBufferedSource *source) const
+{
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = downloading.begin(); it != downloading.end(); ++it)
+        if(*it == source)
+            return true;
+    return false;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    /* The stream with the lowest buffering ratio goes first,
+       then the first scheduled */
+    HTTPChunkBufferedSource *next = NULL;
+    double nextlevel = 0.0;
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        HTTPChunkBufferedSource *source = *it;
+        if(isDownloading(source))
+            continue;
+        std::map<ID, double>::const_iterator lit = levels.find(source->sourceid);
+        double level = (lit != levels.end()) ? (*lit).second : 0.0;
+        if(!next || level < nextlevel)
+        {
+            next = source;
+            nextlevel = level;
+        }
+    }
+    return next;
 }
 
 void Downloader::Run()
@@ -96,22 +145,35 @@ void Downloader::Run()
     vlc_mutex_lock(&lock);
     while(1)
     {
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source = NULL;
+        while(!killed && !(source = getNextSource()))
             vlc_cond_wait(&waitcond, &lock);
 
         if(killed)
             break;
 
-        if(!chunks.empty())
+        downloading.push_back(source);
+        const unsigned concurrency = downloading.size();
+        vlc_mutex_unlock(&lock);
+
+        DownloadSource(source, concurrency);
+
+        vlc_mutex_lock(&lock);
+        downloading.remove(source);
+        if(source->isDone())
         {
-            HTTPChunkBufferedSource *source = chunks.front();
-            DownloadSource(source);
-            if(source->isDone())
+            /* unless cancelled meanwhile */
+            std::list<HTTPChunkBufferedSource *>::iterator it =
+                    std::find(chunks.begin(), chunks.end(), source);
+            if(it != chunks.end())
             {
-                chunks.pop_front();
+                chunks.erase(it);
                 source->release();
             }
         }
+        vlc_cond_broadcast(&updatedcond);
+        /* the source can be downloaded by another worker */
+        vlc_cond_broadcast(&waitcond);
     }
     vlc_mutex_unlock(&lock);
 }
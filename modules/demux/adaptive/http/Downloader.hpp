@@ -24,6 +24,8 @@
 
 #include <vlc_common.h>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace adaptive
 {
@@ -34,22 +36,29 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, vlc_tick_t, vlc_tick_t);
+                void removeBufferingLevel(const ID &);
 
             private:
                 static void * downloaderThread(void *);
                 void Run();
-                void DownloadSource(HTTPChunkBufferedSource *);
-                vlc_thread_t thread_handle;
+                void DownloadSource(HTTPChunkBufferedSource *, unsigned);
+                HTTPChunkBufferedSource * getNextSource() const;
+                bool isDownloading(const HTTPChunkBufferedSource *) const;
+                std::vector<vlc_thread_t> threads;
+                unsigned     maxthreads;
                 vlc_mutex_t  lock;
                 vlc_cond_t   waitcond;
-                bool         thread_handle_valid;
+                vlc_cond_t   updatedcond;
                 bool         killed;
                 std::list<HTTPChunkBufferedSource *> chunks;
+                std::list<HTTPChunkBufferedSource *> downloading;
+                std::map<ID, double> levels; /* buffering ratio per stream */
         };
 
     }
@@ -27,9 +27,20 @@
 #include "Transport.hpp"
 #include "../tools/Helper.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+extern "C"
+{
+    #include "../../../access/http/connmgr.h"
+    #include "../../../access/http/message.h"
+    #include "../../../access/http/resource.h"
+}
 
 using namespace adaptive::http;
 
@@ -65,6 +76,11 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+const ConnectionParams & AbstractConnection::getRedirection() const
+{
+    return locationparams;
+}
+
 HTTPConnection::HTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
                                Transport *socket_, const ConnectionParams &proxy, bool persistent)
     : AbstractConnection( p_object_ )
@@ -229,7 +245,7 @@ ssize_t HTTPConnection::read(void *p_buffer, size_t len)
     if(ret >= 0)
         bytesRead += ret;
 
-    if(ret < 0 || (size_t)ret < len || /* set EOF */
+    if(ret < 0 || (chunked ? chunked_eof : (size_t)ret < len) || /* set EOF */
        (contentLength == bytesRead && connectionClose))
     {
         transport->disconnect();
@@ -351,6 +367,10 @@ ssize_t HTTPConnection::readChunk(void *p_buffer, size_t len)
             ssize_t in = transport->read(&crlf, 2);
             if(in < 2 || memcmp(crlf, "\r\n", 2))
                 return (copied == 0) ? -1 : copied;
+
+            /* Hand over each chunk as soon as complete */
+            if(copied > 0)
+                break;
         }
     }
 
@@ -463,11 +483,6 @@ std::string HTTPConnection::extraRequestHeaders() const
     return ss.str();
 }
 
-const ConnectionParams & HTTPConnection::getRedirection() const
-{
-    return locationparams;
-}
-
 StreamUrlConnection::StreamUrlConnection(vlc_object_t *p_object)
     : AbstractConnection(p_object)
 {
@@ -579,6 +594,287 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPManager::LibVLCHTTPManager(vlc_object_t *p_object, AuthStorage *auth)
+{
+    http_mgr = vlc_http_mgr_create(p_object, auth ? auth->getJar() : NULL);
+    vlc_mutex_init(&lock);
+    protocol = Protocol::Unknown;
+}
+
+LibVLCHTTPManager::~LibVLCHTTPManager()
+{
+    if(http_mgr)
+        vlc_http_mgr_destroy(http_mgr);
+}
+
+struct vlc_http_mgr * LibVLCHTTPManager::get() const
+{
+    return http_mgr;
+}
+
+/* Tells if a new connection can use the client, and if its first request
+ * must tell the protocol the server uses */
+bool LibVLCHTTPManager::acquire(bool *probing)
+{
+    vlc_mutex_lock(&lock);
+    *probing = (protocol == Protocol::Unknown);
+    if(*probing)
+        protocol = Protocol::Probing;
+    bool ok = *probing || protocol == Protocol::HTTP2;
+    vlc_mutex_unlock(&lock);
+    return ok && http_mgr;
+}
+
+bool LibVLCHTTPManager::isMultiplexed()
+{
+    vlc_mutex_lock(&lock);
+    bool ret = (protocol == Protocol::HTTP2);
+    vlc_mutex_unlock(&lock);
+    return ret;
+}
+
+void LibVLCHTTPManager::probed(bool connected)
+{
+    vlc_mutex_lock(&lock);
+    assert(protocol == Protocol::Probing);
+    if(!connected)
+        protocol = Protocol::Unknown; /* the next connection will tell */
+    else if(vlc_http_mgr_is_h2(http_mgr))
+        protocol = Protocol::HTTP2;
+    else
+        protocol = Protocol::HTTP1; /* the native client keeps a pool */
+    vlc_mutex_unlock(&lock);
+}
+
+/* The callbacks get the data following the resource */
+struct LibVLCHTTPResource
+{
+    struct vlc_http_resource res;
+    LibVLCHTTPConnection *conn;
+};
+
+const struct vlc_http_resource_cbs LibVLCHTTPConnection::callbacks =
+{
+    LibVLCHTTPConnection::formatRequest,
+    LibVLCHTTPConnection::validateResponse,
+};
+
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           LibVLCHTTPManager *manager_,
+                                           bool probing_)
+    : AbstractConnection(p_object_)
+{
+    manager = manager_;
+    probing = probing_;
+    resource = NULL;
+    p_block = NULL;
+    char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
+    useragent = psz_useragent ? std::string(psz_useragent) : std::string("");
+    free(psz_useragent);
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+    if(probing)
+        manager->probed(false);
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_block)
+        block_Release(p_block);
+    p_block = NULL;
+    if(resource)
+        vlc_http_res_destroy(resource); /* closes the stream */
+    resource = NULL;
+    bytesRead = 0;
+    contentLength = 0;
+    contentType = std::string();
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    return available && !params_.usesAccess() && manager->isMultiplexed() &&
+           params.getScheme() == params_.getScheme() &&
+           params.getHostname() == params_.getHostname() &&
+           params.getPort() == params_.getPort();
+}
+
+int LibVLCHTTPConnection::formatRequest(const struct vlc_http_resource *,
+                                        struct vlc_http_msg *req, void *opaque)
+{
+    const LibVLCHTTPConnection *conn = *static_cast<LibVLCHTTPConnection **>(opaque);
+    const BytesRange &range = conn->bytesRange;
+    if(!range.isValid())
+        return 0;
+    if(range.getEndByte())
+        return vlc_http_msg_add_header(req, "Range", "bytes=%zu-%zu",
+                                       range.getStartByte(), range.getEndByte());
+    return vlc_http_msg_add_header(req, "Range", "bytes=%zu-", range.getStartByte());
+}
+
+int LibVLCHTTPConnection::validateResponse(const struct vlc_http_resource *,
+                                           const struct vlc_http_msg *, void *)
+{
+    return 0; /* status is checked by the request */
+}
+
+enum RequestStatus
+    LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+    locationparams = ConnectionParams();
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    if(!manager->get())
+        return RequestStatus::GenericError;
+
+    struct LibVLCHTTPResource *tuple =
+            static_cast<struct LibVLCHTTPResource *>(malloc(sizeof(*tuple)));
+    if(!tuple)
+        return RequestStatus::GenericError;
+    tuple->conn = this;
+
+    if(vlc_http_res_init(&tuple->res, &callbacks, manager->get(),
+                         params.getUrl().c_str(),
+                         useragent.empty() ? NULL : useragent.c_str(), NULL))
+    {
+        free(tuple);
+        return RequestStatus::GenericError;
+    }
+    resource = &tuple->res;
+    bytesRange = range;
+
+    /* Sends the request, or opens a new stream on the HTTP/2 connection */
+    int status = vlc_http_res_get_status(resource);
+    char *psz_redirect = vlc_http_res_get_redirect(resource);
+    if(probing)
+    {
+        manager->probed(status >= 0);
+        probing = false;
+    }
+
+    if(psz_redirect)
+    {
+        locationparams = ConnectionParams(psz_redirect);
+        free(psz_redirect);
+        msg_Info(p_object, "%d redirection to %s", status, locationparams.getUrl().c_str());
+        reset();
+        if(locationparams.isLocal() && !params.isLocal())
+        {
+            msg_Err(p_object, "redirection to local rejected");
+            return RequestStatus::GenericError;
+        }
+        return RequestStatus::Redirection;
+    }
+
+    if(status != 200 && status != 206)
+    {
+        msg_Err(p_object, "Failed reading %s: %d", params.getUrl().c_str(), status);
+        reset();
+        if(status == 401)
+            return RequestStatus::Unauthorized;
+        if(status == 404)
+            return RequestStatus::NotFound;
+        return RequestStatus::GenericError;
+    }
+
+    if(range.isValid() && status != 206 && range.getStartByte() > 0)
+    {
+        /* The server ignored the range */
+        msg_Err(p_object, "Failed reading %s: no range support", params.getUrl().c_str());
+        reset();
+        return RequestStatus::GenericError;
+    }
+
+    const char *psz_type = vlc_http_msg_get_header(resource->response, "Content-Type");
+    if(psz_type)
+        contentType = std::string(psz_type);
+
+    uintmax_t size = vlc_http_msg_get_size(resource->response);
+    if(size != (uintmax_t) -1)
+        contentLength = size;
+    if(range.isValid() && range.getEndByte() > 0)
+    {
+        /* also stops at the end of the range if the whole file is sent */
+        const size_t rangeLength = range.getEndByte() - range.getStartByte() + 1;
+        if(contentLength == 0 || contentLength > rangeLength)
+            contentLength = rangeLength;
+    }
+
+    return RequestStatus::Success;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if(!resource)
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    /* Only the stream is read, concurrently with other requests */
+    size_t copied = 0;
+    bool error = false;
+    while(copied < len)
+    {
+        if(!p_block)
+        {
+            /* Hand over data as soon as received */
+            if(copied > 0)
+                break;
+            block_t *p_read = vlc_http_res_read(resource);
+            if(p_read == NULL) /* EOF */
+                break;
+            if(p_read == vlc_http_error)
+            {
+                error = true;
+                break;
+            }
+            p_block = p_read;
+        }
+
+        size_t i_copy = std::min(len - copied, p_block->i_buffer);
+        memcpy(static_cast<uint8_t *>(p_buffer) + copied, p_block->p_buffer, i_copy);
+        p_block->p_buffer += i_copy;
+        p_block->i_buffer -= i_copy;
+        copied += i_copy;
+        if(p_block->i_buffer == 0)
+        {
+            block_Release(p_block);
+            p_block = NULL;
+        }
+    }
+    bytesRead += copied;
+
+    if(error && copied == 0)
+        return VLC_EGENERIC;
+
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    /* Requests are streams, nothing to keep between them */
+    if(available)
+        reset();
+}
+
 NativeConnectionFactory::NativeConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
@@ -636,16 +932,61 @@ AbstractConnection * StreamUrlConnectionFactory::createConnection(vlc_object_t *
     return new (std::nothrow) StreamUrlConnection(p_object);
 }
 
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
+    : AbstractConnectionFactory()
+{
+    authStorage = auth;
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    std::map<std::string, LibVLCHTTPManager *>::iterator it;
+    for(it = managers.begin(); it != managers.end(); ++it)
+        delete (*it).second;
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    if(params.getScheme() != "https" || params.getHostname().empty())
+        return NULL;
+
+    std::ostringstream key;
+    key << params.getHostname() << ":" << params.getPort();
+
+    LibVLCHTTPManager *manager;
+    std::map<std::string, LibVLCHTTPManager *>::iterator it = managers.find(key.str());
+    if(it == managers.end())
+    {
+        manager = new (std::nothrow) LibVLCHTTPManager(p_object, authStorage);
+        if(!manager)
+            return NULL;
+        managers.insert(std::pair<std::string, LibVLCHTTPManager *>(key.str(), manager));
+    }
+    else manager = (*it).second;
+
+    bool probing;
+    if(!manager->acquire(&probing))
+        return NULL;
+
+    AbstractConnection *conn = new (std::nothrow) LibVLCHTTPConnection(p_object, manager, probing);
+    if(!conn && probing)
+        manager->probed(false);
+    return conn;
+}
+
 ConnectionFactory::ConnectionFactory( AuthStorage *authstorage )
 {
     native = new NativeConnectionFactory( authstorage );
     streamurl = new StreamUrlConnectionFactory();
+    libvlchttp = new LibVLCHTTPConnectionFactory( authstorage );
 }
 
 ConnectionFactory::~ConnectionFactory()
 {
     delete native;
     delete streamurl;
+    delete libvlchttp;
 }
 
 AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
@@ -654,6 +995,13 @@ AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
     bool b_streamurl = var_InheritBool(p_object, "adaptive-use-access");
     if(!b_streamurl && !params.usesAccess())
     {
+        /* HTTPS requests are multiplexed over HTTP/2 when possible */
+        if(params.getScheme() == "https" && var_InheritBool(p_object, "adaptive-http2"))
+        {
+            AbstractConnection *conn = libvlchttp->createConnection(p_object, params);
+            if(conn)
+                return conn;
+        }
         return native->createConnection(p_object, params);
     }
     else
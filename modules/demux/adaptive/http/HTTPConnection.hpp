@@ -29,6 +29,12 @@
 #include "BytesRange.hpp"
 #include <vlc_common.h>
 #include <string>
+#include <map>
+
+struct vlc_http_mgr;
+struct vlc_http_msg;
+struct vlc_http_resource;
+struct vlc_http_resource_cbs;
 
 namespace adaptive
 {
@@ -53,10 +59,12 @@ namespace adaptive
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
                 virtual void    setUsed( bool ) = 0;
+                const ConnectionParams &getRedirection() const;
 
             protected:
                 vlc_object_t      *p_object;
                 ConnectionParams   params;
+                ConnectionParams   locationparams;
                 bool               available;
                 size_t             contentLength;
                 std::string        contentType;
@@ -77,7 +85,6 @@ namespace adaptive
                 virtual ssize_t read        (void *p_buffer, size_t len);
 
                 void setUsed( bool );
-                const ConnectionParams &getRedirection() const;
                 static const unsigned MAX_REDIRECTS = 3;
 
             protected:
@@ -98,7 +105,6 @@ namespace adaptive
                 std::string useragent;
 
                 AuthStorage        *authStorage;
-                ConnectionParams    locationparams;
                 ConnectionParams    proxyparams;
                 bool                connectionClose;
                 bool                chunked;
@@ -131,6 +137,62 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* HTTP client of the http access module, shared by all the
+        * connections to a server. HTTPS uses HTTP/2 when the server
+        * offers it, and every request is a stream of the same connection.
+        * The first request tells whether the server does: until then, and
+        * for HTTP/1.1 servers, the native connections are used */
+       class LibVLCHTTPManager
+       {
+            public:
+                LibVLCHTTPManager(vlc_object_t *, AuthStorage *);
+                ~LibVLCHTTPManager();
+                struct vlc_http_mgr *get() const;
+                bool acquire(bool *);
+                bool isMultiplexed();
+                void probed(bool);
+
+            private:
+                enum class Protocol
+                {
+                    Unknown,
+                    Probing,
+                    HTTP2,
+                    HTTP1,
+                };
+                struct vlc_http_mgr *http_mgr;
+                vlc_mutex_t          lock;
+                Protocol             protocol;
+       };
+
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, LibVLCHTTPManager *, bool);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual enum RequestStatus
+                                request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                static int formatRequest(const struct vlc_http_resource *,
+                                         struct vlc_http_msg *, void *);
+                static int validateResponse(const struct vlc_http_resource *,
+                                            const struct vlc_http_msg *, void *);
+                static const struct vlc_http_resource_cbs callbacks;
+                std::string useragent;
+                LibVLCHTTPManager *manager;
+                bool probing; /* the next request tells the protocol */
+                struct vlc_http_resource *resource;
+                block_t *p_block; /* partially read */
+       };
+
        class AbstractConnectionFactory
        {
            public:
@@ -157,6 +219,18 @@ namespace adaptive
                virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
        };
 
+       class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory( AuthStorage * );
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &);
+           private:
+               AuthStorage *authStorage;
+               /* The client only keeps one connection, so one per server */
+               std::map<std::string, LibVLCHTTPManager *> managers;
+       };
+
        class ConnectionFactory : public AbstractConnectionFactory
        {
            public:
@@ -166,6 +240,7 @@ namespace adaptive
            private:
                NativeConnectionFactory *native;
                StreamUrlConnectionFactory *streamurl;
+               LibVLCHTTPConnectionFactory *libvlchttp;
        };
     }
 }
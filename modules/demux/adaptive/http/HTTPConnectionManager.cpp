@@ -47,10 +47,19 @@ AbstractConnectionManager::~AbstractConnectionManager()
 
 }
 
-void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size, vlc_tick_t time)
+void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size,
+                                                   vlc_tick_t time, unsigned concurrency)
 {
     if(rateObserver)
-        rateObserver->updateDownloadRate(sourceid, size, time);
+        rateObserver->updateDownloadRate(sourceid, size, time, concurrency);
+}
+
+void AbstractConnectionManager::updateBufferingLevel(const adaptive::ID &, vlc_tick_t, vlc_tick_t)
+{
+}
+
+void AbstractConnectionManager::removeBufferingLevel(const adaptive::ID &)
+{
 }
 
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
@@ -64,16 +73,21 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AuthSt
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
-    downloader->start();
+    downloader = new (std::nothrow) Downloader(var_InheritInteger(p_object, "adaptive-downloads"));
+    if(downloader && !downloader->start())
+    {
+        delete downloader;
+        downloader = NULL;
+    }
     factory = new ConnectionFactory(storage);
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
     delete downloader;
-    delete factory;
+    /* connections can depend on the factory */
     this->closeAllConnections();
+    delete factory;
 }
 
 void HTTPConnectionManager::closeAllConnections      ()
@@ -144,17 +158,31 @@ AbstractConnection * HTTPConnectionManager::getConnection(ConnectionParams &para
 void HTTPConnectionManager::start(AbstractChunkSource *source)
 {
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
-    if(src)
+    /* without downloader, no connection is ever given to the source */
+    if(src && downloader)
         downloader->schedule(src);
 }
 
 void HTTPConnectionManager::cancel(AbstractChunkSource *source)
 {
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
-    if(src)
+    if(src && downloader)
         downloader->cancel(src);
 }
 
+void HTTPConnectionManager::updateBufferingLevel(const adaptive::ID &id,
+                                                 vlc_tick_t current, vlc_tick_t target)
+{
+    if(downloader)
+        downloader->updateBufferingLevel(id, current, target);
+}
+
+void HTTPConnectionManager::removeBufferingLevel(const adaptive::ID &id)
+{
+    if(downloader)
+        downloader->removeBufferingLevel(id);
+}
+
 void HTTPConnectionManager::setLocalConnectionsAllowed()
 {
     localAllowed = true;
@@ -53,7 +53,9 @@ namespace adaptive
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
 
-                virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t); /* impl */
+                virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t, unsigned); /* impl */
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t, vlc_tick_t);
+                virtual void removeBufferingLevel(const ID &);
                 void setDownloadRateObserver(IDownloadRateObserver *);
 
             protected:
@@ -74,6 +76,8 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *) /* impl */;
                 virtual void cancel(AbstractChunkSource *) /* impl */;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t, vlc_tick_t); /* reimpl */
+                virtual void removeBufferingLevel(const ID &); /* reimpl */
                 void         setLocalConnectionsAllowed();
 
             private:
@@ -47,6 +47,7 @@ AbstractBufferingLogic::AbstractBufferingLogic()
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userLookahead = 0;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -69,6 +70,16 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserLookahead(unsigned v)
+{
+    userLookahead = v;
+}
+
+unsigned AbstractBufferingLogic::getLookahead() const
+{
+    return userLookahead;
+}
+
 DefaultBufferingLogic::DefaultBufferingLogic()
     : AbstractBufferingLogic()
 {
@@ -103,7 +114,12 @@ uint64_t DefaultBufferingLogic::getStartSegmentNumber(BaseRepresentation *rep) c
 vlc_tick_t DefaultBufferingLogic::getMinBuffering(const AbstractPlaylist *p) const
 {
     if(isLowLatency(p))
+    {
+        /* Low latency services tell how close to the edge we can stay */
+        if(p->getMinBuffering() && p->getMinBuffering() < BUFFERING_LOWEST_LIMIT)
+            return p->getMinBuffering();
         return BUFFERING_LOWEST_LIMIT;
+    }
 
     vlc_tick_t buffering = userMinBuffering ? userMinBuffering
                                             : DEFAULT_MIN_BUFFERING;
@@ -50,6 +50,8 @@ namespace adaptive
                 void setUserMaxBuffering(vlc_tick_t);
                 void setUserLiveDelay(vlc_tick_t);
                 void setLowDelay(bool);
+                void setUserLookahead(unsigned);
+                unsigned getLookahead() const;
                 static const vlc_tick_t BUFFERING_LOWEST_LIMIT;
                 static const vlc_tick_t DEFAULT_MIN_BUFFERING;
                 static const vlc_tick_t DEFAULT_MAX_BUFFERING;
@@ -59,6 +61,7 @@ namespace adaptive
                 vlc_tick_t userMinBuffering;
                 vlc_tick_t userMaxBuffering;
                 vlc_tick_t userLiveDelay;
+                unsigned userLookahead;
                 Undef<bool> userLowLatency;
         };
 
@@ -0,0 +1,238 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput estimation from fast and slow exponentially weighted moving
+ * averages, keeping the lowest one, as the estimate must drop quickly but
+ * only rise on sustained throughput.
+ * How much of that estimate is used grows with the buffer occupancy, and
+ * switches are subject to hysteresis to avoid oscillations.
+ */
+
+#define FAST_HALFLIFE           VLC_TICK_FROM_SEC(2)
+#define SLOW_HALFLIFE           VLC_TICK_FROM_SEC(8)
+#define LOW_BUFFER_BW_FACTOR    0.6  /* usable estimate with empty buffer */
+#define HIGH_BUFFER_BW_FACTOR   0.95 /* usable estimate with full buffer */
+#define UPSWITCH_MIN_LEVEL      0.4  /* buffer level required to go up */
+#define UPSWITCH_VOTES          2    /* consecutive decisions required to go up */
+#define MIN_SEGMENTS_PER_SWITCH 2
+#define DOWNSWITCH_MAX_LEVEL    0.7  /* above, drops are absorbed by the buffer */
+
+HybridContext::HybridContext()
+    : buffering_level( 0 )
+    , buffering_target( 1 )
+    , upswitch_votes( 0 )
+    , segments_since_switch( MIN_SEGMENTS_PER_SWITCH )
+{ }
+
+ExponentialAverage::ExponentialAverage(vlc_tick_t h)
+    : halflife( h )
+    , value( 0 )
+    , weight( 0 )
+{ }
+
+void ExponentialAverage::push(double v, vlc_tick_t duration)
+{
+    /* samples weighted by their duration */
+    double alpha = std::pow(0.5, (double) duration / halflife);
+    value = alpha * value + (1.0 - alpha) * v;
+    weight = alpha * weight + (1.0 - alpha);
+}
+
+double ExponentialAverage::get() const
+{
+    /* remove the bias towards initial zero value */
+    return (weight > 0) ? value / weight : 0;
+}
+
+bool ExponentialAverage::isSet() const
+{
+    return weight > 0;
+}
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , fastAverage( FAST_HALFLIFE )
+    , slowAverage( SLOW_HALFLIFE )
+    , usedBps( 0 )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet,
+                                                                 BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+    BaseRepresentation *rep;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end() || !fastAverage.isSet())
+    {
+        /* Nothing measured yet, start safely */
+        rep = prevRep ? prevRep : selector.lowest(adaptSet);
+        vlc_mutex_unlock(&lock);
+        return rep;
+    }
+
+    HybridContext &ctx = (*it).second;
+
+    double f_buffering_level = (double) ctx.buffering_level / ctx.buffering_target;
+    f_buffering_level = std::max(0.0, std::min(1.0, f_buffering_level));
+
+    const uint64_t i_available_bw = getAvailableBw(prevRep);
+    const double f_factor = LOW_BUFFER_BW_FACTOR +
+                            (HIGH_BUFFER_BW_FACTOR - LOW_BUFFER_BW_FACTOR) * f_buffering_level;
+    rep = selector.select(adaptSet, i_available_bw * f_factor);
+
+    if(prevRep && rep)
+    {
+        if(rep->getBandwidth() > prevRep->getBandwidth())
+        {
+            if(f_buffering_level < UPSWITCH_MIN_LEVEL ||
+               ++ctx.upswitch_votes < UPSWITCH_VOTES ||
+               ctx.segments_since_switch < MIN_SEGMENTS_PER_SWITCH)
+                rep = prevRep;
+        }
+        else
+        {
+            ctx.upswitch_votes = 0;
+            /* Keep quality while the buffer can absorb the drop */
+            if(rep->getBandwidth() < prevRep->getBandwidth() &&
+               f_buffering_level > DOWNSWITCH_MAX_LEVEL &&
+               i_available_bw >= prevRep->getBandwidth())
+                rep = prevRep;
+        }
+    }
+
+    if(rep != prevRep)
+    {
+        ctx.upswitch_votes = 0;
+        ctx.segments_since_switch = 0;
+        BwDebug(msg_Info(p_obj, "Stream %s new bandwidth usage %" PRIu64 " KiB/s (buffer %.2f)",
+                         adaptSet->getID().str().c_str(), rep ? rep->getBandwidth() / 8000 : 0,
+                         f_buffering_level));
+    }
+    else ctx.segments_since_switch++;
+
+    vlc_mutex_unlock(&lock);
+
+    return rep;
+}
+
+uint64_t HybridAdaptationLogic::getAvailableBw(const BaseRepresentation *curRep) const
+{
+    const uint64_t i_bw = std::min(fastAverage.get(), slowAverage.get());
+    /* share with other streams */
+    uint64_t i_others = usedBps;
+    if(curRep)
+        i_others -= std::min(i_others, curRep->getBandwidth());
+    return (i_bw > i_others) ? i_bw - i_others : 0;
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &, size_t dlsize, vlc_tick_t time,
+                                               unsigned concurrency)
+{
+    if(unlikely(time == 0))
+        return;
+    const double bps = (double) CLOCK_FREQ * dlsize * 8 * concurrency / time;
+    vlc_mutex_lock(&lock);
+    fastAverage.push(bps, time);
+    slowAverage.push(bps, time);
+    BwDebug(msg_Dbg(p_obj, "bw estimation %.0f kbps fast %.0f slow %.0f", bps / 1000,
+                    fastAverage.get() / 1000, slowAverage.get() / 1000));
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
+{
+    switch(event.type)
+    {
+    case SegmentTrackerEvent::SWITCHING:
+        {
+            vlc_mutex_lock(&lock);
+            if(event.u.switching.prev)
+                usedBps -= event.u.switching.prev->getBandwidth();
+            if(event.u.switching.next)
+                usedBps += event.u.switching.next->getBandwidth();
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case SegmentTrackerEvent::BUFFERING_STATE:
+        {
+            const ID &id = *event.u.buffering.id;
+            vlc_mutex_lock(&lock);
+            if(event.u.buffering.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                    streams.insert(std::pair<ID, HybridContext>(id, HybridContext()));
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+        {
+            const ID &id = *event.u.buffering_level.id;
+            vlc_mutex_lock(&lock);
+            /* Only track the streams that are buffering */
+            std::map<ID, HybridContext>::iterator it = streams.find(id);
+            if(it != streams.end())
+            {
+                HybridContext &ctx = (*it).second;
+                ctx.buffering_level = event.u.buffering_level.current;
+                ctx.buffering_target = std::max(event.u.buffering_level.target, (vlc_tick_t) 1);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * HybridAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HYBRIDADAPTATIONLOGIC_HPP
+#define HYBRIDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include <map>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class HybridContext
+        {
+            friend class HybridAdaptationLogic;
+
+            public:
+                HybridContext();
+
+            private:
+                vlc_tick_t buffering_level;
+                vlc_tick_t buffering_target;
+                unsigned   upswitch_votes;
+                unsigned   segments_since_switch;
+        };
+
+        class ExponentialAverage
+        {
+            public:
+                ExponentialAverage(vlc_tick_t);
+                void push(double, vlc_tick_t);
+                double get() const;
+                bool isSet() const;
+
+            private:
+                vlc_tick_t halflife;
+                double value;
+                double weight;
+        };
+
+        class HybridAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                HybridAdaptationLogic(vlc_object_t *);
+                virtual ~HybridAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
+                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t, unsigned); /* reimpl */
+                virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
+
+            private:
+                uint64_t                    getAvailableBw(const BaseRepresentation *) const;
+                std::map<adaptive::ID, HybridContext> streams;
+                ExponentialAverage          fastAverage;
+                ExponentialAverage          slowAverage;
+                uint64_t                    usedBps;
+                vlc_mutex_t                 lock;
+        };
+    }
+}
+
+#endif // HYBRIDADAPTATIONLOGIC_HPP
@@ -34,7 +34,9 @@ namespace adaptive
     class IDownloadRateObserver
     {
         public:
-            virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t) = 0;
+            /* size downloaded in time, with the given number of
+             * concurrent downloads sharing the bandwidth */
+            virtual void updateDownloadRate(const ID &, size_t, vlc_tick_t, unsigned) = 0;
             virtual ~IDownloadRateObserver(){}
     };
 }
@@ -176,14 +176,15 @@ unsigned NearOptimalAdaptationLogic::getMaxCurrentBw() const
     return i_max_bitrate;
 }
 
-void NearOptimalAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time)
+void NearOptimalAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time,
+                                                    unsigned concurrency)
 {
     vlc_mutex_lock(&lock);
     std::map<ID, NearOptimalContext>::iterator it = streams.find(id);
     if(it != streams.end())
     {
         NearOptimalContext &ctx = (*it).second;
-        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        ctx.last_download_rate = ctx.average.push(CLOCK_FREQ * dlsize * 8 * concurrency / time);
     }
     currentBps = getMaxCurrentBw();
     vlc_mutex_unlock(&lock);
@@ -51,7 +51,7 @@ namespace adaptive
                 virtual ~NearOptimalAdaptationLogic();
 
                 virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
-                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t); /* reimpl */
+                virtual void                updateDownloadRate     (const ID &, size_t, vlc_tick_t, unsigned); /* reimpl */
                 virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
 
             private:
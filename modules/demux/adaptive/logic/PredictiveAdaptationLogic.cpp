@@ -151,14 +151,15 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
     return rep;
 }
 
-void PredictiveAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time)
+void PredictiveAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, vlc_tick_t time,
+                                                   unsigned concurrency)
 {
     vlc_mutex_lock(&lock);
     std::map<ID, PredictiveStats>::iterator it = streams.find(id);
     if(it != streams.end())
     {
         PredictiveStats &stats = (*it).second;
-        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 / time);
+        stats.last_download_rate = stats.average.push(CLOCK_FREQ * dlsize * 8 * concurrency / time);
     }
     vlc_mutex_unlock(&lock);
 }
@@ -76,13 +76,15 @@ BaseRepresentation *RateBasedAdaptationLogic::getNextRepresentation(BaseAdaptati
     return rep;
 }
 
-void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size, vlc_tick_t time)
+void RateBasedAdaptationLogic::updateDownloadRate(const ID &, size_t size, vlc_tick_t time,
+                                                  unsigned concurrency)
 {
     if(unlikely(time == 0))
         return;
-    /* Accumulate up to observation window */
+    /* Accumulate up to observation window.
+     * Concurrent downloads were sharing the link */
     dllength += time;
-    dlsize += size;
+    dlsize += size * concurrency;
 
     if(dllength < VLC_TICK_FROM_MS(250))
         return;
@@ -75,7 +75,7 @@ void SegmentList::addSegment(ISegment *seg)
 
 void SegmentList::updateWith(SegmentList *updated, bool b_restamp)
 {
-    const ISegment * lastSegment = (segments.empty()) ? NULL : segments.back();
+    ISegment * lastSegment = (segments.empty()) ? NULL : segments.back();
     const ISegment * prevSegment = lastSegment;
 
     if(updated->segments.empty())
@@ -102,7 +102,16 @@ void SegmentList::updateWith(SegmentList *updated, bool b_restamp)
             addSegment(cur);
         }
         else
+        {
+            /* last one could have been listed while still being published */
+            if(lastSegment->compare(cur) == 0 &&
+               lastSegment->duration.Get() != cur->duration.Get())
+            {
+                totalLength += cur->duration.Get() - lastSegment->duration.Get();
+                lastSegment->duration.Set(cur->duration.Get());
+            }
             delete cur;
+        }
     }
     updated->segments.clear();
 
@@ -156,13 +156,15 @@ uint64_t MediaSegmentTemplate::getLiveTemplateNumber(vlc_tick_t playbacktime, bo
     if(dur)
     {
         /* compute, based on current time */
-        /* N = (T - AST - PS - D)/D + sSN */
+        /* N = (T - AST - PS + ATO - D)/D + sSN */
         const Timescale timescale = inheritTimescale();
         if(abs)
         {
             vlc_tick_t streamstart =
                     vlc_tick_from_sec(parentSegmentInformation->getPlaylist()->availabilityStartTime.Get());
             streamstart += parentSegmentInformation->getPeriodStart();
+            /* chunked segments are available before being complete */
+            streamstart -= parentSegmentInformation->inheritAvailabilityTimeOffset();
             playbacktime -= streamstart;
         }
         stime_t elapsed = timescale.ToScaled(playbacktime) - dur;
@@ -0,0 +1,361 @@
+/*****************************************************************************
+ * logic_simulator.cpp: offline evaluation of the adaptation logics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Replays bandwidth traces against the adaptation logics, with a playlist
+ * model made of a single adaptation set, and reports for each logic the
+ * average selected bitrate, the number of switches, the stalled time and
+ * the startup delay.
+ *
+ * Usage: adaptive_logic_simulator [trace file]...
+ * Trace files contain one "<duration in seconds> <bandwidth in kbit/s>"
+ * pair per line, replayed in loop. Built-in synthetic traces are used
+ * when none is given.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+
+extern "C" {
+#include "../../../../lib/libvlc_internal.h"
+}
+
+#include "../playlist/AbstractPlaylist.hpp"
+#include "../playlist/BasePeriod.h"
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../logic/RateBasedAdaptationLogic.h"
+#include "../logic/PredictiveAdaptationLogic.hpp"
+#include "../logic/NearOptimalAdaptationLogic.hpp"
+#include "../logic/HybridAdaptationLogic.hpp"
+#include "../SegmentTracker.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace adaptive::logic;
+
+#define SEGMENT_DURATION    VLC_TICK_FROM_SEC(4)
+#define SEGMENTS_COUNT      150
+#define REQUEST_LATENCY     VLC_TICK_FROM_MS(50)
+#define MIN_BUFFERING       VLC_TICK_FROM_SEC(6)  /* startup and rebuffering */
+#define MAX_BUFFERING       VLC_TICK_FROM_SEC(30)
+
+static const uint64_t bitrates[] = { /* kbit/s */
+    235, 375, 560, 750, 1050, 1750, 2350, 3000, 4300, 5800,
+};
+
+class SimulatedPlaylist : public AbstractPlaylist
+{
+    public:
+        SimulatedPlaylist(vlc_object_t *obj) : AbstractPlaylist(obj) {}
+        virtual bool isLive() const { return false; }
+        virtual void debug() {}
+};
+
+class Trace
+{
+    public:
+        Trace(const std::string &n) : name(n), length(0) {}
+
+        void add(vlc_tick_t duration, uint64_t bps)
+        {
+            if(duration <= 0)
+                return;
+            Piece p = { duration, bps };
+            pieces.push_back(p);
+            length += duration;
+        }
+
+        bool isUsable() const
+        {
+            for(size_t i=0; i<pieces.size(); i++)
+                if(pieces[i].bps)
+                    return true;
+            return false;
+        }
+
+        /* time needed to transfer bits when starting at time start */
+        vlc_tick_t transfer(vlc_tick_t start, uint64_t bits) const
+        {
+            vlc_tick_t now = start;
+            while(bits > 0)
+            {
+                vlc_tick_t offset = now % length;
+                size_t i = 0;
+                for( ; offset >= pieces[i].duration; i++)
+                    offset -= pieces[i].duration;
+
+                const vlc_tick_t remain = pieces[i].duration - offset;
+                const uint64_t piecebits = pieces[i].bps * remain / CLOCK_FREQ;
+                if(piecebits >= bits)
+                {
+                    now += (bits * CLOCK_FREQ + pieces[i].bps - 1) / pieces[i].bps;
+                    bits = 0;
+                }
+                else
+                {
+                    bits -= piecebits;
+                    now += remain;
+                }
+            }
+            return now - start;
+        }
+
+        std::string name;
+
+    private:
+        struct Piece
+        {
+            vlc_tick_t duration;
+            uint64_t bps;
+        };
+        std::vector<Piece> pieces;
+        vlc_tick_t length;
+};
+
+struct Results
+{
+    uint64_t bitratesum;
+    unsigned segments;
+    unsigned switches;
+    vlc_tick_t stalled;
+    vlc_tick_t startup;
+};
+
+static Results simulate(AbstractAdaptationLogic *logic, BaseAdaptationSet *adaptSet,
+                        const Trace &trace)
+{
+    Results res = { 0, 0, 0, 0, 0 };
+    const ID &id = adaptSet->getID();
+    vlc_tick_t now = 0;
+    vlc_tick_t buffering = 0;
+    bool playing = false;
+    BaseRepresentation *rep = NULL;
+
+    logic->trackerEvent(SegmentTrackerEvent(id, true));
+
+    for(unsigned i=0; i<SEGMENTS_COUNT; i++)
+    {
+        BaseRepresentation *next = logic->getNextRepresentation(adaptSet, rep);
+        if(!next)
+            break;
+        if(next != rep)
+        {
+            logic->trackerEvent(SegmentTrackerEvent(rep, next));
+            if(rep)
+                res.switches++;
+            rep = next;
+        }
+
+        const uint64_t bits = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ;
+        const vlc_tick_t duration = REQUEST_LATENCY +
+                                    trace.transfer(now + REQUEST_LATENCY, bits);
+
+        /* playback drains the buffer while downloading */
+        if(playing)
+        {
+            if(duration > buffering)
+            {
+                res.stalled += duration - buffering;
+                buffering = 0;
+                playing = false;
+            }
+            else buffering -= duration;
+        }
+        else if(res.startup) /* rebuffering */
+        {
+            res.stalled += duration;
+        }
+        now += duration;
+
+        logic->updateDownloadRate(id, bits / 8, duration, 1);
+
+        buffering += SEGMENT_DURATION;
+        res.bitratesum += rep->getBandwidth();
+        res.segments++;
+
+        if(!playing && buffering >= MIN_BUFFERING)
+        {
+            playing = true;
+            if(!res.startup)
+                res.startup = now;
+        }
+
+        logic->trackerEvent(SegmentTrackerEvent(id, SEGMENT_DURATION));
+        logic->trackerEvent(SegmentTrackerEvent(id, MIN_BUFFERING, buffering, MAX_BUFFERING));
+
+        /* wait for room in the buffer before next download */
+        if(playing && buffering + SEGMENT_DURATION > MAX_BUFFERING)
+        {
+            const vlc_tick_t wait = buffering + SEGMENT_DURATION - MAX_BUFFERING;
+            buffering -= wait;
+            now += wait;
+        }
+    }
+
+    logic->trackerEvent(SegmentTrackerEvent(id, false));
+
+    if(!res.startup) /* never started */
+        res.startup = now;
+
+    return res;
+}
+
+static const struct
+{
+    const char *name;
+    AbstractAdaptationLogic * (*create)(vlc_object_t *);
+} logics[] = {
+    { "rate",        [](vlc_object_t *o) -> AbstractAdaptationLogic * {
+                         return new RateBasedAdaptationLogic(o); } },
+    { "predictive",  [](vlc_object_t *o) -> AbstractAdaptationLogic * {
+                         return new PredictiveAdaptationLogic(o); } },
+    { "nearoptimal", [](vlc_object_t *o) -> AbstractAdaptationLogic * {
+                         return new NearOptimalAdaptationLogic(o); } },
+    { "hybrid",      [](vlc_object_t *o) -> AbstractAdaptationLogic * {
+                         return new HybridAdaptationLogic(o); } },
+};
+
+static void builtinTraces(std::vector<Trace> &traces)
+{
+    Trace constant("constant");
+    constant.add(VLC_TICK_FROM_SEC(60), 3000000);
+    traces.push_back(constant);
+
+    Trace stepdown("step-down");
+    stepdown.add(VLC_TICK_FROM_SEC(120), 5000000);
+    stepdown.add(VLC_TICK_FROM_SEC(120), 1200000);
+    traces.push_back(stepdown);
+
+    Trace oscillating("oscillating");
+    oscillating.add(VLC_TICK_FROM_SEC(10), 4000000);
+    oscillating.add(VLC_TICK_FROM_SEC(10), 800000);
+    traces.push_back(oscillating);
+
+    /* random walk, always the same sequence */
+    Trace mobile("mobile");
+    std::mt19937 gen(0x564C43);
+    int64_t kbps = 2000;
+    for(unsigned i=0; i<600; i++)
+    {
+        kbps += (int64_t)(gen() % 1001) - 500;
+        kbps = std::max((int64_t) 200, std::min((int64_t) 7000, kbps));
+        mobile.add(VLC_TICK_FROM_SEC(1), kbps * 1000);
+    }
+    traces.push_back(mobile);
+
+    Trace outage("outage");
+    outage.add(VLC_TICK_FROM_SEC(90), 4000000);
+    outage.add(VLC_TICK_FROM_SEC(8), 0);
+    outage.add(VLC_TICK_FROM_SEC(90), 2500000);
+    traces.push_back(outage);
+}
+
+static bool loadTrace(const char *path, std::vector<Trace> &traces)
+{
+    FILE *fp = fopen(path, "r");
+    if(!fp)
+    {
+        perror(path);
+        return false;
+    }
+
+    Trace trace(path);
+    char line[256];
+    while(fgets(line, sizeof(line), fp))
+    {
+        double secs, kbps;
+        if(*line == '#' || sscanf(line, "%lf %lf", &secs, &kbps) != 2)
+            continue;
+        if(secs > 0 && kbps >= 0)
+            trace.add(vlc_tick_from_sec(secs), kbps * 1000);
+    }
+    fclose(fp);
+
+    if(!trace.isUsable())
+    {
+        fprintf(stderr, "%s: no usable bandwidth\n", path);
+        return false;
+    }
+    traces.push_back(trace);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Trace> traces;
+    for(int i=1; i<argc; i++)
+    {
+        if(!loadTrace(argv[i], traces))
+            return 1;
+    }
+    if(traces.empty())
+        builtinTraces(traces);
+
+    libvlc_int_t *vlc = libvlc_InternalCreate();
+    if(!vlc)
+        return 1;
+
+    SimulatedPlaylist *playlist = new SimulatedPlaylist(VLC_OBJECT(vlc));
+    BasePeriod *period = new BasePeriod(playlist);
+    BaseAdaptationSet *adaptSet = new BaseAdaptationSet(period);
+    adaptSet->setID(ID("video"));
+    for(size_t i=0; i<ARRAY_SIZE(bitrates); i++)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(adaptSet);
+        rep->setID(ID(i));
+        rep->setBandwidth(bitrates[i] * 1000);
+        adaptSet->addRepresentation(rep);
+    }
+    period->addAdaptationSet(adaptSet);
+    playlist->addPeriod(period);
+
+    printf("%-16s %-12s %10s %9s %10s %10s\n",
+           "trace", "logic", "avg kbps", "switches", "stalled s", "startup s");
+    for(size_t i=0; i<traces.size(); i++)
+    {
+        for(size_t j=0; j<ARRAY_SIZE(logics); j++)
+        {
+            AbstractAdaptationLogic *logic = logics[j].create(VLC_OBJECT(vlc));
+            const Results res = simulate(logic, adaptSet, traces[i]);
+            delete logic;
+
+            printf("%-16s %-12s %10" PRIu64 " %9u %10.2f %10.2f\n",
+                   traces[i].name.c_str(), logics[j].name,
+                   res.segments ? res.bitratesum / res.segments / 1000 : 0,
+                   res.switches, secf_from_vlc_tick(res.stalled),
+                   secf_from_vlc_tick(res.startup));
+        }
+    }
+
+    delete playlist;
+    libvlc_InternalDestroy(vlc);
+
+    return 0;
+}
@@ -229,6 +229,62 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
     const SingleValueTag *ctx_byterange = NULL;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = NULL;
+    const AttributesTag *ctx_servercontrol = NULL;
+
+    /* Low latency parts of the next segment, only usable when they
+     * are all byte ranges of the resource of their parent segment */
+    std::string ctx_partsurl;
+    std::size_t ctx_partsoffset = 0;
+    bool ctx_parts = false;
+    bool ctx_partsinsegment = true;
+
+    auto addPart = [&](const std::string &url, bool b_byterange, std::size_t offset)
+    {
+        if(!ctx_parts)
+        {
+            ctx_parts = true;
+            ctx_partsurl = url;
+            ctx_partsoffset = offset;
+            ctx_partsinsegment = b_byterange;
+        }
+        else if(!b_byterange || url != ctx_partsurl)
+        {
+            ctx_partsinsegment = false;
+        }
+    };
+
+    auto createSegment = [&](const std::string &url, double duration)
+    {
+        HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+        if(!segment)
+            return segment;
+
+        segment->setSourceUrl(url);
+
+        const vlc_tick_t nzDuration = vlc_tick_from_sec( duration );
+        segment->duration.Set(duration * (uint64_t) rep->getTimescale());
+        segment->startTime.Set(rep->getTimescale().ToScaled(nzStartTime));
+        nzStartTime += nzDuration;
+        totalduration += nzDuration;
+        if(absReferenceTime != VLC_TICK_INVALID)
+        {
+            segment->utcTime = absReferenceTime;
+            absReferenceTime += nzDuration;
+        }
+
+        segmentList->addSegment(segment);
+
+        if(discontinuity)
+        {
+            segment->discontinuity = true;
+            discontinuity = false;
+        }
+
+        if(encryption.method != CommonEncryption::Method::NONE)
+            segment->setEncryption(encryption);
+
+        return segment;
+    };
 
     std::list<Tag *>::const_iterator it;
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
@@ -259,11 +315,9 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
+                /* Parts were describing this now complete segment */
+                ctx_parts = false;
+                ctx_partsinsegment = true;
 
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 double duration = rep->targetDuration;
@@ -274,18 +328,10 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
                         duration = durAttribute->floatingPoint();
                     ctx_extinf = NULL;
                 }
-                const vlc_tick_t nzDuration = vlc_tick_from_sec( duration );
-                segment->duration.Set(duration * (uint64_t) rep->getTimescale());
-                segment->startTime.Set(rep->getTimescale().ToScaled(nzStartTime));
-                nzStartTime += nzDuration;
-                totalduration += nzDuration;
-                if(absReferenceTime != VLC_TICK_INVALID)
-                {
-                    segment->utcTime = absReferenceTime;
-                    absReferenceTime += nzDuration;
-                }
 
-                segmentList->addSegment(segment);
+                HLSSegment *segment = createSegment(uritag->getValue().value, duration);
+                if(!segment)
+                    break;
 
                 if(ctx_byterange)
                 {
@@ -296,18 +342,49 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
                     segment->setByteRange(range.first, prevbyterangeoffset - 1);
                     ctx_byterange = NULL;
                 }
+            }
+            break;
 
-                if(discontinuity)
-                {
-                    segment->discontinuity = true;
-                    discontinuity = false;
-                }
+            case AttributesTag::EXTXPART:
+            {
+                const AttributesTag *parttag = static_cast<const AttributesTag *>(tag);
+                const Attribute *uriAttr = parttag->getAttributeByName("URI");
+                if(!uriAttr)
+                    break;
+                const Attribute *byterangeAttr = parttag->getAttributeByName("BYTERANGE");
+                std::size_t offset = 0;
+                if(byterangeAttr)
+                    offset = byterangeAttr->unescapeQuotes().getByteRange().first;
+                addPart(uriAttr->quotedString(), byterangeAttr != NULL, offset);
+            }
+            break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+            {
+                const AttributesTag *hinttag = static_cast<const AttributesTag *>(tag);
+                const Attribute *typeAttr = hinttag->getAttributeByName("TYPE");
+                const Attribute *uriAttr = hinttag->getAttributeByName("URI");
+                if(!typeAttr || typeAttr->value != "PART" || !uriAttr)
+                    break;
+                const Attribute *startAttr = hinttag->getAttributeByName("BYTERANGE-START");
+                addPart(uriAttr->quotedString(), startAttr != NULL,
+                        startAttr ? startAttr->decimal() : 0);
+            }
+            break;
 
-                if(encryption.method != CommonEncryption::Method::NONE)
-                    segment->setEncryption(encryption);
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *targetAttr = static_cast<const AttributesTag *>(tag)
+                                              ->getAttributeByName("PART-TARGET");
+                if(targetAttr)
+                    rep->partTargetDuration = vlc_tick_from_sec(targetAttr->floatingPoint());
             }
             break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+                ctx_servercontrol = static_cast<const AttributesTag *>(tag);
+                break;
+
             case SingleValueTag::EXTXTARGETDURATION:
                 rep->targetDuration = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
                 break;
@@ -364,6 +441,42 @@ void M3U8Parser::parseSegments(vlc_object_t *, Representation *rep, const std::l
         }
     }
 
+    const bool b_lowlatency = rep->isLive() && ctx_parts && ctx_partsinsegment;
+    if(b_lowlatency)
+    {
+        /* The segment still being published can be requested as a whole,
+         * its resource then gets delivered part after part as chunks */
+        HLSSegment *segment = createSegment(ctx_partsurl, rep->targetDuration);
+        if(segment && ctx_partsoffset)
+            segment->setByteRange(ctx_partsoffset, 0);
+    }
+    else
+    {
+        /* Separate parts resources are not used: whole segments are
+         * downloaded, so buffering and reloads stay segment based */
+        rep->partTargetDuration = 0;
+    }
+
+    M3U8 *m3u8 = static_cast<M3U8 *>(rep->getPlaylist());
+    if(rep->isLive() && ctx_servercontrol)
+    {
+        const Attribute *holdbackAttr = ctx_servercontrol->getAttributeByName(
+                    b_lowlatency ? "PART-HOLD-BACK" : "HOLD-BACK");
+        if(holdbackAttr)
+        {
+            const vlc_tick_t holdback = vlc_tick_from_sec(holdbackAttr->floatingPoint());
+            if(b_lowlatency)
+            {
+                m3u8->setLowLatency(true);
+                m3u8->setMinBuffering(holdback);
+            }
+            else if(!m3u8->suggestedPresentationDelay.Get())
+            {
+                m3u8->suggestedPresentationDelay.Set(holdback);
+            }
+        }
+    }
+
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
@@ -44,6 +44,7 @@ Representation::Representation  ( BaseAdaptationSet *set ) :
     b_loaded = false;
     nextUpdateTime = 0;
     targetDuration = 0;
+    partTargetDuration = 0;
     streamFormat = StreamFormat::UNKNOWN;
 }
 
@@ -108,7 +109,12 @@ void Representation::scheduleNextUpdate(uint64_t number)
 
     /* Update frequency must always be at least targetDuration (if any)
      * but we need to update before reaching that last segment, thus -1 */
-    if(targetDuration)
+    if(partTargetDuration)
+    {
+        /* Low latency playlists get new parts published at that pace */
+        minbuffer = partTargetDuration;
+    }
+    else if(targetDuration)
     {
         if(minbuffer > vlc_tick_from_sec( 2 * targetDuration + 1 ))
             minbuffer -= vlc_tick_from_sec( targetDuration + 1 );
@@ -59,6 +59,7 @@ namespace hls
                 bool b_loaded;
                 time_t nextUpdateTime;
                 time_t targetDuration;
+                vlc_tick_t partTargetDuration;
                 Url playlistUrl;
         };
     }
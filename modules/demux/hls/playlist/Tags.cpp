@@ -321,6 +321,10 @@ Tag * TagFactory::createTagByName(const std::string &name, const std::string &va
         {"EXT-X-START",                     AttributesTag::EXTXSTART},
         {"EXT-X-STREAM-INF",                AttributesTag::EXTXSTREAMINF},
         {"EXT-X-SESSION-KEY",               AttributesTag::EXTXSESSIONKEY},
+        {"EXT-X-SERVER-CONTROL",            AttributesTag::EXTXSERVERCONTROL},
+        {"EXT-X-PART-INF",                  AttributesTag::EXTXPARTINF},
+        {"EXT-X-PART",                      AttributesTag::EXTXPART},
+        {"EXT-X-PRELOAD-HINT",              AttributesTag::EXTXPRELOADHINT},
         {"EXTINF",                          ValuesListTag::EXTINF},
         {"",                                SingleValueTag::URI},
         {NULL,                              0},
@@ -358,6 +362,10 @@ Tag * TagFactory::createTagByName(const std::string &name, const std::string &va
         case AttributesTag::EXTXMEDIA:
         case AttributesTag::EXTXSTART:
         case AttributesTag::EXTXSTREAMINF:
+        case AttributesTag::EXTXSERVERCONTROL:
+        case AttributesTag::EXTXPARTINF:
+        case AttributesTag::EXTXPART:
+        case AttributesTag::EXTXPRELOADHINT:
             return new (std::nothrow) AttributesTag(exttagmapping[i].i, value);
         }
 
@@ -62,11 +62,14 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,p_indexer(NULL)
 {
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    delete p_indexer;
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -515,6 +518,36 @@ bool matroska_segment_c::PreloadClusters(uint64 i_cluster_pos)
     return true;
 }
 
+bool matroska_segment_c::StartIndexer()
+{
+    /* the cues are enough to seek */
+    if( b_cues && _seeker._cluster_positions.size() > 1 )
+        return false;
+
+    if( cluster == NULL || p_indexer != NULL )
+        return false;
+
+    /* a second stream on a network input would be a second connection */
+    if( sys.demuxer.psz_filepath == NULL )
+        return false;
+
+    p_indexer = new (std::nothrow) SegmentIndexer( &sys.demuxer, segment, i_timescale,
+                                                   cluster->GetElementPosition(),
+                                                   !sys.b_fastseekable );
+    if( p_indexer == NULL )
+        return false;
+
+    if( !p_indexer->Start() )
+    {
+        delete p_indexer;
+        p_indexer = NULL;
+        return false;
+    }
+
+    msg_Dbg( &sys.demuxer, "indexing clusters in the background" );
+    return true;
+}
+
 bool matroska_segment_c::PreloadFamily( const matroska_segment_c & of_segment )
 {
     if ( b_preloaded )
@@ -835,6 +868,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    if( p_indexer )
+        p_indexer->Flush( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
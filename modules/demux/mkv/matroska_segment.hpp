@@ -27,6 +27,7 @@
 #include "demux.hpp"
 #include "mkv.hpp"
 #include "matroska_segment_seeker.hpp"
+#include "matroska_segment_indexer.hpp"
 #include <vector>
 #include <string>
 
@@ -141,6 +142,7 @@ public:
     bool Preload();
     bool PreloadFamily( const matroska_segment_c & segment );
     bool PreloadClusters( uint64 i_cluster_position );
+    bool StartIndexer();
     void InformationCreate();
 
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
@@ -174,6 +176,7 @@ private:
     void EnsureDuration();
 
     SegmentSeeker _seeker;
+    SegmentIndexer *p_indexer;
 
     friend SegmentSeeker;
 };
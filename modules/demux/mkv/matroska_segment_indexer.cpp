@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * matroska_segment_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "matroska_segment_indexer.hpp"
+#include "Ebml_parser.hpp"
+#include "stream_io_callback.hpp"
+
+#include <vlc_stream_extractor.h>
+
+namespace mkv {
+
+/* delay between two clusters when each jump costs a new request */
+#define INDEXER_THROTTLE_DELAY VLC_TICK_FROM_MS(100)
+
+SegmentIndexer::SegmentIndexer( demux_t *p_demux_, KaxSegment *p_segment,
+                                uint64_t i_timescale_,
+                                SegmentSeeker::fptr_t i_start_,
+                                bool b_throttle_ )
+    :p_demux( p_demux_ )
+    ,segment( new KaxSegment( *p_segment ) ) /* not shared with the demuxer parser */
+    ,i_timescale( i_timescale_ )
+    ,i_start( i_start_ )
+    ,b_throttle( b_throttle_ )
+    ,b_running( false )
+    ,p_interrupt( NULL )
+    ,b_abort( false )
+{
+    vlc_mutex_init( &lock );
+    vlc_cond_init( &wait );
+}
+
+SegmentIndexer::~SegmentIndexer()
+{
+    if( b_running )
+    {
+        vlc_mutex_lock( &lock );
+        b_abort = true;
+        vlc_cond_signal( &wait );
+        vlc_mutex_unlock( &lock );
+
+        /* unblock the stream reads */
+        vlc_interrupt_kill( p_interrupt );
+        vlc_join( thread, NULL );
+    }
+
+    if( p_interrupt )
+        vlc_interrupt_destroy( p_interrupt );
+
+    delete segment;
+}
+
+bool SegmentIndexer::Start()
+{
+    p_interrupt = vlc_interrupt_create();
+    if( unlikely(p_interrupt == NULL) )
+        return false;
+
+    b_running = !vlc_clone( &thread, Thread, this, VLC_THREAD_PRIORITY_LOW );
+    return b_running;
+}
+
+void SegmentIndexer::Flush( SegmentSeeker & seeker )
+{
+    std::vector<SegmentSeeker::Cluster> clusters;
+
+    vlc_mutex_lock( &lock );
+    clusters.swap( pending );
+    vlc_mutex_unlock( &lock );
+
+    for( size_t i = 0; i < clusters.size(); ++i )
+        seeker.add_cluster( clusters[i] );
+}
+
+bool SegmentIndexer::Wait( vlc_tick_t i_deadline )
+{
+    vlc_mutex_locker guard( &lock );
+
+    while( !b_abort )
+    {
+        if( vlc_cond_timedwait( &wait, &lock, i_deadline ) )
+            break;
+    }
+    return !b_abort;
+}
+
+void *SegmentIndexer::Thread( void *data )
+{
+    SegmentIndexer *p_this = static_cast<SegmentIndexer*>( data );
+
+    vlc_interrupt_set( p_this->p_interrupt );
+    p_this->Run();
+    return NULL;
+}
+
+void SegmentIndexer::Run()
+{
+    /* the demuxer stream cannot be shared, use a new one, with the same
+     * MRL anchor (archive entry...) */
+    stream_t *s = vlc_stream_NewMRL( p_demux, p_demux->psz_url );
+    if( s == NULL )
+    {
+        msg_Warn( p_demux, "cannot open a stream to index clusters" );
+        return;
+    }
+
+    vlc_stream_io_callback io_callback( s, true );
+    EbmlStream estream( io_callback );
+    size_t i_count = 0;
+
+    try
+    {
+        io_callback.setFilePointer( i_start );
+        EbmlParser ep( &estream, segment, p_demux );
+
+        while( EbmlElement *el = ep.Get() )
+        {
+            MKV_CHECKED_PTR_DECL( p_cluster, KaxCluster, el );
+            if( p_cluster == NULL )
+                continue;
+
+            if( !p_cluster->IsFiniteSize() )
+            {
+                msg_Dbg( p_demux, "cluster of unknown size, stop indexing" );
+                break;
+            }
+
+            SegmentSeeker::Cluster cinfo = {
+                /* fpos     */ p_cluster->GetElementPosition(),
+                /* pts      */ vlc_tick_t( -1 ),
+                /* duration */ vlc_tick_t( -1 ),
+                /* size     */ p_cluster->GetEndPosition() - p_cluster->GetElementPosition()
+            };
+
+            ep.Down();
+            while( EbmlElement *child = ep.Get() )
+            {
+                if( MKV_CHECKED_PTR_DECL( p_tc, KaxClusterTimecode, child ) )
+                {
+                    p_tc->ReadData( estream.I_O(), SCOPE_ALL_DATA );
+                    cinfo.pts = VLC_TICK_FROM_NS( static_cast<uint64>( *p_tc ) * i_timescale );
+                    break;
+                }
+            }
+
+            /* skip the blocks */
+            io_callback.setFilePointer( cinfo.fpos + cinfo.size );
+            ep.reconstruct( &estream, segment, p_demux );
+
+            if( cinfo.pts != -1 )
+            {
+                vlc_mutex_lock( &lock );
+                pending.push_back( cinfo );
+                vlc_mutex_unlock( &lock );
+                i_count++;
+            }
+
+            vlc_tick_t i_deadline = vlc_tick_now();
+            if( b_throttle )
+                i_deadline += INDEXER_THROTTLE_DELAY;
+            if( !Wait( i_deadline ) )
+                break;
+        }
+    }
+    catch(...)
+    {
+        msg_Err( p_demux, "error while indexing clusters" );
+    }
+
+    msg_Dbg( p_demux, "indexed %zu clusters", i_count );
+}
+
+} // namespace
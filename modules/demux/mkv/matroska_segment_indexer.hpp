@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * matroska_segment_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+#define MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+
+#include "mkv.hpp"
+#include "matroska_segment_seeker.hpp"
+
+#include <vlc_threads.h>
+#include <vlc_interrupt.h>
+
+#include <vector>
+
+namespace mkv {
+
+/*****************************************************************************
+ * Background cluster indexer
+ *****************************************************************************
+ * Walks the cluster headers of a segment from its own stream, jumping over
+ * the cluster payloads, so that seeking in files without usable cues only
+ * has to parse the cluster containing the target.
+ *****************************************************************************/
+class SegmentIndexer
+{
+    public:
+        SegmentIndexer( demux_t *, KaxSegment *, uint64_t i_timescale,
+                        SegmentSeeker::fptr_t i_start, bool b_throttle );
+        ~SegmentIndexer();
+
+        bool Start();
+
+        /* add the clusters found since the last call to the seeker */
+        void Flush( SegmentSeeker & );
+
+    private:
+        static void *Thread( void * );
+        void Run();
+        bool Wait( vlc_tick_t i_deadline );
+
+        demux_t               *p_demux;
+        KaxSegment            *segment;
+        uint64_t               i_timescale;
+        SegmentSeeker::fptr_t  i_start;
+        bool                   b_throttle;
+
+        bool                   b_running;
+        vlc_thread_t           thread;
+        vlc_interrupt_t       *p_interrupt;
+
+        vlc_mutex_t            lock;
+        vlc_cond_t             wait;
+        bool                   b_abort;
+        std::vector<SegmentSeeker::Cluster> pending;
+};
+
+} // namespace
+
+#endif /* include-guard */
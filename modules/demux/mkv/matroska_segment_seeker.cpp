@@ -53,12 +53,15 @@ namespace mkv {
 SegmentSeeker::cluster_positions_t::iterator
 SegmentSeeker::add_cluster_position( fptr_t fpos )
 {
-    cluster_positions_t::iterator insertion_point = std::upper_bound(
+    cluster_positions_t::iterator insertion_point = std::lower_bound(
       _cluster_positions.begin(),
       _cluster_positions.end(),
       fpos
     );
 
+    if( insertion_point != _cluster_positions.end() && *insertion_point == fpos )
+        return insertion_point; // already known, e.g. from the indexer
+
     return _cluster_positions.insert( insertion_point, fpos );
 }
 
@@ -74,6 +77,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
@@ -80,6 +80,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback"), true );
 
+    add_bool( "mkv-index-clusters", true,
+            N_("Index clusters in the background"),
+            N_("Find the cluster positions of files without cues in a background thread, to speed up seeking"), true );
+
     add_shortcut( "mka", "mkv" )
 vlc_module_end ()
 
@@ -260,6 +264,18 @@ static int Open( vlc_object_t * p_this )
         goto error;
     }
 
+    if( p_sys->b_seekable && !p_demux->b_preparsing &&
+        var_InheritBool( p_demux, "mkv-index-clusters" ) &&
+        !var_InheritBool( p_demux, "mkv-preload-clusters" ) )
+    {
+        /* only the segments read from the demuxer stream */
+        for( size_t i = 0; i < p_sys->opened_segments.size(); i++ )
+        {
+            if( &p_sys->opened_segments[i]->es == &p_stream->estream )
+                p_sys->opened_segments[i]->StartIndexer();
+        }
+    }
+
     return VLC_SUCCESS;
 
 error:
@@ -334,31 +334,39 @@ static es_out_id_t * MP4_AddTrackES( es_out_t *out, mp4_track_t *p_track )
     return p_es;
 }
 
+/* Return the decoding time of the n-th sample of a chunk, relative to the
+ * chunk first sample, walking the stts table from the chunk position */
+static stime_t MP4_ChunkGetSampleDTSOffset( const mp4_track_t *p_track,
+                                           const mp4_chunk_t *ck,
+                                           uint32_t i_sample )
+{
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_index = ck->i_stts_index;
+    uint32_t i_skip = ck->i_stts_skip;
+    stime_t i_offset = 0;
+
+    while( i_sample > 0 && i_index < stts->i_entry_count )
+    {
+        uint32_t i_count = __MIN( i_sample,
+                                  stts->pi_sample_count[i_index] - i_skip );
+        i_offset += (stime_t) i_count * (uint32_t) stts->pi_sample_delta[i_index];
+        i_sample -= i_count;
+        i_skip = 0;
+        i_index++;
+    }
+
+    return i_offset;
+}
+
 /* Return time in microsecond of a track */
 static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
-    int64_t sdts = p_chunk->i_first_dts;
-
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
-        {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    int64_t sdts = p_chunk->i_first_dts +
+        MP4_ChunkGetSampleDTSOffset( p_track, p_chunk,
+                                     p_track->i_sample - p_chunk->i_sample_first );
 
     vlc_tick_t i_dts = MP4_rescale_mtime( sdts, p_track->i_timescale );
 
@@ -388,24 +396,28 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          vlc_tick_t *pi_delta )
 {
     VLC_UNUSED( p_demux );
-    mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
+    uint32_t i_sample = p_track->i_sample - ck->i_sample_first;
+    uint32_t i_skip = ck->i_ctts_skip;
 
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    if( ctts == NULL || i_sample >= ck->i_sample_count )
         return false;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
+    for( uint32_t i_index = ck->i_ctts_index; i_index < ctts->i_entry_count; i_index++ )
     {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
+        uint32_t i_count = ctts->pi_sample_count[i_index] - i_skip;
+        if( i_sample < i_count )
         {
-            *pi_delta = MP4_rescale_mtime( ck->p_sample_offset_pts[i_index],
+            *pi_delta = MP4_rescale_mtime( ctts->pi_sample_offset[i_index] +
+                                           p_track->i_cts_shift,
                                            p_track->i_timescale );
             return true;
         }
 
-        i_sample -= ck->p_sample_count_pts[i_index];
+        i_sample -= i_count;
+        i_skip = 0;
     }
     return false;
 }
@@ -416,43 +428,17 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     VLC_UNUSED( p_demux );
 
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
+    uint32_t i_sample = p_track->i_sample - p_chunk->i_sample_first;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
+    /* Only count samples from this chunk */
+    if( i_sample >= p_chunk->i_sample_count )
+        return 0;
+    if( i_nb_samples > p_chunk->i_sample_count - i_sample )
+        i_nb_samples = p_chunk->i_sample_count - i_sample;
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    stime_t i_duration =
+        MP4_ChunkGetSampleDTSOffset( p_track, p_chunk, i_sample + i_nb_samples ) -
+        MP4_ChunkGetSampleDTSOffset( p_track, p_chunk, i_sample );
 
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
 }
@@ -2327,12 +2313,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2394,54 +2374,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EBADVAR;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2479,18 +2411,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, use the box table */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2505,216 +2428,106 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
     /* Use stts table to create a sample number -> dts table.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     *  the box! so each chunk only stores its position in the table, and
+     *  its samples dts are computed from there when needed (problem with
+     *  raw stream where a sample is sometime just
+     *  channels*bits_per_sample/8) */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        p_demux_track->p_stts = stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        /* Set each chunk position and first dts */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
+        bool b_truncated = false;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* save first dts */
             ck->i_first_dts = i_next_dts;
+            ck->i_stts_index = i_index;
+            ck->i_stts_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
+            while( i_sample_count > 0 && i_index < stts->i_entry_count )
             {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                uint32_t i_count = __MIN( i_sample_count,
+                                          stts->pi_sample_count[i_index] - i_skip );
+                i_next_dts += (int64_t) i_count * (uint32_t) stts->pi_sample_delta[i_index];
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == stts->pi_sample_count[i_index] )
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
+            }
 
+            if( i_sample_count > 0 && !b_truncated )
+            {
+                msg_Err( p_demux, "invalid index counting total samples %u %u",
+                         i_index, stts->i_entry_count );
+                b_truncated = true;
             }
+
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
     }
 
-
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        p_demux_track->p_ctts = ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
+        p_demux_track->i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
 
-        /* Create pts-dts table per chunk */
+        /* Set each chunk position */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->i_ctts_index = i_index;
+            ck->i_ctts_skip = i_skip;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
+            while( i_sample_count > 0 && i_index < ctts->i_entry_count )
             {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                uint32_t i_count = __MIN( i_sample_count,
+                                          ctts->pi_sample_count[i_index] - i_skip );
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == ctts->pi_sample_count[i_index] )
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
-
-
             }
         }
     }
@@ -3018,52 +2831,45 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale_qtime( start, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    /* *** find good chunk: the last one starting before i_start *** */
+    uint32_t i_low = 0;
+    uint32_t i_high = p_track->i_chunk_count;
+    while( i_high - i_low > 1 )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+        uint32_t i_mid = i_low + ( i_high - i_low ) / 2;
+        if( (uint64_t)i_start >= p_track->chunk[i_mid].i_first_dts )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
     }
+    i_chunk = i_low;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint32_t i_left = ck->i_sample_count;
+    uint32_t i_skip = ck->i_stts_skip;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
+
+    for( uint32_t i_index = ck->i_stts_index;
+         i_index < stts->i_entry_count && i_left > 0; i_index++ )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        uint32_t i_count = __MIN( i_left, stts->pi_sample_count[i_index] - i_skip );
+        uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+        if( i_dts + (uint64_t) i_count * i_delta < (uint64_t)i_start )
+        {
+            i_dts    += (uint64_t) i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            if( i_delta > 0 )
+                i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
@@ -3484,15 +3290,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3505,16 +3302,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
 
@@ -47,18 +47,12 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
-
+    /* position of the first sample in the track stts/ctts tables:
+       entry index, and samples of that entry belonging to previous chunks */
+    uint32_t     i_stts_index;
+    uint32_t     i_stts_skip;
+    uint32_t     i_ctts_index;
+    uint32_t     i_ctts_skip;
 } mp4_chunk_t;
 
 typedef struct
@@ -129,8 +123,13 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz table, owned by the box */
+
+    /* dts and pts-dts run-length tables, owned by the boxes and walked
+       from the chunks positions when needed */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
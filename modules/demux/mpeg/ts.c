@@ -34,6 +34,8 @@
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
 
 #include "ts_pid.h"
 #include "ts_streams.h"
@@ -44,6 +46,7 @@
 #include "ts_psip.h"
 
 #include "ts_hotfixes.h"
+#include "ts_index.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
 #include "sections.h"
@@ -61,6 +64,7 @@
 #endif
 
 #include <assert.h>
+#include <sys/stat.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -111,6 +115,12 @@ static void Close ( vlc_object_t * );
     "Seek and position based on a percent byte position, not a PCR generated " \
     "time position. If seeking doesn't work property, turn on this option." )
 
+#define SEEK_INDEX_TEXT N_("Keep seek index")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Save the time to position index built while playing local files to " \
+    "the cache directory, so that later seeks in the same file are exact " \
+    "without searching." )
+
 #define CC_CHECK_TEXT       "Check packets continuity counter"
 #define CC_CHECK_LONGTEXT   "Detect discontinuities and drop packet duplicates. " \
                             "(bluRay sources are known broken and have false positives). "
@@ -157,6 +167,7 @@ vlc_module_begin ()
 
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
+    add_bool( "ts-seek-index", false, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT, true )
     add_bool( "ts-cc-check", true, CC_CHECK_TEXT, CC_CHECK_LONGTEXT, true )
     add_bool( "ts-pmtfix-waitdata", true, TS_SKIP_GHOST_PROGRAM_TEXT, NULL, true )
     add_bool( "ts-patfix", true, TS_PATFIX_TEXT, NULL, true )
@@ -196,10 +207,14 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void PrescanTSPackets( demux_t *p_demux );
+static unsigned SkipTSPackets( demux_t *p_demux );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
 static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
+static void IndexOpen( demux_t * );
+static void IndexClose( demux_t * );
 
 #define TS_PACKET_SIZE_188 188
 #define TS_PACKET_SIZE_192 192
@@ -406,6 +421,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_ts_read = 50;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
+    p_sys->b_recording = false;
 
     vlc_dictionary_init( &p_sys->attachments, 0 );
 
@@ -530,6 +546,9 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    if( p_sys->b_canfastseek && !p_demux->b_preparsing )
+        IndexOpen( p_demux );
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
@@ -590,6 +609,8 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    IndexClose( p_demux );
+
     free( p_sys );
 }
 
@@ -631,16 +652,32 @@ static int Demux( demux_t *p_demux )
         GetPID(p_sys, 0)->u.p_pat->b_generated = true;
     }
 
+    /* The stream might have been seeked since the previous call */
+    p_sys->prescan.i_count = p_sys->prescan.i_index = 0;
+
     /* We read at most 100 TS packet or until a frame is completed */
     for( unsigned i_pkt = 0; i_pkt < p_sys->i_ts_read; i_pkt++ )
     {
         bool         b_frame = false;
         int          i_header = 0;
         block_t     *p_pkt;
+
+        if( p_sys->prescan.i_index >= p_sys->prescan.i_count )
+            PrescanTSPackets( p_demux );
+
+        /* Drop at once the packets that would be discarded unparsed */
+        unsigned i_skipped = SkipTSPackets( p_demux );
+        if( i_skipped > 0 )
+        {
+            i_pkt += i_skipped - 1;
+            continue;
+        }
+
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
             return VLC_DEMUXER_EOF;
         }
+        p_sys->prescan.i_index++;
 
         if( p_sys->b_start_record )
         {
@@ -648,6 +685,7 @@ static int Demux( demux_t *p_demux )
             vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE, true,
                                 "ts" );
             p_sys->b_start_record = false;
+            p_sys->b_recording = true;
         }
 
         /* Early reject truncated packets from hw devices */
@@ -1174,6 +1212,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE,
                                 false );
         p_sys->b_start_record = b_bool;
+        p_sys->b_recording = false;
         return VLC_SUCCESS;
 
     case DEMUX_GET_SIGNAL:
@@ -1793,6 +1832,7 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     {
         msg_Warn( p_demux, "lost synchro" );
         block_Release( p_pkt );
+        p_sys->prescan.i_count = 0;
         for( ;; )
         {
             const uint8_t *p_peek;
@@ -1834,6 +1874,84 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     return p_pkt;
 }
 
+/* Scans the headers of the next packets without reading them */
+static void PrescanTSPackets( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint8_t *p_peek;
+
+    p_sys->prescan.i_count = p_sys->prescan.i_index = 0;
+
+    /* Peeking ahead would delay live streams */
+    if( !p_sys->b_canseek || p_sys->b_lowdelay )
+        return;
+
+    ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                        __MIN(p_sys->i_ts_read, TS_PRESCAN_MAX) * p_sys->i_packet_size );
+    if( i_peek > 0 )
+        ts_prescan( &p_sys->prescan, p_peek, i_peek, p_sys->i_packet_size,
+                    p_sys->i_packet_header_size );
+}
+
+/* Whether a packet would be dropped without any side effect by Demux() */
+static bool IsTSPacketSkippable( demux_sys_t *p_sys, uint16_t i_pid,
+                                 uint8_t i_flags )
+{
+    if( i_flags & TS_PRESCAN_TEI )
+        return false;
+    if( i_pid == 0x1FFF )
+        return true;
+    if( i_flags & (TS_PRESCAN_SCRAMBLED|TS_PRESCAN_ADAPTATION) )
+        return false; /* scrambling state changes, PCR */
+
+    const ts_pid_t *p_pid = p_sys->pids.pp_table[i_pid];
+    return p_pid != NULL && SEEN(p_pid) && p_pid->type == TYPE_STREAM &&
+           !(p_pid->i_flags & (FLAG_FILTERED|FLAG_SCRAMBLED));
+}
+
+/* Skips the pre-scanned packets for unselected ES and null packets
+ * @return the number of skipped packets */
+static unsigned SkipTSPackets( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_prescan_t *p_scan = &p_sys->prescan;
+
+    /* Recording needs all the data, and PAT-less probing all the packets */
+    if( p_sys->b_access_control || p_sys->b_start_record ||
+        p_sys->b_recording || p_sys->es_creation == DELAY_ES ||
+        !SEEN(&p_sys->pids.pat) )
+        return 0;
+
+    unsigned i_skip = 0;
+    while( p_scan->i_index + i_skip < p_scan->i_count &&
+           IsTSPacketSkippable( p_sys, p_scan->pid[p_scan->i_index + i_skip],
+                                p_scan->flags[p_scan->i_index + i_skip] ) )
+        i_skip++;
+
+    if( i_skip == 0 )
+        return 0;
+
+    const size_t i_size = i_skip * p_sys->i_packet_size;
+    if( vlc_stream_Read( p_sys->stream, NULL, i_size ) != (ssize_t)i_size )
+    {
+        p_scan->i_count = 0;
+        return 0; /* let ReadTSPacket() handle it */
+    }
+
+    for( unsigned i = p_scan->i_index; i < p_scan->i_index + i_skip; i++ )
+    {
+        ts_pid_t *p_pid = p_sys->pids.pp_table[p_scan->pid[i]];
+        if( p_pid->type == TYPE_STREAM )
+        {
+            /* Continuity is no longer tracked */
+            p_pid->i_cc = 0xff;
+            p_sys->b_end_preparse = true;
+        }
+    }
+    p_scan->i_index += i_skip;
+    return i_skip;
+}
+
 static stime_t GetPCR( const block_t *p_pkt )
 {
     const uint8_t *p = p_pkt->p_buffer;
@@ -1956,6 +2074,23 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
+    /* Narrow, or skip, the search with the already indexed positions */
+    stime_t i_index_time;
+    uint64_t i_index_before, i_index_after;
+    if( p_sys->p_index &&
+        ts_index_Lookup( p_sys->p_index, p_pmt->i_number, p_pmt->pcr.i_first,
+                         i_scaledtime, &i_index_time,
+                         &i_index_before, &i_index_after ) == VLC_SUCCESS &&
+        i_index_before < i_tail_pos )
+    {
+        if( i_scaledtime - i_index_time < TS_INDEX_INTERVAL )
+            return vlc_stream_Seek( p_sys->stream, i_index_before );
+
+        i_head_pos = i_index_before;
+        if( i_index_after < i_tail_pos )
+            i_tail_pos = i_index_after;
+    }
+
     bool b_found = false;
     while( (i_head_pos + p_sys->i_packet_size) <= i_tail_pos && !b_found )
     {
@@ -1999,6 +2134,12 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                     }
                 }
 
+                /* Also remember the PCR positions found by the search */
+                if( i_pcr != -1 && p_sys->p_index )
+                    ts_index_Add( p_sys->p_index, p_pmt->i_number, p_pmt->pcr.i_first,
+                                  TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr ),
+                                  i_pos - p_sys->i_packet_size );
+
                 if( i_pcr == -1 )
                 {
                     stime_t i_dts = -1;
@@ -2020,7 +2161,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 stime_t i_diff = i_scaledtime - TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr );
                 if ( i_diff < 0 )
                     i_tail_pos = (i_splitpos >= p_sys->i_packet_size) ? i_splitpos - p_sys->i_packet_size : 0;
-                else if( i_diff < TO_SCALE(VLC_TICK_0 + VLC_TICK_FROM_MS(500)) )
+                else if( i_diff < TO_SCALE_NZ(VLC_TICK_FROM_MS(500)) )
                     b_found = true;
                 else
                     i_head_pos = i_pos;
@@ -2042,6 +2183,83 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     return VLC_SUCCESS;
 }
 
+static char * IndexGetPath( demux_t *p_demux, struct stat *p_stat )
+{
+    if( p_demux->psz_filepath == NULL ||
+        vlc_stat( p_demux->psz_filepath, p_stat ) )
+        return NULL;
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, p_demux->psz_filepath, strlen( p_demux->psz_filepath ) );
+    EndMD5( &md5 );
+
+    char *psz_hash = psz_md5_hash( &md5 );
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_path = NULL;
+
+    if( psz_hash && psz_cachedir &&
+        asprintf( &psz_path, "%s" DIR_SEP "tsindex" DIR_SEP "%s",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+
+    free( psz_cachedir );
+    free( psz_hash );
+    return psz_path;
+}
+
+static void IndexOpen( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    p_sys->p_index = ts_index_New();
+    if( !p_sys->p_index || !var_InheritBool( p_demux, "ts-seek-index" ) )
+        return;
+
+    struct stat st;
+    char *psz_path = IndexGetPath( p_demux, &st );
+    if( psz_path &&
+        ts_index_Load( p_sys->p_index, psz_path, st.st_size, st.st_mtime ) == VLC_SUCCESS )
+        msg_Dbg( p_demux, "loaded seek index %s", psz_path );
+    free( psz_path );
+}
+
+static void IndexClose( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->p_index )
+        return;
+
+    if( var_InheritBool( p_demux, "ts-seek-index" ) )
+    {
+        struct stat st;
+        char *psz_path = IndexGetPath( p_demux, &st );
+        if( psz_path )
+        {
+            /* Create the cache directories if needed */
+            char *psz_sep = strrchr( psz_path, DIR_SEP_CHAR );
+            *psz_sep = '\0';
+            char *psz_parent = strrchr( psz_path, DIR_SEP_CHAR );
+            if( psz_parent )
+            {
+                *psz_parent = '\0';
+                vlc_mkdir( psz_path, 0700 );
+                *psz_parent = DIR_SEP_CHAR;
+            }
+            vlc_mkdir( psz_path, 0700 );
+            *psz_sep = DIR_SEP_CHAR;
+
+            if( ts_index_Save( p_sys->p_index, psz_path, st.st_size,
+                               st.st_mtime ) != VLC_SUCCESS )
+                msg_Warn( p_demux, "cannot save seek index %s", psz_path );
+            free( psz_path );
+        }
+    }
+
+    ts_index_Delete( p_sys->p_index );
+}
+
 static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, stime_t *pi_pcr, bool *pb_found )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -2389,6 +2607,11 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+
+                if( p_sys->p_index && p_pmt->pcr.i_first > -1 )
+                    ts_index_Add( p_sys->p_index, p_pmt->i_number,
+                                  p_pmt->pcr.i_first, i_program_pcr,
+                                  vlc_stream_Tell( p_sys->stream ) - p_sys->i_packet_size );
             }
         }
 
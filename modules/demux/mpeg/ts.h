@@ -25,6 +25,8 @@
 #endif
 typedef struct csa_t csa_t;
 
+#include "ts_prescan.h"
+
 #define TS_USER_PMT_NUMBER (0)
 
 #define TS_PSI_PAT_PID 0x00
@@ -71,6 +73,12 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* headers of the packets ahead, see ts_prescan() */
+    ts_prescan_t prescan;
+
+    /* PCR positions, for seeking */
+    struct ts_index_t *p_index;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -142,6 +150,7 @@ struct demux_sys_t
 
     /* */
     bool        b_start_record;
+    bool        b_recording;
 };
 
 void TsChangeStandard( demux_sys_t *, ts_standards_e );
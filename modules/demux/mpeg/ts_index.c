@@ -0,0 +1,369 @@
+/*****************************************************************************
+ * ts_index.c: Transport Stream time to offset index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+
+#include "ts_index.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TS_INDEX_MAGIC    "VLCTSIDX"
+#define TS_INDEX_VERSION  1
+#define TS_INDEX_MAX_POINTS (1 << 24)
+#define POINTS_ALLOC_CHUNK 256
+
+typedef struct
+{
+    stime_t  i_time;
+    uint64_t i_offset;
+} ts_index_point_t;
+
+typedef struct
+{
+    int      i_program;
+    stime_t  i_first;
+    ts_index_point_t *p_points; /* sorted by offset, hence by time */
+    size_t   i_count;
+    size_t   i_alloc;
+} ts_index_program_t;
+
+struct ts_index_t
+{
+    ts_index_program_t *p_programs;
+    size_t   i_programs;
+    bool     b_modified;
+};
+
+ts_index_t * ts_index_New( void )
+{
+    return calloc( 1, sizeof(ts_index_t) );
+}
+
+static void ts_index_Clear( ts_index_t *p_index )
+{
+    for( size_t i = 0; i < p_index->i_programs; i++ )
+        free( p_index->p_programs[i].p_points );
+    free( p_index->p_programs );
+    p_index->p_programs = NULL;
+    p_index->i_programs = 0;
+}
+
+void ts_index_Delete( ts_index_t *p_index )
+{
+    ts_index_Clear( p_index );
+    free( p_index );
+}
+
+static ts_index_program_t * ts_index_GetProgram( const ts_index_t *p_index,
+                                                 int i_program )
+{
+    for( size_t i = 0; i < p_index->i_programs; i++ )
+        if( p_index->p_programs[i].i_program == i_program )
+            return &p_index->p_programs[i];
+    return NULL;
+}
+
+static ts_index_program_t * ts_index_NewProgram( ts_index_t *p_index,
+                                                 int i_program, stime_t i_first )
+{
+    ts_index_program_t *p_realloc = realloc( p_index->p_programs,
+                        (p_index->i_programs + 1) * sizeof(*p_realloc) );
+    if( !p_realloc )
+        return NULL;
+    p_index->p_programs = p_realloc;
+
+    ts_index_program_t *p_prog = &p_realloc[p_index->i_programs++];
+    p_prog->i_program = i_program;
+    p_prog->i_first = i_first;
+    p_prog->p_points = NULL;
+    p_prog->i_count = 0;
+    p_prog->i_alloc = 0;
+    return p_prog;
+}
+
+/* Returns the number of points with an offset lower than i_offset */
+static size_t ts_index_FindOffset( const ts_index_program_t *p_prog,
+                                   uint64_t i_offset )
+{
+    size_t i_low = 0, i_high = p_prog->i_count;
+
+    /* Playback mostly appends */
+    if( i_high > 0 && p_prog->p_points[i_high - 1].i_offset < i_offset )
+        return i_high;
+
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_prog->p_points[i_mid].i_offset < i_offset )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+void ts_index_Add( ts_index_t *p_index, int i_program, stime_t i_first,
+                   stime_t i_time, uint64_t i_offset )
+{
+    ts_index_program_t *p_prog = ts_index_GetProgram( p_index, i_program );
+    if( p_prog == NULL )
+    {
+        p_prog = ts_index_NewProgram( p_index, i_program, i_first );
+        if( p_prog == NULL )
+            return;
+    }
+    else if( p_prog->i_first != i_first )
+    {
+        /* Another reference, the points times are meaningless now */
+        p_prog->i_first = i_first;
+        p_prog->i_count = 0;
+        p_index->b_modified = true;
+    }
+
+    size_t i_pos = ts_index_FindOffset( p_prog, i_offset );
+
+    /* Keep the points sparse, and sorted by both offset and time.
+     * Non monotonic clocks (discontinuities) are not indexed. */
+    if( i_pos > 0 && i_time < p_prog->p_points[i_pos - 1].i_time + TS_INDEX_INTERVAL )
+        return;
+    if( i_pos < p_prog->i_count &&
+        i_time + TS_INDEX_INTERVAL > p_prog->p_points[i_pos].i_time )
+        return;
+
+    if( p_prog->i_count >= TS_INDEX_MAX_POINTS )
+        return;
+
+    if( p_prog->i_count == p_prog->i_alloc )
+    {
+        ts_index_point_t *p_realloc = realloc( p_prog->p_points,
+                    (p_prog->i_alloc + POINTS_ALLOC_CHUNK) * sizeof(*p_realloc) );
+        if( !p_realloc )
+            return;
+        p_prog->p_points = p_realloc;
+        p_prog->i_alloc += POINTS_ALLOC_CHUNK;
+    }
+
+    memmove( &p_prog->p_points[i_pos + 1], &p_prog->p_points[i_pos],
+             (p_prog->i_count - i_pos) * sizeof(ts_index_point_t) );
+    p_prog->p_points[i_pos].i_time = i_time;
+    p_prog->p_points[i_pos].i_offset = i_offset;
+    p_prog->i_count++;
+    p_index->b_modified = true;
+}
+
+int ts_index_Lookup( const ts_index_t *p_index, int i_program, stime_t i_first,
+                     stime_t i_time, stime_t *pi_before_time,
+                     uint64_t *pi_before, uint64_t *pi_after )
+{
+    const ts_index_program_t *p_prog = ts_index_GetProgram( p_index, i_program );
+    if( p_prog == NULL || p_prog->i_first != i_first || p_prog->i_count == 0 )
+        return VLC_EGENERIC;
+
+    /* Find the first point after i_time */
+    size_t i_low = 0, i_high = p_prog->i_count;
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_prog->p_points[i_mid].i_time <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    if( i_low == 0 )
+        return VLC_EGENERIC;
+
+    *pi_before_time = p_prog->p_points[i_low - 1].i_time;
+    *pi_before = p_prog->p_points[i_low - 1].i_offset;
+    *pi_after = (i_low < p_prog->i_count) ? p_prog->p_points[i_low].i_offset
+                                          : UINT64_MAX;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Persistence
+ *****************************************************************************
+ * All little endian:
+ *  "VLCTSIDX", u32 version, u64 indexed file size, i64 mtime, u32 programs
+ *  then for each program:
+ *  i32 number, i64 first pcr, u32 points, then points as (i64 time, u64 offset)
+ *****************************************************************************/
+static bool ReadU32( FILE *p_file, uint32_t *pi_val )
+{
+    uint8_t buf[4];
+    if( fread( buf, sizeof(buf), 1, p_file ) != 1 )
+        return false;
+    *pi_val = GetDWLE( buf );
+    return true;
+}
+
+static bool ReadU64( FILE *p_file, uint64_t *pi_val )
+{
+    uint8_t buf[8];
+    if( fread( buf, sizeof(buf), 1, p_file ) != 1 )
+        return false;
+    *pi_val = GetQWLE( buf );
+    return true;
+}
+
+static bool WriteU32( FILE *p_file, uint32_t i_val )
+{
+    uint8_t buf[4];
+    SetDWLE( buf, i_val );
+    return fwrite( buf, sizeof(buf), 1, p_file ) == 1;
+}
+
+static bool WriteU64( FILE *p_file, uint64_t i_val )
+{
+    uint8_t buf[8];
+    SetQWLE( buf, i_val );
+    return fwrite( buf, sizeof(buf), 1, p_file ) == 1;
+}
+
+static bool ReadProgram( FILE *p_file, ts_index_t *p_index )
+{
+    uint32_t i_program, i_count;
+    uint64_t i_first;
+
+    if( !ReadU32( p_file, &i_program ) || !ReadU64( p_file, &i_first ) ||
+        !ReadU32( p_file, &i_count ) || i_count > TS_INDEX_MAX_POINTS )
+        return false;
+
+    if( ts_index_GetProgram( p_index, i_program ) )
+        return false;
+
+    ts_index_program_t *p_prog = ts_index_NewProgram( p_index, i_program,
+                                                      (stime_t) i_first );
+    if( !p_prog )
+        return false;
+
+    if( i_count == 0 )
+        return true;
+
+    p_prog->p_points = vlc_alloc( i_count, sizeof(ts_index_point_t) );
+    if( !p_prog->p_points )
+        return false;
+    p_prog->i_alloc = i_count;
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        uint64_t i_time, i_offset;
+        if( !ReadU64( p_file, &i_time ) || !ReadU64( p_file, &i_offset ) )
+            return false;
+
+        /* Must be strictly increasing */
+        if( i > 0 && ( (stime_t) i_time <= p_prog->p_points[i - 1].i_time ||
+                       i_offset <= p_prog->p_points[i - 1].i_offset ) )
+            return false;
+
+        p_prog->p_points[i].i_time = (stime_t) i_time;
+        p_prog->p_points[i].i_offset = i_offset;
+        p_prog->i_count++;
+    }
+    return true;
+}
+
+int ts_index_Load( ts_index_t *p_index, const char *psz_path,
+                   uint64_t i_size, int64_t i_mtime )
+{
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    if( !p_file )
+        return VLC_EGENERIC;
+
+    char magic[8];
+    uint32_t i_version, i_programs;
+    uint64_t i_file_size, i_file_mtime;
+    bool b_ok = fread( magic, sizeof(magic), 1, p_file ) == 1 &&
+                !memcmp( magic, TS_INDEX_MAGIC, sizeof(magic) ) &&
+                ReadU32( p_file, &i_version ) && i_version == TS_INDEX_VERSION &&
+                ReadU64( p_file, &i_file_size ) && i_file_size == i_size &&
+                ReadU64( p_file, &i_file_mtime ) && (int64_t) i_file_mtime == i_mtime &&
+                ReadU32( p_file, &i_programs );
+
+    ts_index_Clear( p_index );
+    for( uint32_t i = 0; b_ok && i < i_programs; i++ )
+        b_ok = ReadProgram( p_file, p_index );
+
+    fclose( p_file );
+
+    if( !b_ok )
+    {
+        ts_index_Clear( p_index );
+        return VLC_EGENERIC;
+    }
+    p_index->b_modified = false;
+    return VLC_SUCCESS;
+}
+
+int ts_index_Save( const ts_index_t *p_index, const char *psz_path,
+                   uint64_t i_size, int64_t i_mtime )
+{
+    if( !p_index->b_modified )
+        return VLC_SUCCESS;
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.part", psz_path ) == -1 )
+        return VLC_ENOMEM;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( !p_file )
+    {
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+
+    bool b_ok = fwrite( TS_INDEX_MAGIC, 8, 1, p_file ) == 1 &&
+                WriteU32( p_file, TS_INDEX_VERSION ) &&
+                WriteU64( p_file, i_size ) &&
+                WriteU64( p_file, i_mtime ) &&
+                WriteU32( p_file, p_index->i_programs );
+
+    for( size_t i = 0; b_ok && i < p_index->i_programs; i++ )
+    {
+        const ts_index_program_t *p_prog = &p_index->p_programs[i];
+
+        b_ok = WriteU32( p_file, p_prog->i_program ) &&
+               WriteU64( p_file, p_prog->i_first ) &&
+               WriteU32( p_file, p_prog->i_count );
+
+        for( size_t j = 0; b_ok && j < p_prog->i_count; j++ )
+            b_ok = WriteU64( p_file, p_prog->p_points[j].i_time ) &&
+                   WriteU64( p_file, p_prog->p_points[j].i_offset );
+    }
+
+    if( fclose( p_file ) )
+        b_ok = false;
+
+    /* Replace atomically, so that readers never see a partial index */
+    if( !b_ok || vlc_rename( psz_tmp, psz_path ) )
+    {
+        vlc_unlink( psz_tmp );
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+    free( psz_tmp );
+    return VLC_SUCCESS;
+}
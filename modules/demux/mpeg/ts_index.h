@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * ts_index.h: Transport Stream time to offset index
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_INDEX_H
+#define VLC_TS_INDEX_H
+
+#include "timestamps.h"
+
+/* Minimum time between two index points */
+#define TS_INDEX_INTERVAL TO_SCALE_NZ(VLC_TICK_FROM_MS(500))
+
+typedef struct ts_index_t ts_index_t;
+
+ts_index_t * ts_index_New( void );
+void ts_index_Delete( ts_index_t * );
+
+/**
+ * Records the position of a packet carrying a program clock reference.
+ * Times are wrap-around adjusted with TimeStampWrapAround() from the
+ * program first PCR. The points of a program are discarded if its first
+ * PCR changes.
+ */
+void ts_index_Add( ts_index_t *, int i_program, stime_t i_first,
+                   stime_t i_time, uint64_t i_offset );
+
+/**
+ * Finds the last indexed point not after a given time, and the offset of
+ * the next one (or UINT64_MAX).
+ */
+int ts_index_Lookup( const ts_index_t *, int i_program, stime_t i_first,
+                     stime_t i_time, stime_t *pi_before_time,
+                     uint64_t *pi_before, uint64_t *pi_after );
+
+/**
+ * Loads or saves the index from/to a file. Loading fails if the indexed
+ * file size or modification time have changed.
+ */
+int ts_index_Load( ts_index_t *, const char *psz_path,
+                   uint64_t i_size, int64_t i_mtime );
+int ts_index_Save( const ts_index_t *, const char *psz_path,
+                   uint64_t i_size, int64_t i_mtime );
+
+#endif
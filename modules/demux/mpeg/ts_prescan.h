@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * ts_prescan.h: Transport Stream packets headers bulk scanning
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_PRESCAN_H
+#define VLC_TS_PRESCAN_H
+
+#define TS_PRESCAN_MAX 64
+
+/* Header flags, as extracted by ts_prescan() */
+#define TS_PRESCAN_TEI        0x80 /* transport_error_indicator */
+#define TS_PRESCAN_PUSI       0x40 /* payload_unit_start_indicator */
+#define TS_PRESCAN_SCRAMBLED  0x0C /* transport_scrambling_control */
+#define TS_PRESCAN_ADAPTATION 0x02
+#define TS_PRESCAN_PAYLOAD    0x01
+
+typedef struct
+{
+    unsigned i_count; /* packets scanned */
+    unsigned i_index; /* next packet to be read */
+    uint16_t pid[TS_PRESCAN_MAX];
+    uint8_t  flags[TS_PRESCAN_MAX];
+} ts_prescan_t;
+
+/**
+ * Extracts PIDs and header flags of all complete packets of a buffer.
+ *
+ * The headers are loaded with a single 32-bits read each and decoded without
+ * branches, so that the compiler can vectorize the loop. The sync bytes are
+ * only checked individually if any of them is wrong.
+ *
+ * @param p_buf start of the first packet, including its extra header
+ * @param i_buf buffer size
+ * @param i_stride packet size, including the extra header
+ * @param i_offset extra header size (BluRay) before each sync byte
+ * @return the number of leading packets with a valid sync byte
+ */
+static inline unsigned ts_prescan( ts_prescan_t *p_scan, const uint8_t *p_buf,
+                                   size_t i_buf, unsigned i_stride,
+                                   unsigned i_offset )
+{
+    unsigned i_count = i_buf / i_stride;
+    if( i_count > TS_PRESCAN_MAX )
+        i_count = TS_PRESCAN_MAX;
+
+    const uint8_t *p = p_buf + i_offset;
+    uint32_t i_mismatch = 0;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        uint32_t i_header = GetDWBE( &p[i * i_stride] );
+
+        i_mismatch |= (i_header >> 24) ^ 0x47;
+        p_scan->pid[i] = (i_header >> 8) & 0x1FFF;
+        p_scan->flags[i] = ((i_header >> 16) & 0xC0) | ((i_header >> 4) & 0x0F);
+    }
+
+    if( unlikely(i_mismatch) )
+    {
+        for( unsigned i = 0; i < i_count; i++ )
+        {
+            if( p[i * i_stride] != 0x47 )
+            {
+                i_count = i;
+                break;
+            }
+        }
+    }
+
+    p_scan->i_count = i_count;
+    p_scan->i_index = 0;
+    return i_count;
+}
+
+#endif
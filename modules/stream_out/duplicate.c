@@ -235,6 +235,9 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
             {
                 msg_Dbg( p_stream, "    - added for output %d", i_stream );
                 i_valid_streams++;
+                /* The outputs receive the same blocks for this ES */
+                sout_StreamControl( out, SOUT_STREAM_ID_DECODER_GROUP,
+                                    id_new, (const void *)id );
             }
             else
             {
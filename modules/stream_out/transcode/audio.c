@@ -225,7 +225,7 @@ int transcode_audio_process( sout_stream_t *p_stream,
 {
     *out = NULL;
 
-    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    int ret = transcode_decoder_decode( id, in );
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
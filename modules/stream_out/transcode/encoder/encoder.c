@@ -166,6 +166,12 @@ block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
     return p_data;
 }
 
+void transcode_encoder_get_stats( const transcode_encoder_t *p_enc,
+                                  transcode_stage_stats_t *p_stats )
+{
+    *p_stats = p_enc->stats;
+}
+
 void transcode_encoder_close( transcode_encoder_t *p_enc )
 {
     if( !p_enc->p_encoder->p_module )
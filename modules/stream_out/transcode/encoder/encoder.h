@@ -23,6 +23,14 @@
 
 typedef struct transcode_encoder_t transcode_encoder_t;
 
+/* Timings of a stage of the video transcoding pipeline */
+typedef struct
+{
+    unsigned    i_pictures; /* pictures that went through the stage */
+    vlc_tick_t  i_busy;     /* time spent processing them */
+    vlc_tick_t  i_waiting;  /* time the previous stage waited for room */
+} transcode_stage_stats_t;
+
 typedef struct
 {
     vlc_fourcc_t i_codec; /* (0 if not transcode) */
@@ -71,6 +79,8 @@ void transcode_encoder_update_format_out( transcode_encoder_t *, const es_format
 block_t * transcode_encoder_encode( transcode_encoder_t *, void * );
 block_t * transcode_encoder_get_output_async( transcode_encoder_t * );
 void transcode_encoder_delete( transcode_encoder_t * );
+void transcode_encoder_get_stats( const transcode_encoder_t *,
+                                  transcode_stage_stats_t * );
 transcode_encoder_t * transcode_encoder_new( encoder_t *, const es_format_t * );
 void transcode_encoder_close( transcode_encoder_t * );
 
@@ -31,6 +31,9 @@ struct transcode_encoder_t
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* video encoding timings, valid once drained */
+    transcode_stage_stats_t stats;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
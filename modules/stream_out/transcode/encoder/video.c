@@ -370,7 +370,10 @@ static void* EncoderThread( void *obj )
         {
             /* release lock while encoding */
             vlc_mutex_unlock( &p_enc->lock_out );
+            vlc_tick_t i_start = vlc_tick_now();
             p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+            p_enc->stats.i_busy += vlc_tick_now() - i_start;
+            p_enc->stats.i_pictures++;
             picture_Release( p_pic );
             vlc_mutex_lock( &p_enc->lock_out );
 
@@ -482,12 +485,22 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic )
 {
+    vlc_tick_t i_start = vlc_tick_now();
+
     if( !p_enc->b_threaded )
     {
-        return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        block_t *p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        if( p_pic )
+        {
+            p_enc->stats.i_busy += vlc_tick_now() - i_start;
+            p_enc->stats.i_pictures++;
+        }
+        return p_block;
     }
 
+    /* the encoder thread writes the other counters */
     vlc_sem_wait( &p_enc->picture_pool_has_room );
+    p_enc->stats.i_waiting += vlc_tick_now() - i_start;
     vlc_mutex_lock( &p_enc->lock_out );
     picture_Hold( p_pic );
     picture_fifo_Push( p_enc->pp_pics, p_pic );
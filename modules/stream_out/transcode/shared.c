@@ -0,0 +1,434 @@
+/*****************************************************************************
+ * shared.c: decoders shared by the transcoders of duplicated streams
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The duplicate stream output sends the same blocks of an elementary stream
+ * to each of its branches, and tells them that these streams belong to the
+ * same group with SOUT_STREAM_ID_DECODER_GROUP. The transcoders of a group
+ * that would open the same decoder use a single shared one instead.
+ *
+ * Each transcoder counts the blocks it sends. The first one to send a given
+ * block decodes it; the others drop their copy of it. The decoded pictures
+ * or audio buffers stay queued, tagged with the number of the block they
+ * come from, until every transcoder took its own reference: a clone sharing
+ * the planes for pictures, a copy for audio buffers, as the audio filters
+ * work in place. A drain is a block like any other.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_list.h>
+#include <vlc_modules.h>
+#include <vlc_sout.h>
+
+#include "transcode.h"
+
+struct transcode_shared_output
+{
+    struct transcode_shared_output *p_next;
+    uint64_t        i_seq;   /* output number */
+    uint64_t        i_block; /* number of the block it was decoded from */
+    unsigned        i_refs;  /* transcoders yet to take it */
+    union
+    {
+        picture_t  *p_pic;
+        block_t    *p_audio;
+    };
+};
+
+struct transcode_shared_decoder
+{
+    decoder_t       dec;
+    struct vlc_list node;
+    const void     *group;
+    char           *psz_codec;
+    vlc_decoder_device *dec_dev;
+
+    /* Decoding, transcoders and outputs. The owner callbacks run from
+     * pf_decode, with this lock held. */
+    vlc_mutex_t     lock;
+    struct vlc_list consumers;
+    unsigned        i_consumers;
+    uint64_t        i_decoded; /* blocks decoded */
+    uint64_t        i_outputs; /* outputs queued */
+    bool            b_error;
+    struct transcode_shared_output *p_first, **pp_last;
+};
+
+static vlc_mutex_t registry_lock = VLC_STATIC_MUTEX;
+static struct vlc_list registry = VLC_LIST_INITIALIZER(&registry);
+
+static inline struct transcode_shared_decoder *
+shared_get( decoder_t *p_dec )
+{
+    return container_of( p_dec, struct transcode_shared_decoder, dec );
+}
+
+static void shared_queue( struct transcode_shared_decoder *p_shared,
+                          void *p_data )
+{
+    struct transcode_shared_output *p_out = malloc( sizeof(*p_out) );
+    if( unlikely(p_out == NULL) )
+    {
+        if( p_shared->dec.fmt_in.i_cat == VIDEO_ES )
+            picture_Release( p_data );
+        else
+            block_Release( p_data );
+        return;
+    }
+
+    p_out->p_next = NULL;
+    p_out->i_seq = p_shared->i_outputs++;
+    p_out->i_block = p_shared->i_decoded + 1; /* being decoded */
+    p_out->i_refs = p_shared->i_consumers;
+    if( p_shared->dec.fmt_in.i_cat == VIDEO_ES )
+        p_out->p_pic = p_data;
+    else
+        p_out->p_audio = p_data;
+
+    *p_shared->pp_last = p_out;
+    p_shared->pp_last = &p_out->p_next;
+}
+
+static void shared_release_output( struct transcode_shared_decoder *p_shared,
+                                   struct transcode_shared_output **pp_out )
+{
+    struct transcode_shared_output *p_out = *pp_out;
+
+    *pp_out = p_out->p_next;
+    if( p_shared->pp_last == &p_out->p_next )
+        p_shared->pp_last = pp_out;
+
+    if( p_shared->dec.fmt_in.i_cat == VIDEO_ES )
+        picture_Release( p_out->p_pic );
+    else
+        block_Release( p_out->p_audio );
+    free( p_out );
+}
+
+static vlc_decoder_device *shared_video_get_device( decoder_t *p_dec )
+{
+    struct transcode_shared_decoder *p_shared = shared_get( p_dec );
+    if( p_shared->dec_dev == NULL )
+        p_shared->dec_dev = vlc_decoder_device_Create( &p_dec->obj, NULL );
+    return p_shared->dec_dev ? vlc_decoder_device_Hold( p_shared->dec_dev )
+                             : NULL;
+}
+
+static int shared_video_format_update( decoder_t *p_dec,
+                                       vlc_video_context *vctx )
+{
+    struct transcode_shared_decoder *p_shared = shared_get( p_dec );
+    sout_stream_id_sys_t *id;
+    int ret = 0;
+
+    /* Every transcoder must be able to convert the new format */
+    vlc_list_foreach( id, &p_shared->consumers, shared.node )
+    {
+        struct decoder_owner *p_owner = dec_get_owner( id->p_decoder );
+        if( transcode_video_update_format( p_owner->p_obj, id, p_dec,
+                                           vctx ) != 0 )
+            ret = -1;
+    }
+    return ret;
+}
+
+static void shared_video_queue( decoder_t *p_dec, picture_t *p_pic )
+{
+    shared_queue( shared_get( p_dec ), p_pic );
+}
+
+static int shared_audio_format_update( decoder_t *p_dec )
+{
+    struct transcode_shared_decoder *p_shared = shared_get( p_dec );
+    sout_stream_id_sys_t *id;
+
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+    aout_FormatPrepare( &p_dec->fmt_out.audio );
+
+    if( !AOUT_FMT_LINEAR(&p_dec->fmt_out.audio) )
+        return VLC_EGENERIC;
+
+    vlc_list_foreach( id, &p_shared->consumers, shared.node )
+    {
+        vlc_mutex_lock( &id->fifo.lock );
+        es_format_Clean( &id->decoder_out );
+        es_format_Copy( &id->decoder_out, &p_dec->fmt_out );
+        vlc_mutex_unlock( &id->fifo.lock );
+    }
+    return VLC_SUCCESS;
+}
+
+static void shared_audio_queue( decoder_t *p_dec, block_t *p_audio )
+{
+    shared_queue( shared_get( p_dec ), p_audio );
+}
+
+static bool shared_matches( const struct transcode_shared_decoder *p_shared,
+                            const void *group, const es_format_t *p_fmt,
+                            const char *psz_codec )
+{
+    const es_format_t *p_ref = &p_shared->dec.fmt_in;
+
+    return p_shared->group == group &&
+           p_ref->i_cat == p_fmt->i_cat &&
+           p_ref->i_codec == p_fmt->i_codec &&
+           p_ref->i_original_fourcc == p_fmt->i_original_fourcc &&
+           p_ref->i_extra == p_fmt->i_extra &&
+           (p_fmt->i_extra == 0 ||
+            memcmp( p_ref->p_extra, p_fmt->p_extra, p_fmt->i_extra ) == 0) &&
+           es_format_IsSimilar( p_ref, p_fmt ) &&
+           strcmp( p_shared->psz_codec ? p_shared->psz_codec : "",
+                   psz_codec ? psz_codec : "" ) == 0;
+}
+
+static struct transcode_shared_decoder *
+shared_new( sout_stream_t *p_stream, const void *group,
+            const es_format_t *p_fmt, char *psz_codec )
+{
+    struct transcode_shared_decoder *p_shared =
+        vlc_object_create( p_stream->p_sout, sizeof(*p_shared) );
+    if( !p_shared )
+        return NULL;
+
+    decoder_Init( &p_shared->dec, p_fmt );
+    p_shared->group = group;
+    p_shared->psz_codec = psz_codec;
+    p_shared->dec_dev = NULL;
+    vlc_list_init( &p_shared->consumers );
+    p_shared->i_consumers = 0;
+    vlc_mutex_init( &p_shared->lock );
+    p_shared->i_decoded = 0;
+    p_shared->i_outputs = 0;
+    p_shared->b_error = false;
+    p_shared->p_first = NULL;
+    p_shared->pp_last = &p_shared->p_first;
+
+    static const struct decoder_owner_callbacks video_cbs =
+    {
+        .video = {
+            .get_device = shared_video_get_device,
+            .format_update = shared_video_format_update,
+            .queue = shared_video_queue,
+        },
+    };
+    static const struct decoder_owner_callbacks audio_cbs =
+    {
+        .audio = {
+            .format_update = shared_audio_format_update,
+            .queue = shared_audio_queue,
+        },
+    };
+
+    if( p_fmt->i_cat == VIDEO_ES )
+    {
+        p_shared->dec.cbs = &video_cbs;
+        p_shared->dec.p_module =
+            module_need_var( &p_shared->dec, "video decoder", "codec" );
+    }
+    else
+    {
+        p_shared->dec.cbs = &audio_cbs;
+        p_shared->dec.p_module =
+            module_need_var( &p_shared->dec, "audio decoder", "codec" );
+    }
+
+    if( !p_shared->dec.p_module )
+    {
+        msg_Err( p_stream, "cannot open the shared decoder" );
+        decoder_Destroy( &p_shared->dec );
+        free( psz_codec );
+        return NULL;
+    }
+
+    msg_Dbg( p_stream, "sharing the %4.4s decoder of ES %d",
+             (const char *)&p_fmt->i_codec, p_fmt->i_id );
+    return p_shared;
+}
+
+static void shared_delete( struct transcode_shared_decoder *p_shared )
+{
+    while( p_shared->p_first )
+        shared_release_output( p_shared, &p_shared->p_first );
+    decoder_Clean( &p_shared->dec );
+    if( p_shared->dec_dev )
+        vlc_decoder_device_Release( p_shared->dec_dev );
+    free( p_shared->psz_codec );
+    vlc_object_delete( &p_shared->dec );
+}
+
+int transcode_shared_attach( sout_stream_t *p_stream,
+                             sout_stream_id_sys_t *id, const void *group )
+{
+    const es_format_t *p_fmt = &id->p_decoder->fmt_in;
+    struct transcode_shared_decoder *p_shared = NULL, *p_cur;
+
+    if( id->shared.p_decoder != NULL ||
+        (p_fmt->i_cat != VIDEO_ES && p_fmt->i_cat != AUDIO_ES) )
+        return VLC_EGENERIC;
+
+    char *psz_codec = var_InheritString( p_stream, "codec" );
+
+    vlc_mutex_lock( &registry_lock );
+    vlc_list_foreach( p_cur, &registry, node )
+        if( shared_matches( p_cur, group, p_fmt, psz_codec ) )
+        {
+            p_shared = p_cur;
+            break;
+        }
+
+    if( p_shared == NULL )
+    {
+        p_shared = shared_new( p_stream, group, p_fmt, psz_codec );
+        if( p_shared == NULL )
+        {
+            vlc_mutex_unlock( &registry_lock );
+            return VLC_EGENERIC;
+        }
+        vlc_list_append( &p_shared->node, &registry );
+    }
+    else
+        free( psz_codec );
+
+    vlc_mutex_lock( &p_shared->lock );
+    id->shared.i_blocks = p_shared->i_decoded;
+    id->shared.i_next = p_shared->i_outputs;
+    p_shared->i_consumers++;
+    vlc_list_append( &id->shared.node, &p_shared->consumers );
+    vlc_mutex_unlock( &p_shared->lock );
+    id->shared.p_decoder = p_shared;
+    vlc_mutex_unlock( &registry_lock );
+
+    /* The own decoder of the transcoder is not used anymore */
+    module_unneed( id->p_decoder, id->p_decoder->p_module );
+    id->p_decoder->p_module = NULL;
+    return VLC_SUCCESS;
+}
+
+void transcode_shared_detach( sout_stream_id_sys_t *id )
+{
+    struct transcode_shared_decoder *p_shared = id->shared.p_decoder;
+    if( p_shared == NULL )
+        return;
+
+    vlc_mutex_lock( &registry_lock );
+    id->shared.p_decoder = NULL;
+
+    vlc_mutex_lock( &p_shared->lock );
+    vlc_list_remove( &id->shared.node );
+    p_shared->i_consumers--;
+    /* Drop the references to the outputs this transcoder did not take */
+    for( struct transcode_shared_output **pp = &p_shared->p_first; *pp; )
+    {
+        if( (*pp)->i_seq >= id->shared.i_next && --(*pp)->i_refs == 0 )
+            shared_release_output( p_shared, pp );
+        else
+            pp = &(*pp)->p_next;
+    }
+    vlc_mutex_unlock( &p_shared->lock );
+
+    bool b_last = p_shared->i_consumers == 0;
+    if( b_last )
+        vlc_list_remove( &p_shared->node );
+    vlc_mutex_unlock( &registry_lock );
+
+    if( b_last )
+        shared_delete( p_shared );
+}
+
+static void shared_deliver( sout_stream_id_sys_t *id, void *p_data )
+{
+    vlc_mutex_lock( &id->fifo.lock );
+    if( id->p_decoder->fmt_in.i_cat == VIDEO_ES )
+    {
+        picture_t *p_pic = p_data;
+        *id->fifo.pic.last = p_pic;
+        id->fifo.pic.last = &p_pic->p_next;
+    }
+    else
+    {
+        block_t *p_audio = p_data;
+        *id->fifo.audio.last = p_audio;
+        id->fifo.audio.last = &p_audio->p_next;
+    }
+    vlc_mutex_unlock( &id->fifo.lock );
+}
+
+int transcode_decoder_decode( sout_stream_id_sys_t *id, block_t *in )
+{
+    struct transcode_shared_decoder *p_shared = id->shared.p_decoder;
+    if( p_shared == NULL )
+        return id->p_decoder->pf_decode( id->p_decoder, in );
+
+    vlc_mutex_lock( &p_shared->lock );
+
+    if( id->shared.i_blocks++ == p_shared->i_decoded )
+    {
+        /* First transcoder to send this block: decode it for all */
+        if( !p_shared->b_error &&
+            p_shared->dec.pf_decode( &p_shared->dec, in ) != VLCDEC_SUCCESS )
+            p_shared->b_error = true;
+        else if( p_shared->b_error && in != NULL )
+            block_Release( in );
+        p_shared->i_decoded++;
+    }
+    else if( in != NULL )
+        block_Release( in );
+
+    /* Take the outputs of the blocks sent so far */
+    for( struct transcode_shared_output **pp = &p_shared->p_first; *pp; )
+    {
+        struct transcode_shared_output *p_out = *pp;
+        if( p_out->i_block > id->shared.i_blocks )
+            break;
+        if( p_out->i_seq < id->shared.i_next )
+        {
+            pp = &p_out->p_next;
+            continue;
+        }
+        id->shared.i_next = p_out->i_seq + 1;
+
+        void *p_data;
+        if( p_shared->dec.fmt_in.i_cat == VIDEO_ES )
+        {
+            /* Filters may change the date and flags of their input */
+            p_data = picture_Clone( p_out->p_pic );
+            if( p_data )
+                picture_CopyProperties( p_data, p_out->p_pic );
+        }
+        else
+            p_data = block_Duplicate( p_out->p_audio );
+        if( p_data )
+            shared_deliver( id, p_data );
+
+        if( --p_out->i_refs == 0 )
+            shared_release_output( p_shared, pp );
+        else
+            pp = &p_out->p_next;
+    }
+
+    int ret = p_shared->b_error ? VLCDEC_ECRITICAL : VLCDEC_SUCCESS;
+    vlc_mutex_unlock( &p_shared->lock );
+    return ret;
+}
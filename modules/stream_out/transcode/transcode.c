@@ -79,6 +79,18 @@
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
     "are applied). You can enter a colon-separated list of filters." )
+#define RENDITIONS_TEXT N_("Additional video renditions")
+#define RENDITIONS_LONGTEXT N_( \
+    "Comma-separated list of additional video renditions, as " \
+    "WIDTHxHEIGHT or WIDTHxHEIGHT:BITRATE (in kb/s). The video is decoded " \
+    "and deinterlaced once, then scaled and encoded once per rendition " \
+    "with the video encoder. Each rendition is an elementary stream of its " \
+    "own, with the ES ID of the source plus 1000 times its rank." )
+#define VFILTER_THREADS_TEXT N_("Video filter threads")
+#define VFILTER_THREADS_LONGTEXT N_( \
+    "Runs the video filters in a pipeline, with each group of consecutive " \
+    "filters on its own thread, up to this number of threads. " \
+    "0 or 1 runs all filters on the transcoding thread." )
 
 #define AENC_TEXT N_("Audio encoder")
 #define AENC_LONGTEXT N_( \
@@ -129,6 +141,12 @@
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
+#define DECODE_QUEUE_TEXT N_("Decoded pictures queue size")
+#define DECODE_QUEUE_LONGTEXT N_( \
+    "Runs the video filters and the encoder input on their own thread, " \
+    "so that decoding overlaps with filtering, with up to this number of " \
+    "decoded pictures waiting. The decoder, and then the demuxer, wait " \
+    "when the queue is full. 0 filters on the transcoding thread." )
 
 
 static const char *const ppsz_deinterlace_type[] =
@@ -175,8 +193,13 @@ vlc_module_begin ()
                  MAXWIDTH_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "maxheight", 0, MAXHEIGHT_TEXT,
                  MAXHEIGHT_LONGTEXT, true )
+    add_string( SOUT_CFG_PREFIX "renditions", NULL, RENDITIONS_TEXT,
+                RENDITIONS_LONGTEXT, true )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_integer( SOUT_CFG_PREFIX "vfilter-threads", 0, VFILTER_THREADS_TEXT,
+                 VFILTER_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 16 )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "encoder", NULL,
@@ -213,6 +236,9 @@ vlc_module_begin ()
         change_integer_range( 0, 32 )
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT, true )
         change_integer_range( 1, 1000 )
+    add_integer( SOUT_CFG_PREFIX "decode-queue", 0, DECODE_QUEUE_TEXT,
+                 DECODE_QUEUE_LONGTEXT, true )
+        change_integer_range( 0, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT,
               true )
 
@@ -224,7 +250,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "vfilter-threads", "decode-queue", "renditions", NULL
 };
 
 /*****************************************************************************
@@ -332,6 +358,51 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+/* Parses the additional renditions. They share the encoder name, codec and
+ * options of the video encoder configuration, and only own the array. */
+static void SetVideoRenditionsConfig( sout_stream_t *p_stream,
+                                      sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream,
+                                              SOUT_CFG_PREFIX "renditions" );
+    if( !psz_string )
+        return;
+
+    char *psz_save;
+    for( const char *psz = strtok_r( psz_string, ",", &psz_save );
+         psz != NULL; psz = strtok_r( NULL, ",", &psz_save ) )
+    {
+        unsigned i_width, i_height, i_bitrate = 0;
+        if( sscanf( psz, "%ux%u:%u", &i_width, &i_height, &i_bitrate ) < 2 ||
+            i_width < 2 || i_height < 2 )
+        {
+            msg_Warn( p_stream, "ignoring invalid rendition \"%s\"", psz );
+            continue;
+        }
+
+        transcode_encoder_config_t *p_cfgs =
+            realloc( p_sys->p_vrenditions,
+                     (p_sys->i_vrenditions + 1) * sizeof(*p_cfgs) );
+        if( unlikely(p_cfgs == NULL) )
+            break;
+        p_sys->p_vrenditions = p_cfgs;
+
+        transcode_encoder_config_t *p_cfg = &p_cfgs[p_sys->i_vrenditions++];
+        *p_cfg = p_sys->venc_cfg;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.f_scale = 0.f;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        if( i_bitrate > 0 )
+            p_cfg->video.i_bitrate = i_bitrate * 1000;
+
+        msg_Dbg( p_stream, "video rendition %zu: %ux%u %ukb/s",
+                 p_sys->i_vrenditions, i_width, i_height,
+                 p_cfg->video.i_bitrate / 1000 );
+    }
+    free( psz_string );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -374,6 +445,22 @@ static int Control( sout_stream_t *p_stream, int i_query, va_list args )
                                            id->downstream_id, spu_hl );
             break;
         }
+
+        case SOUT_STREAM_ID_DECODER_GROUP:
+        {
+            sout_stream_id_sys_t *id = (sout_stream_id_sys_t *) va_arg(args, void *);
+            const void *group = va_arg(args, const void *);
+            if( id->b_transcode )
+            {
+                int i_cat = id->p_decoder->fmt_in.i_cat;
+                if( i_cat == AUDIO_ES || i_cat == VIDEO_ES )
+                    return transcode_shared_attach( p_stream, id, group );
+            }
+            else if( id->downstream_id )
+                return sout_StreamControl( p_stream->p_next, i_query,
+                                           id->downstream_id, group );
+            break;
+        }
     }
     return VLC_EGENERIC;
 }
@@ -418,6 +505,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoRenditionsConfig( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -429,6 +517,11 @@ static int Open( vlc_object_t *p_this )
     else
         free( psz_string );
 
+    p_sys->vfilters_cfg.video.i_pipeline_threads =
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "vfilter-threads" );
+    p_sys->vfilters_cfg.video.i_decode_queue =
+        var_GetInteger( p_stream, SOUT_CFG_PREFIX "decode-queue" );
+
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "deinterlace" ) )
     {
         psz_string = var_GetString( p_stream,
@@ -480,6 +573,7 @@ static void Close( vlc_object_t * p_this )
     sout_stream_t       *p_stream = (sout_stream_t*)p_this;
     sout_stream_sys_t   *p_sys = p_stream->p_sys;
 
+    free( p_sys->p_vrenditions );
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
 
@@ -679,6 +773,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
         {
         case AUDIO_ES:
             Send( p_stream, id, NULL );
+            transcode_shared_detach( id );
             decoder_Destroy( id->p_decoder );
             vlc_mutex_lock( &p_sys->lock );
             if( id == p_sys->id_master_sync )
@@ -688,12 +783,13 @@ static void Del( sout_stream_t *p_stream, void *_id )
             break;
         case VIDEO_ES:
             Send( p_stream, id, NULL );
+            transcode_shared_detach( id );
             decoder_Destroy( id->p_decoder );
             vlc_mutex_lock( &p_sys->lock );
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
@@ -716,7 +812,11 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     block_t *p_out = NULL;
 
     if( id->b_error )
+    {
+        /* Do not hold the outputs of a shared decoder anymore */
+        transcode_shared_detach( id );
         goto error;
+    }
 
     if( !id->b_transcode )
     {
@@ -1,4 +1,5 @@
 #include <vlc_picture_fifo.h>
+#include <vlc_list.h>
 #include <vlc_filter.h>
 #include <vlc_codec.h>
 #include "encoder/encoder.h"
@@ -17,6 +18,8 @@ typedef struct
             config_chain_t  *p_deinterlace_cfg;
             char            *psz_spu_sources;
             bool             b_reorient;
+            unsigned         i_pipeline_threads;
+            unsigned         i_decode_queue;
         } video;
     };
 } sout_filters_config_t;
@@ -52,6 +55,8 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    transcode_encoder_config_t *p_vrenditions; /* shallow copies of venc_cfg */
+    size_t          i_vrenditions;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -67,6 +72,9 @@ typedef struct
 } sout_stream_sys_t;
 
 struct aout_filters;
+struct transcode_video_worker;
+struct transcode_rendition;
+struct transcode_shared_decoder;
 
 struct sout_stream_id_sys_t
 {
@@ -82,6 +90,15 @@ struct sout_stream_id_sys_t
     /* Decoder */
     decoder_t       *p_decoder;
 
+    /* Decoder shared with the other streams of a duplicate group */
+    struct
+    {
+        struct transcode_shared_decoder *p_decoder;
+        uint64_t        i_blocks; /* blocks sent */
+        uint64_t        i_next;   /* next output to take */
+        struct vlc_list node;
+    } shared;
+
     struct
     {
         vlc_mutex_t lock;
@@ -130,6 +147,11 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             struct transcode_video_worker *p_worker;
+             struct transcode_rendition *p_renditions;
+             size_t          i_renditions;
+             transcode_stage_stats_t decode_stats;
+             transcode_stage_stats_t filter_stats;
          };
          struct
          {
@@ -190,6 +212,13 @@ static inline void transcode_remove_filters( filter_chain_t **pp )
     }
 }
 
+/* Shared decoders */
+
+int  transcode_shared_attach( sout_stream_t *, sout_stream_id_sys_t *,
+                              const void *group );
+void transcode_shared_detach( sout_stream_id_sys_t * );
+int  transcode_decoder_decode( sout_stream_id_sys_t *, block_t * );
+
 /* SPU */
 
 void transcode_spu_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
@@ -207,9 +236,11 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
+int  transcode_video_update_format( vlc_object_t *, sout_stream_id_sys_t *,
+                                    decoder_t *, vlc_video_context * );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
                                            unsigned *w, unsigned *h );
 void transcode_video_push_spu( sout_stream_t *, sout_stream_id_sys_t *, subpicture_t * );
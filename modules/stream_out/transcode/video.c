@@ -46,6 +46,36 @@ struct encoder_owner
     sout_stream_id_sys_t *id;
 };
 
+/* Runs the filters and feeds the encoder while the stream output thread
+ * decodes the next pictures */
+struct transcode_video_worker
+{
+    vlc_thread_t    thread;
+    vlc_mutex_t     lock;
+    vlc_cond_t      wait_pic;
+    vlc_cond_t      wait_idle;
+    vlc_sem_t       has_room;
+    picture_fifo_t *pics;
+    block_t        *p_out; /* from an encoder without thread */
+    bool            b_busy;
+    bool            b_closing;
+};
+
+/* Additional rendition, encoded from the pictures out of the deinterlace
+ * and frame rate filters of the main one */
+struct transcode_rendition
+{
+    const transcode_encoder_config_t *p_cfg;
+    transcode_encoder_t *encoder;
+    filter_chain_t  *p_conv; /* NULL if the encoder takes the pictures as is */
+    void            *downstream_id;
+    block_t         *p_out; /* protected by fifo.lock */
+    bool             b_error;
+};
+
+static int transcode_video_worker_new( sout_stream_id_sys_t *, unsigned, int );
+static void transcode_video_worker_delete( struct transcode_video_worker * );
+
 static vlc_decoder_device *TranscodeHoldDecoderDevice(vlc_object_t *o, sout_stream_id_sys_t *id)
 {
     if (id->dec_dev == NULL)
@@ -93,11 +123,10 @@ static vlc_decoder_device * transcode_video_filter_hold_device(vlc_object_t *o,
     return TranscodeHoldDecoderDevice(o, id);
 }
 
-static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vctx )
+int transcode_video_update_format( vlc_object_t *p_obj,
+                                   sout_stream_id_sys_t *id,
+                                   decoder_t *p_dec, vlc_video_context *vctx )
 {
-    struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    sout_stream_id_sys_t *id = p_owner->id;
-    vlc_object_t        *p_obj = p_owner->p_obj;
     filter_chain_t       *test_chain;
 
     vlc_mutex_lock( &id->fifo.lock );
@@ -134,6 +163,13 @@ static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vct
     return chain_works;
 }
 
+static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vctx )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    return transcode_video_update_format( p_owner->p_obj, p_owner->id,
+                                          p_dec, vctx );
+}
+
 static picture_t *video_new_buffer_encoder( transcode_encoder_t *p_enc )
 {
     return picture_NewFromFormat( &transcode_encoder_format_in( p_enc )->video );
@@ -168,6 +204,54 @@ static picture_t *transcode_dequeue_all_pics( sout_stream_id_sys_t *id )
     return p_pics;
 }
 
+/* Creates an encoder and tests that it is available; it is only opened once
+ * the first picture is decoded. */
+static transcode_encoder_t *transcode_video_encoder_new( sout_stream_t *p_stream,
+                                                         sout_stream_id_sys_t *id,
+                                                         const transcode_encoder_config_t *p_cfg )
+{
+    /* Should be the same format until encoder loads */
+    es_format_t encoder_tested_fmt_in;
+    es_format_Init( &encoder_tested_fmt_in, VIDEO_ES, 0 );
+
+    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+        return NULL;
+    p_enc_owner->id = id;
+    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+    if( transcode_encoder_test( &p_enc_owner->enc,
+                                p_cfg,
+                                &id->p_decoder->fmt_in,
+                                id->p_decoder->fmt_out.i_codec,
+                                &encoder_tested_fmt_in ) )
+    {
+        es_format_Clean( &encoder_tested_fmt_in );
+        return NULL;
+    }
+
+    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+    if ( unlikely(p_enc_owner == NULL))
+    {
+        es_format_Clean( &encoder_tested_fmt_in );
+        return NULL;
+    }
+
+    transcode_encoder_t *p_enc = transcode_encoder_new( &p_enc_owner->enc,
+                                                        &encoder_tested_fmt_in );
+    if( p_enc )
+    {
+        p_enc_owner->id = id;
+        p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+        /* Will use this format as encoder input for now */
+        transcode_encoder_update_format_in( p_enc, &encoder_tested_fmt_in );
+    }
+
+    es_format_Clean( &encoder_tested_fmt_in );
+    return p_enc;
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -220,62 +304,42 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
      * once the first frame is decoded, we actually only test the availability
      * of the encoder here.
      */
-
-    /* Should be the same format until encoder loads */
-    es_format_t encoder_tested_fmt_in;
-    es_format_Init( &encoder_tested_fmt_in, id->decoder_out.i_cat, 0 );
-
-    struct encoder_owner *p_enc_owner = (struct encoder_owner*)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
-    {
-        module_unneed( id->p_decoder, id->p_decoder->p_module );
-        id->p_decoder->p_module = NULL;
-        es_format_Clean( &id->decoder_out );
-        es_format_Clean( &encoder_tested_fmt_in );
-        return VLC_EGENERIC;
-    }
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
-
-    if( transcode_encoder_test( &p_enc_owner->enc,
-                                id->p_enccfg,
-                                &id->p_decoder->fmt_in,
-                                id->p_decoder->fmt_out.i_codec,
-                                &encoder_tested_fmt_in ) )
+    id->encoder = transcode_video_encoder_new( p_stream, id, id->p_enccfg );
+    if( !id->encoder )
     {
         module_unneed( id->p_decoder, id->p_decoder->p_module );
         id->p_decoder->p_module = NULL;
         es_format_Clean( &id->decoder_out );
-        es_format_Clean( &encoder_tested_fmt_in );
         return VLC_EGENERIC;
     }
 
-    p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
-    if ( unlikely(p_enc_owner == NULL))
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+    if( p_sys->i_vrenditions > 0 )
     {
-        module_unneed( id->p_decoder, id->p_decoder->p_module );
-        id->p_decoder->p_module = NULL;
-        es_format_Clean( &encoder_tested_fmt_in );
-        es_format_Clean( &id->decoder_out );
-        return VLC_EGENERIC;
+        id->p_renditions = calloc( p_sys->i_vrenditions,
+                                   sizeof(*id->p_renditions) );
+        if( id->p_renditions )
+            id->i_renditions = p_sys->i_vrenditions;
     }
-
-    id->encoder = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
-    if( !id->encoder )
+    for( size_t i = 0; i < id->i_renditions; i++ )
     {
-        module_unneed( id->p_decoder, id->p_decoder->p_module );
-        id->p_decoder->p_module = NULL;
-        es_format_Clean( &encoder_tested_fmt_in );
-        es_format_Clean( &id->decoder_out );
-        return VLC_EGENERIC;
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+        p_rend->p_cfg = &p_sys->p_vrenditions[i];
+        p_rend->encoder = transcode_video_encoder_new( p_stream, id,
+                                                       p_rend->p_cfg );
+        if( !p_rend->encoder )
+        {
+            msg_Err( p_stream, "cannot create the encoder of video rendition %zu",
+                     i + 1 );
+            p_rend->b_error = true;
+        }
     }
-    p_enc_owner->id = id;
-    p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
-
-    /* Will use this format as encoder input for now */
-    transcode_encoder_update_format_in( id->encoder, &encoder_tested_fmt_in );
 
-    es_format_Clean( &encoder_tested_fmt_in );
+    if( id->p_filterscfg->video.i_decode_queue > 0 &&
+        transcode_video_worker_new( id, id->p_filterscfg->video.i_decode_queue,
+                                    id->p_enccfg->video.threads.i_priority ) )
+        msg_Warn( p_stream, "cannot start the video filter thread, "
+                            "filtering on the transcoding thread" );
 
     return VLC_SUCCESS;
 }
@@ -371,6 +435,7 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     if( !id->p_f_chain )
         return VLC_EGENERIC;
     filter_chain_Reset( id->p_f_chain, p_src, src_ctx, p_src );
+    filter_chain_SetPipeline( id->p_f_chain, p_cfg->video.i_pipeline_threads );
 
     /* Deinterlace */
     if( p_cfg->video.psz_deinterlace != NULL )
@@ -403,6 +468,8 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
         if(!id->p_uf_chain)
             return VLC_EGENERIC;
         filter_chain_Reset( id->p_uf_chain, p_src, src_ctx, p_dst );
+        filter_chain_SetPipeline( id->p_uf_chain,
+                                  p_cfg->video.i_pipeline_threads );
         filter_chain_AppendFromString( id->p_uf_chain, p_cfg->psz_filters );
         p_src = filter_chain_GetFmtOut( id->p_uf_chain );
         debug_format( p_stream, p_src );
@@ -421,8 +488,26 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
+    if( id->p_worker )
+        transcode_video_worker_delete( id->p_worker );
+
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+        if( p_rend->encoder )
+        {
+            transcode_encoder_close( p_rend->encoder );
+            transcode_encoder_delete( p_rend->encoder );
+        }
+        transcode_remove_filters( &p_rend->p_conv );
+        block_ChainRelease( p_rend->p_out );
+        if( p_rend->downstream_id )
+            sout_StreamIdDel( p_stream->p_next, p_rend->downstream_id );
+    }
+    free( id->p_renditions );
+
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
@@ -490,7 +575,11 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     /* Overlay subpicture */
     if( p_subpic )
     {
-        if( filter_chain_IsEmpty( id->p_f_chain ) )
+        /* Planes may be shared by the decoder, the other renditions, or
+         * the other branches of a shared decoder, even after filters that
+         * hand back their input picture. */
+        if( filter_chain_IsEmpty( id->p_f_chain ) || id->i_renditions > 0 ||
+            id->shared.p_decoder != NULL )
         {
             /* We can't modify the picture, we need to duplicate it,
                  * in this point the picture is already p_encoder->fmt.in format*/
@@ -525,6 +614,403 @@ static void tag_last_block_with_flag( block_t **out, int i_flag )
     }
 }
 
+/* Encodes a picture out of the deinterlace and frame rate filters with each
+ * additional rendition. The renditions without conversion share it. */
+static void transcode_video_renditions_send( sout_stream_id_sys_t *id,
+                                             picture_t *p_pic )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+        if( p_rend->b_error || !transcode_encoder_opened( p_rend->encoder ) )
+            continue;
+
+        picture_t *p_in = picture_Hold( p_pic );
+        if( p_rend->p_conv )
+            p_in = filter_chain_VideoFilter( p_rend->p_conv, p_in );
+        if( !p_in )
+            continue;
+
+        block_t *p_encoded = transcode_encoder_encode( p_rend->encoder, p_in );
+        picture_Release( p_in );
+        if( p_encoded )
+        {
+            vlc_mutex_lock( &id->fifo.lock );
+            block_ChainAppend( &p_rend->p_out, p_encoded );
+            vlc_mutex_unlock( &id->fifo.lock );
+        }
+    }
+}
+
+static void transcode_video_renditions_remove_filters( sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+        transcode_remove_filters( &id->p_renditions[i].p_conv );
+}
+
+/* Opens the missing encoders of the additional renditions, and converts the
+ * output of the deinterlace and frame rate filters to their input format */
+static void transcode_video_renditions_setup( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id,
+                                              picture_t *p_pic )
+{
+    filter_owner_t owner = {
+        .video = &transcode_filter_video_cbs,
+        .sys = id,
+    };
+    const es_format_t *p_src = filter_chain_GetFmtOut( id->p_f_chain );
+    vlc_video_context *p_src_vctx = filter_chain_GetVideoCtxOut( id->p_f_chain );
+
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+        if( p_rend->b_error )
+            continue;
+
+        if( !transcode_encoder_opened( p_rend->encoder ) )
+        {
+            transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                               &id->p_decoder->fmt_out.video,
+                                               p_rend->p_cfg, &p_pic->format,
+                                               picture_GetVideoContext(p_pic),
+                                               p_rend->encoder );
+            if( transcode_encoder_open( p_rend->encoder,
+                                        p_rend->p_cfg ) != VLC_SUCCESS )
+            {
+                msg_Err( p_stream, "cannot open the encoder of video "
+                                   "rendition %zu", i + 1 );
+                p_rend->b_error = true;
+                continue;
+            }
+        }
+
+        const es_format_t *p_enc_in = transcode_encoder_format_in( p_rend->encoder );
+        if( p_src->video.i_chroma != p_enc_in->video.i_chroma ||
+            p_src->video.i_width != p_enc_in->video.i_width ||
+            p_src->video.i_height != p_enc_in->video.i_height )
+        {
+            p_rend->p_conv = filter_chain_NewVideo( p_stream, false, &owner );
+            if( !p_rend->p_conv )
+            {
+                p_rend->b_error = true;
+                continue;
+            }
+            filter_chain_Reset( p_rend->p_conv, p_src, p_src_vctx, p_enc_in );
+            if( filter_chain_AppendConverter( p_rend->p_conv,
+                                              p_enc_in ) != VLC_SUCCESS )
+            {
+                msg_Err( p_stream, "cannot convert %4.4s %ux%u to %4.4s %ux%u "
+                         "for video rendition %zu",
+                         (const char *)&p_src->video.i_chroma,
+                         p_src->video.i_width, p_src->video.i_height,
+                         (const char *)&p_enc_in->video.i_chroma,
+                         p_enc_in->video.i_width, p_enc_in->video.i_height,
+                         i + 1 );
+                transcode_remove_filters( &p_rend->p_conv );
+                p_rend->b_error = true;
+                continue;
+            }
+        }
+
+        if( !p_rend->downstream_id )
+        {
+            es_format_t orig;
+            es_format_Copy( &orig, &id->p_decoder->fmt_in );
+            orig.i_id += 1000 * (i + 1);
+            p_rend->downstream_id =
+                id->pf_transcode_downstream_add( p_stream, &orig,
+                            transcode_encoder_format_out( p_rend->encoder ) );
+            es_format_Clean( &orig );
+            if( !p_rend->downstream_id )
+            {
+                msg_Err( p_stream, "cannot output video rendition %zu", i + 1 );
+                p_rend->b_error = true;
+            }
+        }
+    }
+}
+
+/* Drains the encoders of the additional renditions, and closes them along
+ * with their conversions at the end of a sequence */
+static void transcode_video_renditions_drain( sout_stream_id_sys_t *id,
+                                              bool b_eos )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+        if( !p_rend->encoder || !transcode_encoder_opened( p_rend->encoder ) )
+            continue;
+
+        block_t *p_out = NULL;
+        transcode_encoder_drain( p_rend->encoder, &p_out );
+        if( b_eos )
+        {
+            transcode_encoder_close( p_rend->encoder );
+            transcode_remove_filters( &p_rend->p_conv );
+            tag_last_block_with_flag( &p_out, BLOCK_FLAG_END_OF_SEQUENCE );
+        }
+
+        vlc_mutex_lock( &id->fifo.lock );
+        block_ChainAppend( &p_rend->p_out, p_out );
+        vlc_mutex_unlock( &id->fifo.lock );
+    }
+}
+
+/* Sends the encoded additional renditions to their own streams */
+static void transcode_video_renditions_output( sout_stream_t *p_stream,
+                                               sout_stream_id_sys_t *id )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *p_rend = &id->p_renditions[i];
+
+        vlc_mutex_lock( &id->fifo.lock );
+        block_t *p_out = p_rend->p_out;
+        p_rend->p_out = NULL;
+        vlc_mutex_unlock( &id->fifo.lock );
+
+        if( p_rend->encoder && p_rend->p_cfg->video.threads.i_count >= 1 )
+            block_ChainAppend( &p_out,
+                    transcode_encoder_get_output_async( p_rend->encoder ) );
+
+        if( !p_out )
+            continue;
+        if( p_rend->downstream_id )
+            sout_StreamIdSend( p_stream->p_next, p_rend->downstream_id, p_out );
+        else
+            block_ChainRelease( p_out );
+    }
+}
+
+/* Runs the user filter and output chains from the given index, first with
+ * the picture, and then with NULL as many times as we need until they stop
+ * outputting frames, and encodes the result. */
+static void transcode_video_encode( sout_stream_id_sys_t *id, picture_t *p_in,
+                                    size_t i_first, block_t **out )
+{
+    for ( ;; p_in = NULL /* drain second time */ )
+    {
+        /* Run user specified filter chain */
+        filter_chain_t * secondary_chains[] = { id->p_uf_chain,
+                                                id->p_final_conv_static };
+        for( size_t i=i_first; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
+        {
+            if( !secondary_chains[i] )
+                continue;
+            p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
+        }
+
+        if( !p_in )
+            break;
+
+        /* Blend subpictures */
+        p_in = RenderSubpictures( id, p_in );
+
+        if( p_in )
+        {
+            block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
+            if( p_encoded )
+                block_ChainAppend( out, p_encoded );
+            picture_Release( p_in );
+        }
+        i_first = 0;
+    }
+}
+
+/* Runs the filter and conversion chains from the given index, then the
+ * user filter and output chains, and encodes the result. */
+static void transcode_video_filter( sout_stream_id_sys_t *id, picture_t *p_in,
+                                    size_t i_first, block_t **out )
+{
+    for ( ;; p_in = NULL /* drain second time */ )
+    {
+        /* Run filter chain */
+        filter_chain_t * primary_chains[] = { id->p_f_chain,
+                                              id->p_conv_nonstatic,
+                                              id->p_conv_static };
+        for( size_t i=i_first; p_in && i<ARRAY_SIZE(primary_chains); i++ )
+        {
+            /* Fan out after the deinterlace and frame rate filters */
+            if( i == 1 )
+                transcode_video_renditions_send( id, p_in );
+            if( !primary_chains[i] )
+                continue;
+            p_in = filter_chain_VideoFilter( primary_chains[i], p_in );
+        }
+
+        if( !p_in )
+            break;
+
+        transcode_video_encode( id, p_in, 0, out );
+        i_first = 0;
+    }
+}
+
+/* Encodes the pictures still held by pipelined filter chains */
+static void transcode_video_drain_filters( sout_stream_id_sys_t *id,
+                                           block_t **out )
+{
+    picture_t *p_pic;
+
+    if( id->p_f_chain )
+        while( (p_pic = filter_chain_VideoDrain( id->p_f_chain )) != NULL )
+            transcode_video_filter( id, p_pic, 1, out );
+    if( id->p_uf_chain )
+        while( (p_pic = filter_chain_VideoDrain( id->p_uf_chain )) != NULL )
+            transcode_video_encode( id, p_pic, 1, out );
+}
+
+static void transcode_video_filter_timed( sout_stream_id_sys_t *id,
+                                          picture_t *p_in, block_t **out )
+{
+    vlc_tick_t i_start = vlc_tick_now();
+    transcode_video_filter( id, p_in, 0, out );
+    id->filter_stats.i_busy += vlc_tick_now() - i_start;
+    id->filter_stats.i_pictures++;
+}
+
+static void *transcode_video_worker_thread( void *data )
+{
+    sout_stream_id_sys_t *id = data;
+    struct transcode_video_worker *p_worker = id->p_worker;
+
+    vlc_mutex_lock( &p_worker->lock );
+    while( !p_worker->b_closing )
+    {
+        picture_t *p_pic = picture_fifo_Pop( p_worker->pics );
+        if( p_pic == NULL )
+        {
+            p_worker->b_busy = false;
+            vlc_cond_signal( &p_worker->wait_idle );
+            vlc_cond_wait( &p_worker->wait_pic, &p_worker->lock );
+            continue;
+        }
+        vlc_mutex_unlock( &p_worker->lock );
+        vlc_sem_post( &p_worker->has_room );
+
+        block_t *p_out = NULL;
+        transcode_video_filter_timed( id, p_pic, &p_out );
+
+        vlc_mutex_lock( &p_worker->lock );
+        block_ChainAppend( &p_worker->p_out, p_out );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+    return NULL;
+}
+
+static int transcode_video_worker_new( sout_stream_id_sys_t *id,
+                                       unsigned i_queue, int i_priority )
+{
+    struct transcode_video_worker *p_worker = malloc( sizeof(*p_worker) );
+    if( !p_worker )
+        return VLC_ENOMEM;
+
+    p_worker->pics = picture_fifo_New();
+    if( !p_worker->pics )
+    {
+        free( p_worker );
+        return VLC_ENOMEM;
+    }
+    vlc_mutex_init( &p_worker->lock );
+    vlc_cond_init( &p_worker->wait_pic );
+    vlc_cond_init( &p_worker->wait_idle );
+    vlc_sem_init( &p_worker->has_room, i_queue );
+    p_worker->p_out = NULL;
+    p_worker->b_busy = false;
+    p_worker->b_closing = false;
+
+    id->p_worker = p_worker;
+    if( vlc_clone( &p_worker->thread, transcode_video_worker_thread, id,
+                   i_priority ) )
+    {
+        id->p_worker = NULL;
+        picture_fifo_Delete( p_worker->pics );
+        free( p_worker );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void transcode_video_worker_delete( struct transcode_video_worker *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    p_worker->b_closing = true;
+    vlc_cond_signal( &p_worker->wait_pic );
+    vlc_mutex_unlock( &p_worker->lock );
+    vlc_join( p_worker->thread, NULL );
+
+    picture_fifo_Delete( p_worker->pics );
+    block_ChainRelease( p_worker->p_out );
+    free( p_worker );
+}
+
+/* Queues a decoded picture, waiting while the queue is full */
+static void transcode_video_worker_push( sout_stream_id_sys_t *id,
+                                         picture_t *p_pic )
+{
+    struct transcode_video_worker *p_worker = id->p_worker;
+
+    vlc_tick_t i_start = vlc_tick_now();
+    vlc_sem_wait( &p_worker->has_room );
+    id->filter_stats.i_waiting += vlc_tick_now() - i_start;
+
+    vlc_mutex_lock( &p_worker->lock );
+    picture_fifo_Push( p_worker->pics, p_pic );
+    p_worker->b_busy = true;
+    vlc_cond_signal( &p_worker->wait_pic );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+/* Picks up the worker output, first waiting for the queued pictures if
+ * b_wait is set. Once it waited, the stream output thread can change the
+ * filters and the encoder until it pushes the next picture. */
+static void transcode_video_worker_output( struct transcode_video_worker *p_worker,
+                                           bool b_wait, block_t **out )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    while( b_wait && p_worker->b_busy )
+        vlc_cond_wait( &p_worker->wait_idle, &p_worker->lock );
+    block_ChainAppend( out, p_worker->p_out );
+    p_worker->p_out = NULL;
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+static void transcode_video_worker_sync( sout_stream_id_sys_t *id,
+                                         block_t **out )
+{
+    if( id->p_worker )
+        transcode_video_worker_output( id->p_worker, true, out );
+}
+
+static void transcode_video_log_stats( sout_stream_t *p_stream,
+                                       sout_stream_id_sys_t *id )
+{
+    transcode_stage_stats_t enc;
+    transcode_encoder_get_stats( id->encoder, &enc );
+
+    const struct
+    {
+        const char *psz_name;
+        const transcode_stage_stats_t *p_stats;
+    } stages[] = {
+        { "decode", &id->decode_stats },
+        { "filter", &id->filter_stats },
+        { "encode", &enc },
+    };
+
+    for( size_t i = 0; i < ARRAY_SIZE(stages); i++ )
+    {
+        const transcode_stage_stats_t *p_stats = stages[i].p_stats;
+        if( p_stats->i_pictures == 0 )
+            continue;
+        msg_Dbg( p_stream, "%s: %u pictures, %.2f ms busy and %.2f ms "
+                 "waited for room per picture", stages[i].psz_name,
+                 p_stats->i_pictures,
+                 (double)p_stats->i_busy / p_stats->i_pictures / VLC_TICK_FROM_MS(1),
+                 (double)p_stats->i_waiting / p_stats->i_pictures / VLC_TICK_FROM_MS(1) );
+    }
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -532,11 +1018,15 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
     bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
 
-    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    vlc_tick_t i_start = vlc_tick_now();
+    int ret = transcode_decoder_decode( id, in );
+    id->decode_stats.i_busy += vlc_tick_now() - i_start;
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
     picture_t *p_pics = transcode_dequeue_all_pics( id );
+    for( picture_t *p_pic = p_pics; p_pic; p_pic = p_pic->p_next )
+        id->decode_stats.i_pictures++;
 
     do
     {
@@ -556,6 +1046,9 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
         if( p_pic && ( unlikely(!transcode_encoder_opened(id->encoder)) ||
               !video_format_IsSimilar( &id->decoder_out.video, &p_pic->format ) ) )
         {
+            /* The worker must be done with the filters and the encoder */
+            transcode_video_worker_sync( id, out );
+
             if( !transcode_encoder_opened(id->encoder) ) /* Configure Encoder input/output */
             {
                 assert( !id->p_f_chain && !id->p_uf_chain );
@@ -574,11 +1067,13 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                             id->decoder_out.video.i_sar_den, p_pic->format.i_sar_den
                         );
                 /* Close filters, encoder format input can't change */
+                transcode_video_drain_filters( id, out );
                 transcode_remove_filters( &id->p_f_chain );
                 transcode_remove_filters( &id->p_conv_nonstatic );
                 transcode_remove_filters( &id->p_conv_static );
                 transcode_remove_filters( &id->p_uf_chain );
                 transcode_remove_filters( &id->p_final_conv_static );
+                transcode_video_renditions_remove_filters( id );
                 if( id->p_spu_blender )
                     filter_DeleteBlend( id->p_spu_blender );
                 id->p_spu_blender = NULL;
@@ -656,59 +1151,25 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
+
+            transcode_video_renditions_setup( p_stream, id, p_pic );
         }
 
-        /* Run the filter and output chains; first with the picture,
-         * and then with NULL as many times as we need until they
-         * stop outputting frames.
-         */
-        for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
+        /* Run the filter and output chains */
+        if( p_pic )
         {
-            /* Run filter chain */
-            filter_chain_t * primary_chains[] = { id->p_f_chain,
-                                                  id->p_conv_nonstatic,
-                                                  id->p_conv_static };
-            for( size_t i=0; p_in && i<ARRAY_SIZE(primary_chains); i++ )
-            {
-                if( !primary_chains[i] )
-                    continue;
-                p_in = filter_chain_VideoFilter( primary_chains[i], p_in );
-            }
-
-            if( !p_in )
-                break;
-
-            for ( ;; p_in = NULL /* drain second time */ )
-            {
-                /* Run user specified filter chain */
-                filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                        id->p_final_conv_static };
-                for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
-                {
-                    if( !secondary_chains[i] )
-                        continue;
-                    p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
-                }
-
-                if( !p_in )
-                    break;
-
-                /* Blend subpictures */
-                p_in = RenderSubpictures( id, p_in );
-
-                if( p_in )
-                {
-                    block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                    if( p_encoded )
-                        block_ChainAppend( out, p_encoded );
-                    picture_Release( p_in );
-                }
-            }
+            if( id->p_worker )
+                transcode_video_worker_push( id, p_pic );
+            else
+                transcode_video_filter_timed( id, p_pic, out );
         }
 
         if( b_eos )
         {
             msg_Info( p_stream, "Drain/restart on EOS" );
+            transcode_video_worker_sync( id, out );
+            transcode_video_drain_filters( id, out );
+            transcode_video_renditions_drain( id, true );
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
             transcode_encoder_close( id->encoder );
@@ -729,6 +1190,9 @@ error:
         id->b_error = true;
     } while( p_pics );
 
+    if( id->p_worker )
+        transcode_video_worker_output( id->p_worker, false, out );
+
     if( id->p_enccfg->video.threads.i_count >= 1 )
     {
         /* Pick up any return data the encoder thread wants to output. */
@@ -739,14 +1203,20 @@ error:
     if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
     {
         msg_Dbg( p_stream, "Flushing thread and waiting that");
+        transcode_video_worker_sync( id, out );
+        transcode_video_drain_filters( id, out );
+        transcode_video_renditions_drain( id, false );
         if( transcode_encoder_drain( id->encoder, out ) == VLC_SUCCESS )
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
+        transcode_video_log_stats( p_stream, id );
     }
 
     if( b_eos )
         tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
 
+    transcode_video_renditions_output( p_stream, id );
+
     return id->b_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
@@ -130,8 +130,403 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSSE3() (0)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+# undef vlc_CPU_AVX512
+# define vlc_CPU_AVX512() (0)
+#elif defined (COPY_TEST)
+/* The benchmark compares the AVX paths with the SSE ones */
+static unsigned copy_test_cpu = VLC_CPU_AVX2 | VLC_CPU_AVX512;
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() ((vlc_CPU() & copy_test_cpu & VLC_CPU_AVX2) != 0)
+# undef vlc_CPU_AVX512
+# define vlc_CPU_AVX512() ((vlc_CPU() & copy_test_cpu & VLC_CPU_AVX512) != 0)
 #endif
 
+#if defined (HAVE_AVX2_INTRINSICS) || defined (HAVE_AVX512_INTRINSICS)
+# include <immintrin.h>
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+/* AVX2 variants of the kernels below. They work on 32 bytes at once, and
+ * are selected at run time by the SSE kernels. */
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static inline __m256i AVX2_Shift(__m256i v, __m128i shl, __m128i shr)
+{
+    return _mm256_srl_epi16(_mm256_sll_epi16(v, shl), shr);
+}
+
+VLC_AVX2
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    const __m128i shl = _mm_cvtsi32_si128(bitshift < 0 ? -bitshift : 0);
+    const __m128i shr = _mm_cvtsi32_si128(bitshift > 0 ? bitshift : 0);
+
+    _mm_mfence();
+
+    for (unsigned y = 0; y < height; y++) {
+        /* Streaming loads need aligned addresses: copy the unaligned head
+         * with a regular load first. */
+        const unsigned unaligned = (-(uintptr_t)src) & 0x1f;
+        unsigned x = 0;
+
+        if (unaligned && width >= 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)src);
+            _mm256_storeu_si256((__m256i *)dst, AVX2_Shift(v, shl, shr));
+            x = unaligned;
+        }
+
+        for (; x + 127 < width; x += 128) {
+            __m256i *in = (__m256i *)&src[x];
+            __m256i v0 = _mm256_stream_load_si256(in + 0);
+            __m256i v1 = _mm256_stream_load_si256(in + 1);
+            __m256i v2 = _mm256_stream_load_si256(in + 2);
+            __m256i v3 = _mm256_stream_load_si256(in + 3);
+            __m256i *out = (__m256i *)&dst[x];
+            _mm256_storeu_si256(out + 0, AVX2_Shift(v0, shl, shr));
+            _mm256_storeu_si256(out + 1, AVX2_Shift(v1, shl, shr));
+            _mm256_storeu_si256(out + 2, AVX2_Shift(v2, shl, shr));
+            _mm256_storeu_si256(out + 3, AVX2_Shift(v3, shl, shr));
+        }
+        for (; x + 31 < width; x += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)&src[x]);
+            _mm256_storeu_si256((__m256i *)&dst[x], AVX2_Shift(v, shl, shr));
+        }
+
+        if (x < width)
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+
+    _mm_mfence();
+}
+
+VLC_AVX2
+static void AVX2_Copy2d(uint8_t *dst, size_t dst_pitch,
+                        const uint8_t *src, size_t src_pitch,
+                        unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        if (((uintptr_t)dst & 0x1f) == 0) {
+            for (; x + 127 < width; x += 128) {
+                const __m256i *in = (const __m256i *)&src[x];
+                __m256i *out = (__m256i *)&dst[x];
+                __m256i v0 = _mm256_loadu_si256(in + 0);
+                __m256i v1 = _mm256_loadu_si256(in + 1);
+                __m256i v2 = _mm256_loadu_si256(in + 2);
+                __m256i v3 = _mm256_loadu_si256(in + 3);
+                _mm256_stream_si256(out + 0, v0);
+                _mm256_stream_si256(out + 1, v1);
+                _mm256_stream_si256(out + 2, v2);
+                _mm256_stream_si256(out + 3, v3);
+            }
+        }
+        for (; x + 31 < width; x += 32)
+            _mm256_storeu_si256((__m256i *)&dst[x],
+                                _mm256_loadu_si256((const __m256i *)&src[x]));
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_sfence();
+}
+
+VLC_AVX2
+static void AVX2_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *srcu, size_t srcu_pitch,
+                              const uint8_t *srcv, size_t srcv_pitch,
+                              unsigned width, unsigned height,
+                              uint8_t pixel_size)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 31 < width; x += 32) {
+            __m256i u = _mm256_loadu_si256((const __m256i *)&srcu[x]);
+            __m256i v = _mm256_loadu_si256((const __m256i *)&srcv[x]);
+            __m256i lo, hi;
+
+            /* The unpacks work within 128-bit lanes */
+            if (pixel_size == 1) {
+                lo = _mm256_unpacklo_epi8(u, v);
+                hi = _mm256_unpackhi_epi8(u, v);
+            } else {
+                lo = _mm256_unpacklo_epi16(u, v);
+                hi = _mm256_unpackhi_epi16(u, v);
+            }
+            _mm256_storeu_si256((__m256i *)&dst[2*x],
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256((__m256i *)&dst[2*x+32],
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+
+        if (pixel_size == 1) {
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        } else {
+            for (; x < width; x += 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+}
+
+VLC_AVX2
+static void AVX2_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                         uint8_t *dstv, size_t dstv_pitch,
+                         const uint8_t *src, size_t src_pitch,
+                         unsigned width, unsigned height, uint8_t pixel_size)
+{
+    const __m256i shuffle = pixel_size == 1
+        ? _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+                           0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15)
+        : _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+                           0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 31 < width; x += 32) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)&src[2*x]);
+            __m256i b = _mm256_loadu_si256((const __m256i *)&src[2*x+32]);
+
+            /* Each lane holds 8 bytes of U then 8 bytes of V: gather the
+             * U then the V quadwords, then split them across a and b. */
+            a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuffle),
+                                         _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuffle),
+                                         _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i *)&dstu[x],
+                                _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256((__m256i *)&dstv[x],
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+
+        if (pixel_size == 1) {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        } else {
+            for (; x < width; x += 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#ifdef HAVE_AVX512_INTRINSICS
+/* AVX-512 variants, on 64 bytes at once. Only the F and BW subsets are
+ * used. */
+#define VLC_AVX512 __attribute__ ((__target__ ("avx512f,avx512bw")))
+
+VLC_AVX512
+static inline __m512i AVX512_Shift(__m512i v, __m128i shl, __m128i shr)
+{
+    return _mm512_srl_epi16(_mm512_sll_epi16(v, shl), shr);
+}
+
+VLC_AVX512
+static void AVX512_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                                const uint8_t *src, size_t src_pitch,
+                                unsigned width, unsigned height, int bitshift)
+{
+    const __m128i shl = _mm_cvtsi32_si128(bitshift < 0 ? -bitshift : 0);
+    const __m128i shr = _mm_cvtsi32_si128(bitshift > 0 ? bitshift : 0);
+
+    _mm_mfence();
+
+    for (unsigned y = 0; y < height; y++) {
+        const unsigned unaligned = (-(uintptr_t)src) & 0x3f;
+        unsigned x = 0;
+
+        if (unaligned && width >= 64) {
+            __m512i v = _mm512_loadu_si512(src);
+            _mm512_storeu_si512(dst, AVX512_Shift(v, shl, shr));
+            x = unaligned;
+        }
+
+        for (; x + 255 < width; x += 256) {
+            void *in = (void *)&src[x];
+            __m512i v0 = _mm512_stream_load_si512((__m512i *)in + 0);
+            __m512i v1 = _mm512_stream_load_si512((__m512i *)in + 1);
+            __m512i v2 = _mm512_stream_load_si512((__m512i *)in + 2);
+            __m512i v3 = _mm512_stream_load_si512((__m512i *)in + 3);
+            __m512i *out = (__m512i *)&dst[x];
+            _mm512_storeu_si512(out + 0, AVX512_Shift(v0, shl, shr));
+            _mm512_storeu_si512(out + 1, AVX512_Shift(v1, shl, shr));
+            _mm512_storeu_si512(out + 2, AVX512_Shift(v2, shl, shr));
+            _mm512_storeu_si512(out + 3, AVX512_Shift(v3, shl, shr));
+        }
+        for (; x + 63 < width; x += 64) {
+            __m512i v = _mm512_loadu_si512(&src[x]);
+            _mm512_storeu_si512(&dst[x], AVX512_Shift(v, shl, shr));
+        }
+
+        if (x < width)
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+
+    _mm_mfence();
+}
+
+VLC_AVX512
+static void AVX512_Copy2d(uint8_t *dst, size_t dst_pitch,
+                          const uint8_t *src, size_t src_pitch,
+                          unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        if (((uintptr_t)dst & 0x3f) == 0) {
+            for (; x + 255 < width; x += 256) {
+                __m512i *out = (__m512i *)&dst[x];
+                __m512i v0 = _mm512_loadu_si512(&src[x]);
+                __m512i v1 = _mm512_loadu_si512(&src[x+64]);
+                __m512i v2 = _mm512_loadu_si512(&src[x+128]);
+                __m512i v3 = _mm512_loadu_si512(&src[x+192]);
+                _mm512_stream_si512(out + 0, v0);
+                _mm512_stream_si512(out + 1, v1);
+                _mm512_stream_si512(out + 2, v2);
+                _mm512_stream_si512(out + 3, v3);
+            }
+        }
+        for (; x + 63 < width; x += 64)
+            _mm512_storeu_si512(&dst[x], _mm512_loadu_si512(&src[x]));
+
+        for (; x < width; x++)
+            dst[x] = src[x];
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    _mm_sfence();
+}
+
+VLC_AVX512
+static void AVX512_InterleaveUV(uint8_t *dst, size_t dst_pitch,
+                                const uint8_t *srcu, size_t srcu_pitch,
+                                const uint8_t *srcv, size_t srcv_pitch,
+                                unsigned width, unsigned height,
+                                uint8_t pixel_size)
+{
+    const __m512i perm_lo = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i perm_hi = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 63 < width; x += 64) {
+            __m512i u = _mm512_loadu_si512(&srcu[x]);
+            __m512i v = _mm512_loadu_si512(&srcv[x]);
+            __m512i lo, hi;
+
+            if (pixel_size == 1) {
+                lo = _mm512_unpacklo_epi8(u, v);
+                hi = _mm512_unpackhi_epi8(u, v);
+            } else {
+                lo = _mm512_unpacklo_epi16(u, v);
+                hi = _mm512_unpackhi_epi16(u, v);
+            }
+            _mm512_storeu_si512(&dst[2*x],
+                                _mm512_permutex2var_epi64(lo, perm_lo, hi));
+            _mm512_storeu_si512(&dst[2*x+64],
+                                _mm512_permutex2var_epi64(lo, perm_hi, hi));
+        }
+
+        if (pixel_size == 1) {
+            for (; x < width; x++) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcv[x];
+            }
+        } else {
+            for (; x < width; x += 2) {
+                dst[2*x+0] = srcu[x];
+                dst[2*x+1] = srcu[x + 1];
+                dst[2*x+2] = srcv[x];
+                dst[2*x+3] = srcv[x + 1];
+            }
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst += dst_pitch;
+    }
+}
+
+VLC_AVX512
+static void AVX512_SplitUV(uint8_t *dstu, size_t dstu_pitch,
+                           uint8_t *dstv, size_t dstv_pitch,
+                           const uint8_t *src, size_t src_pitch,
+                           unsigned width, unsigned height, uint8_t pixel_size)
+{
+    const __m512i shuffle = _mm512_broadcast_i32x4(pixel_size == 1
+        ? _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15)
+        : _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15));
+    const __m512i perm_u = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m512i perm_v = _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15);
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 63 < width; x += 64) {
+            /* Even quadwords hold U, odd ones hold V */
+            __m512i a = _mm512_shuffle_epi8(_mm512_loadu_si512(&src[2*x]),
+                                            shuffle);
+            __m512i b = _mm512_shuffle_epi8(_mm512_loadu_si512(&src[2*x+64]),
+                                            shuffle);
+            _mm512_storeu_si512(&dstu[x],
+                                _mm512_permutex2var_epi64(a, perm_u, b));
+            _mm512_storeu_si512(&dstv[x],
+                                _mm512_permutex2var_epi64(a, perm_v, b));
+        }
+
+        if (pixel_size == 1) {
+            for (; x < width; x++) {
+                dstu[x] = src[2*x+0];
+                dstv[x] = src[2*x+1];
+            }
+        } else {
+            for (; x < width; x += 2) {
+                dstu[x] = src[2*x+0];
+                dstu[x+1] = src[2*x+1];
+                dstv[x] = src[2*x+2];
+                dstv[x+1] = src[2*x+3];
+            }
+        }
+        src  += src_pitch;
+        dstu += dstu_pitch;
+        dstv += dstv_pitch;
+    }
+}
+#endif /* HAVE_AVX512_INTRINSICS */
+
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
  * as used by some video surface.
  * XXX It is really efficient only when SSE4.1 is available.
@@ -143,6 +538,17 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)dst & 0x0f) == 0 && (dst_pitch & 0x0f) == 0);
 
+#ifdef HAVE_AVX512_INTRINSICS
+    if (vlc_CPU_AVX512())
+        return AVX512_CopyFromUswc(dst, dst_pitch, src, src_pitch,
+                                   width, height, bitshift);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return AVX2_CopyFromUswc(dst, dst_pitch, src, src_pitch,
+                                 width, height, bitshift);
+#endif
+
     asm volatile ("mfence");
 
 #define SSE_USWC_COPY(shiftstr16, shiftstr64) \
@@ -196,7 +602,7 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
             SSE_USWC_COPY(COPY16_SHIFTR("$4"), COPY64_SHIFTR("$4"))
             break;
         case -4:
-            SSE_USWC_COPY(COPY16_SHIFTL("$2"), COPY64_SHIFTL("$2"))
+            SSE_USWC_COPY(COPY16_SHIFTL("$4"), COPY64_SHIFTL("$4"))
             break;
         default:
             vlc_assert_unreachable();
@@ -213,6 +619,17 @@ static void Copy2d(uint8_t *dst, size_t dst_pitch,
 {
     assert(((intptr_t)src & 0x0f) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef HAVE_AVX512_INTRINSICS
+    if (vlc_CPU_AVX512())
+        return AVX512_Copy2d(dst, dst_pitch, src, src_pitch,
+                             width, height);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return AVX2_Copy2d(dst, dst_pitch, src, src_pitch,
+                           width, height);
+#endif
+
     for (unsigned y = 0; y < height; y++) {
         unsigned x = 0;
 
@@ -243,6 +660,17 @@ SSE_InterleaveUV(uint8_t *dst, size_t dst_pitch,
     assert(!((intptr_t)srcu & 0xf) && !(srcu_pitch & 0x0f) &&
            !((intptr_t)srcv & 0xf) && !(srcv_pitch & 0x0f));
 
+#ifdef HAVE_AVX512_INTRINSICS
+    if (vlc_CPU_AVX512())
+        return AVX512_InterleaveUV(dst, dst_pitch, srcu, srcu_pitch,
+                                   srcv, srcv_pitch, width, height, pixel_size);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return AVX2_InterleaveUV(dst, dst_pitch, srcu, srcu_pitch,
+                                 srcv, srcv_pitch, width, height, pixel_size);
+#endif
+
     static const uint8_t shuffle_8[] = { 0, 8,
                                          1, 9,
                                          2, 10,
@@ -358,6 +786,17 @@ static void SSE_SplitUV(uint8_t *dstu, size_t dstu_pitch,
     assert(pixel_size == 1 || pixel_size == 2);
     assert(((intptr_t)src & 0xf) == 0 && (src_pitch & 0x0f) == 0);
 
+#ifdef HAVE_AVX512_INTRINSICS
+    if (vlc_CPU_AVX512())
+        return AVX512_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                              src, src_pitch, width, height, pixel_size);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return AVX2_SplitUV(dstu, dstu_pitch, dstv, dstv_pitch,
+                            src, src_pitch, width, height, pixel_size);
+#endif
+
 #define LOAD64 \
     "movdqa  0(%[src]), %%xmm0\n" \
     "movdqa 16(%[src]), %%xmm1\n" \
@@ -1106,18 +1545,90 @@ static picture_t *pic_new_unaligned(const video_format_t *fmt)
     return picture_NewFromResource(fmt, &rsc);
 }
 
-int main(void)
+static void Convert(const struct test_dst *test_dst, picture_t *dst,
+                    const picture_t *src, const copy_cache_t *cache)
 {
-    alarm(10);
+    const uint8_t * src_planes[3] = { src->p[Y_PLANE].p_pixels,
+                                      src->p[U_PLANE].p_pixels,
+                                      src->p[V_PLANE].p_pixels };
+    const size_t    src_pitches[3] = { src->p[Y_PLANE].i_pitch,
+                                       src->p[U_PLANE].i_pitch,
+                                       src->p[V_PLANE].i_pitch };
+
+    if (test_dst->bitshift == 0)
+        test_dst->conv(dst, src_planes, src_pitches,
+                       src->format.i_visible_height, cache);
+    else
+        test_dst->conv16(dst, src_planes, src_pitches,
+                         src->format.i_visible_height, test_dst->bitshift,
+                         cache);
+}
+
+struct test_level
+{
+    const char *name;
+    unsigned cpu;
+};
+
+static const struct test_level levels[] = {
+#ifdef COPY_TEST_NOOPTIM
+    { "C", 0 },
+#else
+    { "SSE", 0 },
+# ifdef HAVE_AVX2_INTRINSICS
+    { "AVX2", VLC_CPU_AVX2 },
+# endif
+# ifdef HAVE_AVX512_INTRINSICS
+    { "AVX-512", VLC_CPU_AVX2 | VLC_CPU_AVX512 },
+# endif
+#endif
+};
+#define NB_LEVELS ARRAY_SIZE(levels)
 
+static bool SetLevel(const struct test_level *level)
+{
 #ifndef COPY_TEST_NOOPTIM
-    if (!vlc_CPU_SSE2())
+    if ((vlc_CPU() & level->cpu) != level->cpu)
+        return false;
+    copy_test_cpu = level->cpu;
+#endif
+    return true;
+}
+
+static void picfill(picture_t *pic, uint32_t seed)
+{
+    for (int i = 0; i < pic->i_planes; i++)
     {
-        fprintf(stderr, "WARNING: could not test SSE\n");
-        return 77;
+        const plane_t *plane = &pic->p[i];
+        for (int y = 0; y < plane->i_lines; y++)
+            for (int x = 0; x < plane->i_pitch; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                plane->p_pixels[y * plane->i_pitch + x] = seed >> 16;
+            }
     }
-#endif
+}
 
+static void piccmp(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const plane_t *pa = &a->p[i], *pb = &b->p[i];
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(&pa->p_pixels[y * pa->i_pitch],
+                       &pb->p_pixels[y * pb->i_pitch], pa->i_visible_pitch))
+            {
+                fprintf(stderr, "error: line doesn't match @ plane: %d: %d\n",
+                        i, y);
+                assert(!"error: line doesn't match");
+            }
+    }
+}
+
+/* Checks the conversions with solid colors */
+static void CheckColors(void)
+{
     for (size_t i = 0; i < NB_CONVS; ++i)
     {
         const struct test_conv *conv = &convs[i];
@@ -1156,25 +1667,12 @@ int main(void)
                 picture_t *dst = picture_NewFromFormat(&fmt);
                 assert(dst);
 
-                const uint8_t * src_planes[3] = { src->p[Y_PLANE].p_pixels,
-                                                  src->p[U_PLANE].p_pixels,
-                                                  src->p[V_PLANE].p_pixels };
-                const size_t    src_pitches[3] = { src->p[Y_PLANE].i_pitch,
-                                                   src->p[U_PLANE].i_pitch,
-                                                   src->p[V_PLANE].i_pitch };
-
                 fprintf(stderr, "testing: %u x %u (vis: %u x %u) %4.4s -> %4.4s\n",
                         size->i_width, size->i_height,
                         size->i_visible_width, size->i_visible_height,
                         (const char *) &src->format.i_chroma,
                         (const char *) &dst->format.i_chroma);
-                if (test_dst->bitshift == 0)
-                    test_dst->conv(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, &cache);
-                else
-                    test_dst->conv16(dst, src_planes, src_pitches,
-                                   src->format.i_visible_height, test_dst->bitshift,
-                                   &cache);
+                Convert(test_dst, dst, src, &cache);
                 piccheck(dst, dst_dsc, false);
                 picture_Release(dst);
             }
@@ -1182,6 +1680,167 @@ int main(void)
             CopyCleanCache(&cache);
         }
     }
+}
+
+/* Checks that all instruction sets give the same results on noise, so that
+ * the shuffles are checked too */
+static void CheckLevels(void)
+{
+    for (size_t i = 0; i < NB_CONVS; ++i)
+    {
+        const struct test_conv *conv = &convs[i];
+
+        for (size_t j = 0; j < NB_SIZES; ++j)
+        {
+            const struct test_size *size = &sizes[j];
+
+            video_format_t fmt;
+            video_format_Init(&fmt, 0);
+            video_format_Setup(&fmt, conv->src_chroma,
+                               size->i_width, size->i_height,
+                               size->i_visible_width, size->i_visible_height,
+                               1, 1);
+            picture_t *src = pic_new_unaligned(&fmt);
+            assert(src);
+            picfill(src, j);
+
+            copy_cache_t cache;
+            int ret = CopyInitCache(&cache, src->p[0].i_pitch);
+            assert(ret == VLC_SUCCESS);
+
+            for (size_t f = 0; conv->dsts[f].chroma != 0; ++f)
+            {
+                const struct test_dst *test_dst = &conv->dsts[f];
+                picture_t *ref = NULL;
+
+                fmt.i_chroma = test_dst->chroma;
+                for (size_t l = 0; l < NB_LEVELS; l++)
+                {
+                    if (!SetLevel(&levels[l]))
+                        continue;
+
+                    picture_t *dst = picture_NewFromFormat(&fmt);
+                    assert(dst);
+                    Convert(test_dst, dst, src, &cache);
+                    if (ref == NULL)
+                        ref = dst;
+                    else
+                    {
+                        fprintf(stderr, "comparing: %u x %u %4.4s -> %4.4s "
+                                "%s\n", size->i_width, size->i_height,
+                                (const char *) &conv->src_chroma,
+                                (const char *) &test_dst->chroma,
+                                levels[l].name);
+                        piccmp(ref, dst);
+                        picture_Release(dst);
+                    }
+                }
+                picture_Release(ref);
+            }
+            picture_Release(src);
+            CopyCleanCache(&cache);
+        }
+    }
+}
+
+static const struct test_size bench_sizes[] = {
+    { 1920, 1088, 1920, 1080 },
+    { 3840, 2160, 3840, 2160 },
+    { 7680, 4320, 7680, 4320 },
+};
+
+/* Measures the throughput of each conversion, with each instruction set */
+static void Bench(unsigned frames)
+{
+    for (size_t i = 0; i < NB_CONVS; ++i)
+    {
+        const struct test_conv *conv = &convs[i];
+
+        for (size_t j = 0; j < ARRAY_SIZE(bench_sizes); ++j)
+        {
+            const struct test_size *size = &bench_sizes[j];
+
+            video_format_t fmt;
+            video_format_Init(&fmt, 0);
+            video_format_Setup(&fmt, conv->src_chroma,
+                               size->i_width, size->i_height,
+                               size->i_visible_width, size->i_visible_height,
+                               1, 1);
+            picture_t *src = picture_NewFromFormat(&fmt);
+            assert(src);
+            picfill(src, j);
+
+            size_t bytes = 0;
+            for (int p = 0; p < src->i_planes; p++)
+                bytes += src->p[p].i_visible_pitch * src->p[p].i_visible_lines;
+
+            copy_cache_t cache;
+            int ret = CopyInitCache(&cache, src->p[0].i_pitch);
+            assert(ret == VLC_SUCCESS);
+
+            for (size_t f = 0; conv->dsts[f].chroma != 0; ++f)
+            {
+                const struct test_dst *test_dst = &conv->dsts[f];
+
+                fmt.i_chroma = test_dst->chroma;
+                picture_t *dst = picture_NewFromFormat(&fmt);
+                assert(dst);
+
+                for (size_t l = 0; l < NB_LEVELS; l++)
+                {
+                    if (!SetLevel(&levels[l]))
+                        continue;
+
+                    Convert(test_dst, dst, src, &cache); /* warm up */
+
+                    vlc_tick_t start = vlc_tick_now();
+                    for (unsigned n = 0; n < frames; n++)
+                        Convert(test_dst, dst, src, &cache);
+                    double secs = secf_from_vlc_tick(vlc_tick_now() - start);
+
+                    printf("%4.4s -> %4.4s %4ux%-4u %-7s: %7.1f fps "
+                           "%6.0f MB/s\n",
+                           (const char *) &conv->src_chroma,
+                           (const char *) &test_dst->chroma,
+                           size->i_visible_width, size->i_visible_height,
+                           levels[l].name, frames / secs,
+                           frames * bytes / secs / 1000000.);
+                }
+                picture_Release(dst);
+            }
+            picture_Release(src);
+            CopyCleanCache(&cache);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    /* Keep the default run short for make check */
+    unsigned frames = 5;
+    if (argc > 1)
+        frames = strtoul(argv[1], NULL, 0);
+
+    alarm(10);
+
+#ifndef COPY_TEST_NOOPTIM
+    if (!vlc_CPU_SSE2())
+    {
+        fprintf(stderr, "WARNING: could not test SSE\n");
+        return 77;
+    }
+#endif
+
+    for (size_t l = 0; l < NB_LEVELS; l++)
+        if (SetLevel(&levels[l]))
+        {
+            fprintf(stderr, "testing with %s\n", levels[l].name);
+            CheckColors();
+        }
+    CheckLevels();
+
+    alarm(argc > 1 ? 0 : 30);
+    Bench(frames);
     return 0;
 }
 
@@ -269,6 +269,8 @@ static int Activate( vlc_object_t *p_this )
     video_format_Clean( &vfmt );
 #endif
 
+    p_sys->p_slices = vlc_slice_pool_Inherit( p_filter );
+
     return 0;
 }
 
@@ -287,20 +289,103 @@ static void Deactivate( vlc_object_t *p_this )
 #endif
     free( p_sys->p_offset );
     free( p_sys->p_buffer );
+    if( p_sys->p_slices != NULL )
+        vlc_slice_pool_Delete( p_sys->p_slices );
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Convert: run a conversion, split in slices of lines if not scaling
+ *****************************************************************************/
+typedef void (*convert_fn)( filter_t *, picture_t *, picture_t *,
+                            unsigned, unsigned );
+
+struct convert_job
+{
+    filter_t *p_filter;
+    const picture_t *p_src;
+    const picture_t *p_dst;
+    convert_fn pf_convert;
+    unsigned i_height;
+};
+
+static void ConvertSlice( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct convert_job *job = opaque;
+    unsigned i_first, i_end;
+
+    /* Multiple of 4 lines to keep the 8 bpp dithering matrix aligned */
+    vlc_slice_GetRows( i_slice, i_count, job->i_height, 4,
+                       &i_first, &i_end );
+    if( i_first == i_end )
+        return;
+
+    picture_t src = { .i_planes = job->p_src->i_planes };
+    picture_t dst = { .i_planes = job->p_dst->i_planes };
+    memcpy( src.p, job->p_src->p, sizeof( src.p ) );
+    memcpy( dst.p, job->p_dst->p, sizeof( dst.p ) );
+
+    src.p[Y_PLANE].p_pixels += i_first * src.p[Y_PLANE].i_pitch;
+    src.p[U_PLANE].p_pixels += i_first / 2 * src.p[U_PLANE].i_pitch;
+    src.p[V_PLANE].p_pixels += i_first / 2 * src.p[V_PLANE].i_pitch;
+    dst.p[0].p_pixels += i_first * dst.p[0].i_pitch;
+
+    job->pf_convert( job->p_filter, &src, &dst,
+                     i_end - i_first, i_end - i_first );
+}
+
+static picture_t *Convert( filter_t *p_filter, picture_t *p_pic,
+                           convert_fn pf_convert )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *p_in = &p_filter->fmt_in.video;
+    const video_format_t *p_out = &p_filter->fmt_out.video;
+    const unsigned i_height = p_in->i_y_offset + p_in->i_visible_height;
+    const unsigned i_pic_height = p_out->i_y_offset + p_out->i_visible_height;
+
+    picture_t *p_outpic = filter_NewPicture( p_filter );
+    if( p_outpic )
+    {
+        unsigned i_threads = vlc_slice_pool_GetThreads( p_sys->p_slices );
+
+        /* Scaling has state across lines, only split plain conversions */
+        if( i_threads > 1
+         && p_in->i_x_offset + p_in->i_visible_width
+              == p_out->i_x_offset + p_out->i_visible_width
+         && i_height == i_pic_height )
+        {
+            struct convert_job job = {
+                p_filter, p_pic, p_outpic, pf_convert, i_height
+            };
+            vlc_slice_dispatch( p_sys->p_slices, i_threads,
+                                ConvertSlice, &job );
+        }
+        else
+            pf_convert( p_filter, p_pic, p_outpic, i_height, i_pic_height );
+        picture_CopyProperties( p_outpic, p_pic );
+    }
+    picture_Release( p_pic );
+    return p_outpic;
+}
+
+#define CONVERT_WRAPPER( name )                                             \
+    static picture_t *name ## _Filter( filter_t *p_filter,                  \
+                                       picture_t *p_pic )                   \
+    {                                                                       \
+        return Convert( p_filter, p_pic, name );                            \
+    }
+
 #ifndef PLAIN
-VIDEO_FILTER_WRAPPER( I420_R5G5B5 )
-VIDEO_FILTER_WRAPPER( I420_R5G6B5 )
-VIDEO_FILTER_WRAPPER( I420_A8R8G8B8 )
-VIDEO_FILTER_WRAPPER( I420_R8G8B8A8 )
-VIDEO_FILTER_WRAPPER( I420_B8G8R8A8 )
-VIDEO_FILTER_WRAPPER( I420_A8B8G8R8 )
+CONVERT_WRAPPER( I420_R5G5B5 )
+CONVERT_WRAPPER( I420_R5G6B5 )
+CONVERT_WRAPPER( I420_A8R8G8B8 )
+CONVERT_WRAPPER( I420_R8G8B8A8 )
+CONVERT_WRAPPER( I420_B8G8R8A8 )
+CONVERT_WRAPPER( I420_A8B8G8R8 )
 #else
-VIDEO_FILTER_WRAPPER( I420_RGB8 )
-VIDEO_FILTER_WRAPPER( I420_RGB16 )
-VIDEO_FILTER_WRAPPER( I420_RGB32 )
+CONVERT_WRAPPER( I420_RGB8 )
+CONVERT_WRAPPER( I420_RGB16 )
+CONVERT_WRAPPER( I420_RGB32 )
 
 /*****************************************************************************
  * SetYUV: compute tables and set function pointers
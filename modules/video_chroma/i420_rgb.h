@@ -20,6 +20,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <limits.h>
+#include <vlc_slice.h>
 
 #if !defined (SSE2) && !defined (MMX)
 # define PLAIN
@@ -40,6 +41,7 @@ typedef struct
     size_t    i_buffer_size;
     uint8_t   i_bytespp;
     int *p_offset;
+    vlc_slice_pool_t *p_slices;        /**< threads for unscaled conversions */
 
 #ifdef PLAIN
     /**< Pre-calculated conversion tables */
@@ -79,18 +81,30 @@ static inline int AllocateOrGrow( uint8_t **pp_buffer, size_t *pi_buffer,
 
 /*****************************************************************************
  * Prototypes
+ *****************************************************************************
+ * The conversions take the numbers of source and destination lines, so that
+ * they can run on a slice of the pictures.
  *****************************************************************************/
 #ifdef PLAIN
-void I420_RGB8         ( filter_t *, picture_t *, picture_t * );
-void I420_RGB16        ( filter_t *, picture_t *, picture_t * );
-void I420_RGB32        ( filter_t *, picture_t *, picture_t * );
+void I420_RGB8         ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_RGB16        ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_RGB32        ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
 #else
-void I420_R5G5B5       ( filter_t *, picture_t *, picture_t * );
-void I420_R5G6B5       ( filter_t *, picture_t *, picture_t * );
-void I420_A8R8G8B8     ( filter_t *, picture_t *, picture_t * );
-void I420_R8G8B8A8     ( filter_t *, picture_t *, picture_t * );
-void I420_B8G8R8A8     ( filter_t *, picture_t *, picture_t * );
-void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
+void I420_R5G5B5       ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_R5G6B5       ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_A8R8G8B8     ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_R8G8B8A8     ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_B8G8R8A8     ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
+void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t *,
+                         unsigned, unsigned );
 #endif
 
 /*****************************************************************************
@@ -282,7 +296,7 @@ void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
     switch( i_vscale )                                                        \
     {                                                                         \
     case -1:                             /* vertical scaling factor is < 1 */ \
-        while( (i_scale_count -= (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height)) > 0 )      \
+        while( (i_scale_count -= i_pic_height) > 0 )                          \
         {                                                                     \
             /* Height reduction: skip next source line */                     \
             p_y += (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width);                            \
@@ -301,16 +315,16 @@ void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
                 p_v += (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width);                        \
             }                                                                 \
         }                                                                     \
-        i_scale_count += (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);                     \
+        i_scale_count += i_height;                                            \
         break;                                                                \
     case 1:                              /* vertical scaling factor is > 1 */ \
-        while( (i_scale_count -= (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height)) > 0 )       \
+        while( (i_scale_count -= i_height) > 0 )                              \
         {                                                                     \
             /* Height increment: copy previous picture line */                \
             memcpy( p_pic, p_pic_start, (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width) * BPP ); \
             p_pic = (void*)((uint8_t*)p_pic + p_dest->p->i_pitch );           \
         }                                                                     \
-        i_scale_count += (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height);                    \
+        i_scale_count += i_pic_height;                                        \
         break;                                                                \
     }                                                                         \
 
@@ -337,7 +351,7 @@ void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
     switch( i_vscale )                                                        \
     {                                                                         \
     case -1:                             /* vertical scaling factor is < 1 */ \
-        while( (i_scale_count -= (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height)) > 0 )      \
+        while( (i_scale_count -= i_pic_height) > 0 )                          \
         {                                                                     \
             /* Height reduction: skip next source line */                     \
             p_y += (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width);                            \
@@ -356,17 +370,17 @@ void I420_A8B8G8R8     ( filter_t *, picture_t *, picture_t * );
                 p_v += (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width);                        \
             }                                                                 \
         }                                                                     \
-        i_scale_count += (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);                     \
+        i_scale_count += i_height;                                            \
         break;                                                                \
     case 1:                              /* vertical scaling factor is > 1 */ \
-        while( (i_scale_count -= (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height)) > 0 )       \
+        while( (i_scale_count -= i_height) > 0 )                              \
         {                                                                     \
             p_y -= (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width);                            \
             p_u -= i_chroma_width;                                            \
             p_v -= i_chroma_width;                                            \
             SCALE_WIDTH_DITHER( CHROMA );                                     \
         }                                                                     \
-        i_scale_count += (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height);                    \
+        i_scale_count += i_pic_height;                                        \
         break;                                                                \
     }                                                                         \
 
@@ -104,7 +104,8 @@ static void SetOffset( int i_width, int i_height, int i_pic_width,
  *  - output: 1 line
  *****************************************************************************/
 
-void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB16( filter_t *p_filter, picture_t *p_src,
+                 picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -150,9 +151,9 @@ void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -167,9 +168,9 @@ void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+                    i_pic_height :
+                    i_height;
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -219,7 +220,8 @@ void I420_RGB16( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
  *  - output: 1 line
  *****************************************************************************/
 
-void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB32( filter_t *p_filter, picture_t *p_src,
+                 picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -265,9 +267,9 @@ void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -282,9 +284,9 @@ void I420_RGB32( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+                    i_pic_height :
+                    i_height;
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -100,7 +100,8 @@ static void SetOffset( int i_width, int i_height, int i_pic_width,
 }
 
 VLC_TARGET
-void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R5G5B5( filter_t *p_filter, picture_t *p_src,
+                  picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -141,9 +142,9 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -158,8 +159,8 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -178,7 +179,7 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -229,7 +230,7 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -285,7 +286,7 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -340,7 +341,8 @@ void I420_R5G5B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R5G6B5( filter_t *p_filter, picture_t *p_src,
+                  picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -381,9 +383,9 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -398,8 +400,8 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -418,7 +420,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -469,7 +471,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -525,7 +527,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -581,7 +583,7 @@ void I420_R5G6B5( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
 VLC_TARGET
 void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
-                                            picture_t *p_dest )
+                    picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -621,9 +623,9 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width,
-               p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height,
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -638,8 +640,8 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -658,7 +660,7 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -709,7 +711,7 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -765,7 +767,7 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -820,7 +822,8 @@ void I420_A8R8G8B8( filter_t *p_filter, picture_t *p_src,
 }
 
 VLC_TARGET
-void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src,
+                    picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -860,9 +863,9 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -877,8 +880,8 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -897,7 +900,7 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -948,7 +951,7 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1004,7 +1007,7 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -1059,7 +1062,8 @@ void I420_R8G8B8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src,
+                    picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -1099,9 +1103,9 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -1116,8 +1120,8 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -1136,7 +1140,7 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1187,7 +1191,7 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1243,7 +1247,7 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
@@ -1298,7 +1302,8 @@ void I420_B8G8R8A8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 }
 
 VLC_TARGET
-void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src,
+                    picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -1338,9 +1343,9 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * on a picture of size (x2,y2) with aspect ratio r2, if x1 grows to x1'
      * then y1 grows to y1' = x1' * y2/x2 * r2/r1 */
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     if(b_hscale &&
@@ -1355,8 +1360,8 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
+                    i_pic_height :
+                    i_height;
 
 #ifdef SSE2
 
@@ -1375,7 +1380,7 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
                     ((intptr_t)p_buffer))) )
     {
         /* use faster SSE2 aligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1426,7 +1431,7 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     else
     {
         /* use slower SSE2 unaligned fetch and store */
-        for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+        for( i_y = 0; i_y < i_height; i_y++ )
         {
             p_pic_start = p_pic;
 
@@ -1482,7 +1487,7 @@ void I420_A8B8G8R8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
 
     i_rewind = (-(p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width)) & 7;
 
-    for( i_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+    for( i_y = 0; i_y < i_height; i_y++ )
     {
         p_pic_start = p_pic;
         p_buffer = b_hscale ? p_buffer_start : p_pic;
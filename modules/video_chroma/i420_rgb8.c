@@ -40,7 +40,8 @@ static void SetOffset( int, int, int, int, bool *, int *, int * );
 /*****************************************************************************
  * I420_RGB8: color YUV 4:2:0 to RGB 8 bpp
  *****************************************************************************/
-void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
+void I420_RGB8( filter_t *p_filter, picture_t *p_src,
+                picture_t *p_dest, unsigned i_height, unsigned i_pic_height )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -84,9 +85,9 @@ void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
     static const int dither23[4] = { 0x1e,  0xe, 0x1a,  0xa };
 
     SetOffset( (p_filter->fmt_in.video.i_x_offset + p_filter->fmt_in.video.i_visible_width),
-               (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height),
+               i_height,
                (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width),
-               (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height),
+               i_pic_height,
                &b_hscale, &i_vscale, p_offset_start );
 
     i_right_margin = p_dest->p->i_pitch - p_dest->p->i_visible_pitch;
@@ -95,9 +96,9 @@ void I420_RGB8( filter_t *p_filter, picture_t *p_src, picture_t *p_dest )
      * Perform conversion
      */
     i_scale_count = ( i_vscale == 1 ) ?
-                    (p_filter->fmt_out.video.i_y_offset + p_filter->fmt_out.video.i_visible_height) :
-                    (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height);
-    for( i_y = 0, i_real_y = 0; i_y < (p_filter->fmt_in.video.i_y_offset + p_filter->fmt_in.video.i_visible_height); i_y++ )
+                    i_pic_height :
+                    i_height;
+    for( i_y = 0, i_real_y = 0; i_y < i_height; i_y++ )
     {
         /* Do horizontal and vertical scaling */
         SCALE_WIDTH_DITHER( 420 );
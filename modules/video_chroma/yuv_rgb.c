@@ -0,0 +1,733 @@
+/*****************************************************************************
+ * yuv_rgb.c : SIMD YUV 4:2:0 to 32-bit RGB conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+#include <vlc_slice.h>
+
+#if defined (HAVE_SSE2_INTRINSICS) || defined (HAVE_AVX2_INTRINSICS)
+# include <immintrin.h>
+#endif
+
+/*
+ * All conversions share the same 16-bit fixed point arithmetic, so that the
+ * plain C and the SIMD versions give the same results:
+ *  - samples are first scaled to 14 bits, whatever their depth,
+ *  - luma, minus the black level, is doubled and multiplied by a Q14 gain,
+ *  - chroma, minus the mid level, is quadrupled and multiplied by Q13 gains,
+ *  - products keep their high 16 bits, which leaves 13-bit RGB values.
+ * Chroma is not interpolated: each sample covers 2x2 pixels.
+ */
+
+/* Input sample layouts */
+enum
+{
+    LAYOUT_I420,    /* 8-bit planar */
+    LAYOUT_NV12,    /* 8-bit semi-planar */
+    LAYOUT_I420_10, /* 10-bit planar, in the low bits */
+    LAYOUT_P010,    /* 10-bit semi-planar, in the high bits */
+    LAYOUT_COUNT
+};
+
+struct yuv_rgb_coefs
+{
+    int16_t y_off;  /**< Black level, 14-bit scale */
+    int16_t y_mul;  /**< Luma gain, Q14 */
+    int16_t rv;     /**< V contribution to R, Q13 */
+    int16_t gu;     /**< U contribution to G (subtracted), Q13 */
+    int16_t gv;     /**< V contribution to G (subtracted), Q13 */
+    int16_t bu;     /**< U contribution to B, Q13 */
+    bool    rgba;   /**< R,G,B,A byte order instead of B,G,R,A */
+};
+
+/**
+ * Converts pixels x to width - 1 of a line.
+ *
+ * @param dst first pixel of the RGB line
+ * @param src first sample of the luma and chroma lines (for semi-planar
+ *            layouts, src[1] is the interleaved chroma line)
+ */
+typedef void (*yuv_rgb_row_t)(const struct yuv_rgb_coefs *, uint8_t *dst,
+                              const uint8_t *const src[3],
+                              unsigned x, unsigned width);
+
+typedef struct
+{
+    struct yuv_rgb_coefs coefs;
+    yuv_rgb_row_t        row;
+    bool                 swap_uv;
+    vlc_slice_pool_t    *slices;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Plain C
+ *****************************************************************************/
+static inline int Sample14(const uint8_t *line, unsigned i, int layout)
+{
+    switch (layout)
+    {
+        case LAYOUT_I420:
+        case LAYOUT_NV12:
+            return line[i] << 6;
+        case LAYOUT_I420_10:
+            return (((const uint16_t *)line)[i] & 0x3ff) << 4;
+        default:
+            return ((const uint16_t *)line)[i] >> 2;
+    }
+}
+
+static inline uint8_t Clip8(int v)
+{
+    v = (v + 16) >> 5;
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline void C_Row(const struct yuv_rgb_coefs *c, uint8_t *dst,
+                         const uint8_t *const src[3], unsigned x,
+                         unsigned width, int layout)
+{
+    const bool planar = layout == LAYOUT_I420 || layout == LAYOUT_I420_10;
+
+    for (; x < width; x++)
+    {
+        const unsigned cx = x / 2;
+        int u, v;
+
+        if (planar)
+        {
+            u = Sample14(src[1], cx, layout);
+            v = Sample14(src[2], cx, layout);
+        }
+        else
+        {
+            u = Sample14(src[1], 2 * cx, layout);
+            v = Sample14(src[1], 2 * cx + 1, layout);
+        }
+
+        int y = (Sample14(src[0], x, layout) - c->y_off) * 2;
+        y = (y * c->y_mul) >> 16;
+        u = (u - 8192) * 4;
+        v = (v - 8192) * 4;
+
+        const int r = y + ((v * c->rv) >> 16);
+        const int g = y - (((u * c->gu) >> 16) + ((v * c->gv) >> 16));
+        const int b = y + ((u * c->bu) >> 16);
+        uint8_t *px = &dst[4 * x];
+
+        px[c->rgba ? 0 : 2] = Clip8(r);
+        px[1] = Clip8(g);
+        px[c->rgba ? 2 : 0] = Clip8(b);
+        px[3] = 0xff;
+    }
+}
+
+#define DECLARE_ROWS(isa, attr) \
+attr static void isa##_I420(const struct yuv_rgb_coefs *c, uint8_t *dst, \
+                            const uint8_t *const src[3], \
+                            unsigned x, unsigned width) \
+{ \
+    isa##_Row(c, dst, src, x, width, LAYOUT_I420); \
+} \
+attr static void isa##_NV12(const struct yuv_rgb_coefs *c, uint8_t *dst, \
+                            const uint8_t *const src[3], \
+                            unsigned x, unsigned width) \
+{ \
+    isa##_Row(c, dst, src, x, width, LAYOUT_NV12); \
+} \
+attr static void isa##_I420_10(const struct yuv_rgb_coefs *c, uint8_t *dst, \
+                               const uint8_t *const src[3], \
+                               unsigned x, unsigned width) \
+{ \
+    isa##_Row(c, dst, src, x, width, LAYOUT_I420_10); \
+} \
+attr static void isa##_P010(const struct yuv_rgb_coefs *c, uint8_t *dst, \
+                            const uint8_t *const src[3], \
+                            unsigned x, unsigned width) \
+{ \
+    isa##_Row(c, dst, src, x, width, LAYOUT_P010); \
+} \
+static const yuv_rgb_row_t isa##_rows[LAYOUT_COUNT] = { \
+    isa##_I420, isa##_NV12, isa##_I420_10, isa##_P010, \
+};
+
+DECLARE_ROWS(C, )
+
+/*****************************************************************************
+ * SSE2: 16 pixels at once
+ *****************************************************************************/
+#ifdef HAVE_SSE2_INTRINSICS
+#define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+
+VLC_SSE2
+static inline __m128i SSE2_Scale16(__m128i v, int layout)
+{
+    if (layout == LAYOUT_I420_10)
+        return _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x3ff)), 4);
+    return _mm_srli_epi16(v, 2);
+}
+
+/* Loads 16 luma samples, as 14-bit words */
+VLC_SSE2
+static inline void SSE2_LoadLuma(const uint8_t *line, unsigned x, int layout,
+                                 __m128i *lo, __m128i *hi)
+{
+    if (layout == LAYOUT_I420 || layout == LAYOUT_NV12)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i v = _mm_loadu_si128((const __m128i *)&line[x]);
+
+        *lo = _mm_slli_epi16(_mm_unpacklo_epi8(v, zero), 6);
+        *hi = _mm_slli_epi16(_mm_unpackhi_epi8(v, zero), 6);
+    }
+    else
+    {
+        const __m128i *p = (const __m128i *)&line[2 * x];
+
+        *lo = SSE2_Scale16(_mm_loadu_si128(p), layout);
+        *hi = SSE2_Scale16(_mm_loadu_si128(p + 1), layout);
+    }
+}
+
+/* Loads 8 chroma samples of each plane, as 14-bit words */
+VLC_SSE2
+static inline void SSE2_LoadChroma(const uint8_t *const src[3], unsigned cx,
+                                   int layout, __m128i *u, __m128i *v)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    switch (layout)
+    {
+        case LAYOUT_I420:
+            *u = _mm_loadl_epi64((const __m128i *)&src[1][cx]);
+            *v = _mm_loadl_epi64((const __m128i *)&src[2][cx]);
+            *u = _mm_slli_epi16(_mm_unpacklo_epi8(*u, zero), 6);
+            *v = _mm_slli_epi16(_mm_unpacklo_epi8(*v, zero), 6);
+            break;
+        case LAYOUT_NV12:
+        {
+            __m128i uv = _mm_loadu_si128((const __m128i *)&src[1][2 * cx]);
+
+            *u = _mm_slli_epi16(_mm_and_si128(uv, _mm_set1_epi16(0xff)), 6);
+            *v = _mm_slli_epi16(_mm_srli_epi16(uv, 8), 6);
+            break;
+        }
+        case LAYOUT_I420_10:
+            *u = SSE2_Scale16(_mm_loadu_si128((const __m128i *)&src[1][2 * cx]),
+                              layout);
+            *v = SSE2_Scale16(_mm_loadu_si128((const __m128i *)&src[2][2 * cx]),
+                              layout);
+            break;
+        default:
+        {
+            /* U in the low word, V in the high word of each dword */
+            const __m128i *p = (const __m128i *)&src[1][4 * cx];
+            __m128i a = _mm_loadu_si128(p), b = _mm_loadu_si128(p + 1);
+
+            *u = _mm_packs_epi32(_mm_srli_epi32(_mm_slli_epi32(a, 16), 18),
+                                 _mm_srli_epi32(_mm_slli_epi32(b, 16), 18));
+            *v = _mm_packs_epi32(_mm_srli_epi32(a, 18),
+                                 _mm_srli_epi32(b, 18));
+            break;
+        }
+    }
+}
+
+/* Rounds two vectors of 13-bit values to 8-bit */
+VLC_SSE2
+static inline __m128i SSE2_Pack(__m128i lo, __m128i hi)
+{
+    const __m128i round = _mm_set1_epi16(16);
+
+    lo = _mm_srai_epi16(_mm_adds_epi16(lo, round), 5);
+    hi = _mm_srai_epi16(_mm_adds_epi16(hi, round), 5);
+    return _mm_packus_epi16(lo, hi);
+}
+
+VLC_SSE2
+static inline void SSE2_Row(const struct yuv_rgb_coefs *c, uint8_t *dst,
+                            const uint8_t *const src[3], unsigned x,
+                            unsigned width, int layout)
+{
+    const __m128i y_off = _mm_set1_epi16(c->y_off);
+    const __m128i y_mul = _mm_set1_epi16(c->y_mul);
+    const __m128i c_off = _mm_set1_epi16(8192);
+    const __m128i rv = _mm_set1_epi16(c->rv);
+    const __m128i gu = _mm_set1_epi16(c->gu);
+    const __m128i gv = _mm_set1_epi16(c->gv);
+    const __m128i bu = _mm_set1_epi16(c->bu);
+    const __m128i alpha = _mm_set1_epi8(-1);
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i y0, y1, u, v;
+
+        SSE2_LoadLuma(src[0], x, layout, &y0, &y1);
+        SSE2_LoadChroma(src, x / 2, layout, &u, &v);
+
+        y0 = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y0, y_off), 1),
+                             y_mul);
+        y1 = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y1, y_off), 1),
+                             y_mul);
+        u = _mm_slli_epi16(_mm_sub_epi16(u, c_off), 2);
+        v = _mm_slli_epi16(_mm_sub_epi16(v, c_off), 2);
+
+        __m128i r = _mm_mulhi_epi16(v, rv);
+        __m128i g = _mm_adds_epi16(_mm_mulhi_epi16(u, gu),
+                                   _mm_mulhi_epi16(v, gv));
+        __m128i b = _mm_mulhi_epi16(u, bu);
+
+        /* Each chroma sample covers two pixels */
+        __m128i R = SSE2_Pack(_mm_adds_epi16(y0, _mm_unpacklo_epi16(r, r)),
+                              _mm_adds_epi16(y1, _mm_unpackhi_epi16(r, r)));
+        __m128i G = SSE2_Pack(_mm_subs_epi16(y0, _mm_unpacklo_epi16(g, g)),
+                              _mm_subs_epi16(y1, _mm_unpackhi_epi16(g, g)));
+        __m128i B = SSE2_Pack(_mm_adds_epi16(y0, _mm_unpacklo_epi16(b, b)),
+                              _mm_adds_epi16(y1, _mm_unpackhi_epi16(b, b)));
+        if (c->rgba)
+        {
+            __m128i t = R;
+            R = B;
+            B = t;
+        }
+
+        __m128i *out = (__m128i *)&dst[4 * x];
+        __m128i bg = _mm_unpacklo_epi8(B, G);
+        __m128i ra = _mm_unpacklo_epi8(R, alpha);
+
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg, ra));
+        bg = _mm_unpackhi_epi8(B, G);
+        ra = _mm_unpackhi_epi8(R, alpha);
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bg, ra));
+    }
+
+    C_Row(c, dst, src, x, width, layout);
+}
+
+DECLARE_ROWS(SSE2, VLC_SSE2)
+#endif /* HAVE_SSE2_INTRINSICS */
+
+/*****************************************************************************
+ * AVX2: 32 pixels at once
+ *****************************************************************************/
+#ifdef HAVE_AVX2_INTRINSICS
+#define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+
+VLC_AVX2
+static inline __m256i AVX2_Scale16(__m256i v, int layout)
+{
+    if (layout == LAYOUT_I420_10)
+        return _mm256_slli_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x3ff)),
+                                 4);
+    return _mm256_srli_epi16(v, 2);
+}
+
+VLC_AVX2
+static inline void AVX2_LoadLuma(const uint8_t *line, unsigned x, int layout,
+                                 __m256i *lo, __m256i *hi)
+{
+    if (layout == LAYOUT_I420 || layout == LAYOUT_NV12)
+    {
+        const __m128i *p = (const __m128i *)&line[x];
+
+        *lo = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p)), 6);
+        *hi = _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(p + 1)),
+                                6);
+    }
+    else
+    {
+        const __m256i *p = (const __m256i *)&line[2 * x];
+
+        *lo = AVX2_Scale16(_mm256_loadu_si256(p), layout);
+        *hi = AVX2_Scale16(_mm256_loadu_si256(p + 1), layout);
+    }
+}
+
+/* Loads 16 chroma samples of each plane, as 14-bit words, with the middle
+ * quadwords swapped: the in-lane unpacks then duplicate samples 0-7 in the
+ * low vector and samples 8-15 in the high one. */
+VLC_AVX2
+static inline void AVX2_LoadChroma(const uint8_t *const src[3], unsigned cx,
+                                   int layout, __m256i *u, __m256i *v)
+{
+    switch (layout)
+    {
+        case LAYOUT_I420:
+            *u = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128((const __m128i *)&src[1][cx]));
+            *v = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128((const __m128i *)&src[2][cx]));
+            *u = _mm256_slli_epi16(*u, 6);
+            *v = _mm256_slli_epi16(*v, 6);
+            break;
+        case LAYOUT_NV12:
+        {
+            __m256i uv = _mm256_loadu_si256((const __m256i *)&src[1][2 * cx]);
+
+            *u = _mm256_and_si256(uv, _mm256_set1_epi16(0xff));
+            *u = _mm256_slli_epi16(*u, 6);
+            *v = _mm256_slli_epi16(_mm256_srli_epi16(uv, 8), 6);
+            break;
+        }
+        case LAYOUT_I420_10:
+            *u = AVX2_Scale16(
+                    _mm256_loadu_si256((const __m256i *)&src[1][2 * cx]),
+                    layout);
+            *v = AVX2_Scale16(
+                    _mm256_loadu_si256((const __m256i *)&src[2][2 * cx]),
+                    layout);
+            break;
+        default:
+        {
+            const __m256i *p = (const __m256i *)&src[1][4 * cx];
+            __m256i a = _mm256_loadu_si256(p), b = _mm256_loadu_si256(p + 1);
+
+            /* The in-lane packs already swap the middle quadwords */
+            *u = _mm256_packs_epi32(
+                    _mm256_srli_epi32(_mm256_slli_epi32(a, 16), 18),
+                    _mm256_srli_epi32(_mm256_slli_epi32(b, 16), 18));
+            *v = _mm256_packs_epi32(_mm256_srli_epi32(a, 18),
+                                    _mm256_srli_epi32(b, 18));
+            return;
+        }
+    }
+    *u = _mm256_permute4x64_epi64(*u, _MM_SHUFFLE(3, 1, 2, 0));
+    *v = _mm256_permute4x64_epi64(*v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+VLC_AVX2
+static inline __m256i AVX2_Pack(__m256i lo, __m256i hi)
+{
+    const __m256i round = _mm256_set1_epi16(16);
+
+    lo = _mm256_srai_epi16(_mm256_adds_epi16(lo, round), 5);
+    hi = _mm256_srai_epi16(_mm256_adds_epi16(hi, round), 5);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+VLC_AVX2
+static inline void AVX2_Row(const struct yuv_rgb_coefs *c, uint8_t *dst,
+                            const uint8_t *const src[3], unsigned x,
+                            unsigned width, int layout)
+{
+    const __m256i y_off = _mm256_set1_epi16(c->y_off);
+    const __m256i y_mul = _mm256_set1_epi16(c->y_mul);
+    const __m256i c_off = _mm256_set1_epi16(8192);
+    const __m256i rv = _mm256_set1_epi16(c->rv);
+    const __m256i gu = _mm256_set1_epi16(c->gu);
+    const __m256i gv = _mm256_set1_epi16(c->gv);
+    const __m256i bu = _mm256_set1_epi16(c->bu);
+    const __m256i alpha = _mm256_set1_epi8(-1);
+
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i y0, y1, u, v;
+
+        AVX2_LoadLuma(src[0], x, layout, &y0, &y1);
+        AVX2_LoadChroma(src, x / 2, layout, &u, &v);
+
+        y0 = _mm256_sub_epi16(y0, y_off);
+        y1 = _mm256_sub_epi16(y1, y_off);
+        y0 = _mm256_mulhi_epi16(_mm256_slli_epi16(y0, 1), y_mul);
+        y1 = _mm256_mulhi_epi16(_mm256_slli_epi16(y1, 1), y_mul);
+        u = _mm256_slli_epi16(_mm256_sub_epi16(u, c_off), 2);
+        v = _mm256_slli_epi16(_mm256_sub_epi16(v, c_off), 2);
+
+        __m256i r = _mm256_mulhi_epi16(v, rv);
+        __m256i g = _mm256_adds_epi16(_mm256_mulhi_epi16(u, gu),
+                                      _mm256_mulhi_epi16(v, gv));
+        __m256i b = _mm256_mulhi_epi16(u, bu);
+
+        /* The packs interleave the two vectors by lanes: pixels 0-7 and
+         * 16-23 in the low lane, 8-15 and 24-31 in the high lane. */
+        __m256i R = AVX2_Pack(_mm256_adds_epi16(y0, _mm256_unpacklo_epi16(r, r)),
+                              _mm256_adds_epi16(y1, _mm256_unpackhi_epi16(r, r)));
+        __m256i G = AVX2_Pack(_mm256_subs_epi16(y0, _mm256_unpacklo_epi16(g, g)),
+                              _mm256_subs_epi16(y1, _mm256_unpackhi_epi16(g, g)));
+        __m256i B = AVX2_Pack(_mm256_adds_epi16(y0, _mm256_unpacklo_epi16(b, b)),
+                              _mm256_adds_epi16(y1, _mm256_unpackhi_epi16(b, b)));
+        if (c->rgba)
+        {
+            __m256i t = R;
+            R = B;
+            B = t;
+        }
+
+        __m256i *out = (__m256i *)&dst[4 * x];
+        __m256i bg = _mm256_unpacklo_epi8(B, G);
+        __m256i ra = _mm256_unpacklo_epi8(R, alpha);
+        __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+        __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+
+        _mm256_storeu_si256(out + 0, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+        bg = _mm256_unpackhi_epi8(B, G);
+        ra = _mm256_unpackhi_epi8(R, alpha);
+        lo = _mm256_unpacklo_epi16(bg, ra);
+        hi = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+
+    C_Row(c, dst, src, x, width, layout);
+}
+
+DECLARE_ROWS(AVX2, VLC_AVX2)
+#endif /* HAVE_AVX2_INTRINSICS */
+
+/*****************************************************************************
+ * Filter
+ *****************************************************************************/
+struct yuv_rgb_job
+{
+    const filter_sys_t *sys;
+    const picture_t *src;
+    picture_t *dst;
+    unsigned width;
+    unsigned height;
+};
+
+static void ConvertSlice(void *opaque, unsigned index, unsigned count)
+{
+    const struct yuv_rgb_job *job = opaque;
+    const filter_sys_t *sys = job->sys;
+    const plane_t *in = job->src->p;
+    const plane_t *out = &job->dst->p[0];
+    const int u = sys->swap_uv ? V_PLANE : U_PLANE;
+    const int v = sys->swap_uv ? U_PLANE : V_PLANE;
+    unsigned first, end;
+
+    /* Keep the line pairs sharing chroma in the same slice */
+    vlc_slice_GetRows(index, count, job->height, 2, &first, &end);
+
+    for (unsigned y = first; y < end; y++)
+    {
+        const uint8_t *src[3] = {
+            in[Y_PLANE].p_pixels + y * in[Y_PLANE].i_pitch,
+            in[u].p_pixels + (y / 2) * in[u].i_pitch,
+            job->src->i_planes > 2
+                ? in[v].p_pixels + (y / 2) * in[v].i_pitch : NULL,
+        };
+
+        sys->row(&sys->coefs, out->p_pixels + y * out->i_pitch, src,
+                 0, job->width);
+    }
+}
+
+static picture_t *Filter(filter_t *filter, picture_t *src)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const video_format_t *fmt = &filter->fmt_in.video;
+
+    picture_t *dst = filter_NewPicture(filter);
+    if (dst != NULL)
+    {
+        struct yuv_rgb_job job = {
+            sys, src, dst,
+            fmt->i_x_offset + fmt->i_visible_width,
+            fmt->i_y_offset + fmt->i_visible_height,
+        };
+
+        vlc_slice_dispatch(sys->slices,
+                           vlc_slice_pool_GetThreads(sys->slices),
+                           ConvertSlice, &job);
+        picture_CopyProperties(dst, src);
+    }
+    picture_Release(src);
+    return dst;
+}
+
+static void SetCoefs(struct yuv_rgb_coefs *c, video_color_space_t space,
+                     bool full_range, bool rgba)
+{
+    double kr, kb;
+
+    switch (space)
+    {
+        case COLOR_SPACE_BT601:
+            kr = 0.299;
+            kb = 0.114;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627;
+            kb = 0.0593;
+            break;
+        default:
+            kr = 0.2126;
+            kb = 0.0722;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    const double ys = full_range ? 1. : 255. / 219.;
+    const double cs = (full_range ? 1. : 255. / 224.) * (1 << 13);
+
+    c->y_off = full_range ? 0 : 16 << 6;
+    c->y_mul = lround(ys * (1 << 14));
+    c->rv = lround(2. * (1. - kr) * cs);
+    c->gu = lround(2. * (1. - kb) * kb / kg * cs);
+    c->gv = lround(2. * (1. - kr) * kr / kg * cs);
+    c->bu = lround(2. * (1. - kb) * cs);
+    c->rgba = rgba;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+    bool swap_uv = false, full_range = false, rgba;
+    int layout;
+
+    /* resizing not supported */
+    if (in->i_x_offset + in->i_visible_width !=
+            out->i_x_offset + out->i_visible_width
+     || in->i_y_offset + in->i_visible_height !=
+            out->i_y_offset + out->i_visible_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    switch (in->i_chroma)
+    {
+        case VLC_CODEC_YV12:
+            swap_uv = true;
+            /* fall through */
+        case VLC_CODEC_I420:
+            layout = LAYOUT_I420;
+            break;
+        case VLC_CODEC_J420:
+            layout = LAYOUT_I420;
+            full_range = true;
+            break;
+        case VLC_CODEC_NV12:
+            layout = LAYOUT_NV12;
+            break;
+#ifndef WORDS_BIGENDIAN
+        case VLC_CODEC_I420_10L:
+            layout = LAYOUT_I420_10;
+            break;
+        case VLC_CODEC_P010:
+            layout = LAYOUT_P010;
+            break;
+#endif
+        default:
+            return VLC_EGENERIC;
+    }
+
+    switch (out->i_chroma)
+    {
+        case VLC_CODEC_BGRA:
+            rgba = false;
+            break;
+        case VLC_CODEC_RGBA:
+            rgba = true;
+            break;
+#ifndef WORDS_BIGENDIAN
+        case VLC_CODEC_RGB32:
+        {
+            video_format_t fmt = *out;
+
+            video_format_FixRgb(&fmt);
+            if (fmt.i_rmask == 0x00ff0000 && fmt.i_gmask == 0x0000ff00
+             && fmt.i_bmask == 0x000000ff)
+                rgba = false;
+            else if (fmt.i_rmask == 0x000000ff && fmt.i_gmask == 0x0000ff00
+                  && fmt.i_bmask == 0x00ff0000)
+                rgba = true;
+            else
+                return VLC_EGENERIC;
+            break;
+        }
+#endif
+        default:
+            return VLC_EGENERIC;
+    }
+
+    if (in->color_range == COLOR_RANGE_FULL)
+        full_range = true;
+    else if (in->color_range == COLOR_RANGE_LIMITED)
+        full_range = false;
+
+    video_color_space_t space = in->space;
+    if (space == COLOR_SPACE_UNDEF)
+        space = in->i_visible_height > 576 ? COLOR_SPACE_BT709
+                                           : COLOR_SPACE_BT601;
+
+    filter_sys_t *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    SetCoefs(&sys->coefs, space, full_range, rgba);
+    sys->swap_uv = swap_uv;
+
+    const yuv_rgb_row_t *rows = C_rows;
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2())
+        rows = SSE2_rows;
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        rows = AVX2_rows;
+#endif
+    sys->row = rows[layout];
+    sys->slices = vlc_slice_pool_Inherit(filter);
+
+    msg_Dbg(filter, "%4.4s to %4.4s, %s range, %u thread(s)",
+            (const char *)&in->i_chroma, (const char *)&out->i_chroma,
+            full_range ? "full" : "limited",
+            vlc_slice_pool_GetThreads(sys->slices));
+
+    filter->p_sys = sys;
+    filter->pf_video_filter = Filter;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    filter_sys_t *sys = filter->p_sys;
+
+    if (sys->slices != NULL)
+        vlc_slice_pool_Delete(sys->slices);
+}
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+vlc_module_begin ()
+    set_description(N_("SIMD YUV 4:2:0 to RGB conversions"))
+    /* above swscale, which handles the rest */
+    set_capability("video converter", 160)
+    set_callbacks(Open, Close)
+vlc_module_end ()
@@ -32,6 +32,7 @@
 #include <vlc_cpu.h>
 #include <vlc_picture.h>
 #include <vlc_filter.h>
+#include <vlc_slice.h>
 
 #include "deinterlace.h" /* filter_sys_t  */
 #include "common.h"      /* FFMIN3 et al. */
@@ -46,6 +47,76 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+struct yadif_slice_ctx
+{
+    picture_t *p_dst;
+    const picture_t *p_prev, *p_cur, *p_next;
+    void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
+                   int w, int prefs, int mrefs, int parity, int mode);
+    int i_field;
+    int i_parity;
+};
+
+/* Filters the lines of one slice of each plane. Every line only depends on
+ * the source pictures, so slices are independent. */
+static void YadifSlice( void *opaque, unsigned i_slice, unsigned i_count )
+{
+    const struct yadif_slice_ctx *ctx = opaque;
+    picture_t *p_dst = ctx->p_dst;
+    const int i_field = ctx->i_field;
+    const int yadif_parity = ctx->i_parity;
+
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &p_dst->p[n];
+        unsigned i_first, i_end;
+
+        if( dstp->i_visible_lines < 3 )
+            continue;
+        vlc_slice_GetRows( i_slice, i_count, dstp->i_visible_lines - 2, 1,
+                           &i_first, &i_end );
+
+        for( int y = 1 + i_first; y < 1 + (int)i_end; y++ )
+        {
+            if( (y % 2) == i_field  ||  yadif_parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                ctx->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                             &prevp->p_pixels[y * prevp->i_pitch],
+                             &curp->p_pixels[y * curp->i_pitch],
+                             &nextp->p_pixels[y * nextp->i_pitch],
+                             dstp->i_visible_pitch,
+                             y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                             y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                             yadif_parity,
+                             mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -130,49 +201,14 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         if( p_sys->chroma->pixel_size == 2 )
             filter = yadif_filter_line_c_16bit;
 
-        for( int n = 0; n < p_dst->i_planes; n++ )
-        {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
+        struct yadif_slice_ctx ctx = {
+            .p_dst = p_dst, .p_prev = p_prev, .p_cur = p_cur, .p_next = p_next,
+            .filter = filter, .i_field = i_field, .i_parity = yadif_parity,
+        };
 
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
-        }
+        vlc_slice_dispatch( p_sys->p_slices,
+                            vlc_slice_pool_GetThreads( p_sys->p_slices ),
+                            YadifSlice, &ctx );
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
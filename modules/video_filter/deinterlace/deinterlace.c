@@ -535,6 +535,11 @@ notsupp:
     char *psz_mode = var_InheritString( p_filter, FILTER_CFG_PREFIX "mode" );
     SetFilterMethod( p_filter, psz_mode, packed );
 
+    p_sys->p_slices = NULL;
+    if( p_sys->context.pf_render_ordered == RenderYadif ||
+        p_sys->context.pf_render_single_pic == RenderYadifSingle )
+        p_sys->p_slices = vlc_slice_pool_Inherit( p_filter );
+
     IVTCClearState( p_filter );
 
 #if defined(CAN_COMPILE_C_ALTIVEC)
@@ -662,6 +667,10 @@ void Close( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t*)p_this;
 
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
-    free( p_filter->p_sys );
+    if( p_sys->p_slices != NULL )
+        vlc_slice_pool_Delete( p_sys->p_slices );
+    free( p_sys );
 }
@@ -34,6 +34,7 @@ struct vlc_object_t;
 
 #include <vlc_common.h>
 #include <vlc_mouse.h>
+#include <vlc_slice.h>
 
 /* Local algorithm headers */
 #include "algo_basic.h"
@@ -77,6 +78,9 @@ typedef struct
 
     struct deinterlace_ctx   context;
 
+    /** Threads splitting Yadif pictures by rows (NULL if not Yadif) */
+    vlc_slice_pool_t *p_slices;
+
     /* Algorithm-specific substructures */
     union {
         phosphor_sys_t phosphor; /**< Phosphor algorithm state. */
@@ -32,6 +32,7 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slice.h>
 #include "filter_picture.h"
 
 
@@ -95,8 +96,21 @@ typedef struct
     bool   b_recalc_coefs;
     vlc_mutex_t coefs_mutex;
     float  luma_spat, luma_temp, chroma_spat, chroma_temp;
+
+    /* Vertical strips filtered as a wavefront: each strip needs the
+     * horizontal filter state at the right edge of the previous one. */
+    vlc_slice_pool_t *slices;
+    unsigned int *border;        /* strip edge states, one column per strip */
+    unsigned     *progress;      /* lines done in each strip */
+    vlc_mutex_t   progress_lock;
+    vlc_cond_t    progress_wait;
 } filter_sys_t;
 
+/* Lines filtered between two synchronizations of the strips */
+#define STRIP_LINES 16
+/* Minimum strip width */
+#define STRIP_WIDTH 64
+
 /*****************************************************************************
  * Open
  *****************************************************************************/
@@ -143,6 +157,22 @@ static int Open(vlc_object_t *this)
         return VLC_ENOMEM;
     }
 
+    sys->slices = vlc_slice_pool_Inherit(filter);
+    unsigned strips = vlc_slice_pool_GetThreads(sys->slices);
+    sys->border = vlc_alloc((strips - 1) * sys->h[0], sizeof(unsigned int));
+    sys->progress = vlc_alloc(strips, sizeof(unsigned));
+    if (!sys->progress || (strips > 1 && !sys->border)) {
+        if (sys->slices)
+            vlc_slice_pool_Delete(sys->slices);
+        free(sys->progress);
+        free(sys->border);
+        free(cfg->Line);
+        free(sys);
+        return VLC_ENOMEM;
+    }
+    vlc_mutex_init(&sys->progress_lock);
+    vlc_cond_init(&sys->progress_wait);
+
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
@@ -183,9 +213,86 @@ static void Close(vlc_object_t *this)
         free(cfg->Frame[i]);
     }
     free(cfg->Line);
+    if (sys->slices)
+        vlc_slice_pool_Delete(sys->slices);
+    free(sys->progress);
+    free(sys->border);
     free(sys);
 }
 
+/*****************************************************************************
+ * Strips
+ *****************************************************************************/
+struct denoise_plane
+{
+    filter_sys_t *sys;
+    const plane_t *src;
+    plane_t *dst;
+    int plane;
+    int *Horizontal, *Vertical, *Temporal;
+};
+
+static void DenoiseStrip(void *opaque, unsigned strip, unsigned count)
+{
+    const struct denoise_plane *job = opaque;
+    filter_sys_t *sys = job->sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+    const int W = sys->w[job->plane], H = sys->h[job->plane];
+    const unsigned int *border_in = NULL;
+    unsigned int *border_out = NULL;
+    unsigned x0, x1;
+
+    vlc_slice_GetRows(strip, count, W, 16, &x0, &x1);
+    if (strip > 0 && (job->Horizontal[0] || job->Vertical[0]))
+        border_in = &sys->border[(strip - 1) * sys->h[0]];
+    if (strip + 1 < count)
+        border_out = &sys->border[strip * sys->h[0]];
+
+    for (int y0 = 0, y1; y0 < H; y0 = y1) {
+        y1 = __MIN(H, y0 + STRIP_LINES);
+
+        if (border_in) {
+            vlc_mutex_lock(&sys->progress_lock);
+            while (sys->progress[strip - 1] < (unsigned)y1)
+                vlc_cond_wait(&sys->progress_wait, &sys->progress_lock);
+            vlc_mutex_unlock(&sys->progress_lock);
+        }
+
+        deNoiseStrip(job->src->p_pixels, job->dst->p_pixels,
+                     cfg->Line, cfg->Frame[job->plane],
+                     W, x0, x1, y0, y1,
+                     job->src->i_pitch, job->dst->i_pitch,
+                     border_in, border_out,
+                     job->Horizontal, job->Vertical, job->Temporal);
+
+        if (border_out) {
+            vlc_mutex_lock(&sys->progress_lock);
+            sys->progress[strip] = y1;
+            vlc_cond_broadcast(&sys->progress_wait);
+            vlc_mutex_unlock(&sys->progress_lock);
+        }
+    }
+}
+
+static void DenoisePlane(filter_sys_t *sys, const picture_t *src,
+                         picture_t *dst, int plane,
+                         int *Horizontal, int *Vertical, int *Temporal)
+{
+    struct denoise_plane job = {
+        sys, &src->p[plane], &dst->p[plane], plane,
+        Horizontal, Vertical, Temporal,
+    };
+    unsigned strips = vlc_slice_pool_GetThreads(sys->slices);
+
+    if (strips > (unsigned)sys->w[plane] / STRIP_WIDTH)
+        strips = __MAX(sys->w[plane] / STRIP_WIDTH, 1);
+    for (unsigned i = 0; i < strips; i++)
+        sys->progress[i] = 0;
+
+    /* Strips start in order, so the previous one is always running */
+    vlc_slice_dispatch(sys->slices, strips, DenoiseStrip, &job);
+}
+
 /*****************************************************************************
  * Filter
  *****************************************************************************/
@@ -218,32 +325,20 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    for (int i = 0; i < 3; ++i) {
+        if (deNoiseInit(src->p[i].p_pixels, &cfg->Frame[i],
+                        sys->w[i], sys->h[i], src->p[i].i_pitch))
+        {
+            picture_Release( src );
+            picture_Release( dst );
+            return NULL;
+        }
     }
 
+    DenoisePlane(sys, src, dst, 0, cfg->Coefs[0], cfg->Coefs[0], cfg->Coefs[1]);
+    DenoisePlane(sys, src, dst, 1, cfg->Coefs[2], cfg->Coefs[2], cfg->Coefs[3]);
+    DenoisePlane(sys, src, dst, 2, cfg->Coefs[2], cfg->Coefs[2], cfg->Coefs[3]);
+
     return CopyInfoAndRelease(dst, src);
 }
 
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <stdbool.h>
 
 #define PARAM1_DEFAULT 4.0
 #define PARAM2_DEFAULT 3.0
@@ -46,131 +47,97 @@ static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int Cur
     return CurrMul + Coef[d];
 }
 
-static void deNoiseTemporal(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
-                    int *Temporal)
+static int deNoiseInit(const unsigned char *Frame,  // mpi->planes[x]
+                       unsigned short **FrameAntPtr,
+                       int W, int H, int sStride)
 {
-    unsigned int PixelDst;
-
-    for (long Y = 0; Y < H; Y++){
-        for (long X = 0; X < W; X++){
-            PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
-            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-        }
-        Frame += sStride;
-        FrameDest += dStride;
-        FrameAnt += W;
-    }
-}
-
-static void deNoiseSpacial(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical)
-{
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
-
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
-
-    for (long Y = 1; Y < H; Y++){
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
-        }
-    }
-}
-
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
-{
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
     unsigned short* FrameAnt=(*FrameAntPtr);
 
     if(!FrameAnt){
         (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
         if(!FrameAnt)
-            return;
+            return -1;
         for (long Y = 0; Y < H; Y++){
             unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
+            const unsigned char* src=Frame+Y*sStride;
             for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
         }
     }
+    return 0;
+}
 
-    if(!Horizontal[0] && !Vertical[0]){
-        deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
-        return;
-    }
-    if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
-        return;
+static inline void deNoiseStore(unsigned char *FrameDest,
+                                unsigned short *LinePrev,
+                                unsigned int Pixel, int *Temporal)
+{
+    if(Temporal){
+        Pixel = LowPassMul(*LinePrev<<8, Pixel, Temporal);
+        *LinePrev = ((Pixel+0x1000007F)>>8);
     }
+    *FrameDest = ((Pixel+0x10007FFF)>>16);
+}
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (long X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
+/*
+ * Denoises the columns X0 to X1 (excluded) of the lines Y0 to Y1 (excluded).
+ *
+ * The spatial filter is recursive both ways: the previous line state of each
+ * column is kept in LineAnt, and the state of the previous pixel on the left
+ * of the first column comes from BorderIn. The state after the last column
+ * is stored in BorderOut, for the next strip. A full line is one strip with
+ * NULL borders.
+ */
+static void deNoiseStrip(const unsigned char *Frame,  // mpi->planes[x]
+                         unsigned char *FrameDest,    // dmpi->planes[x]
+                         unsigned int *LineAnt,       // vf->priv->Line
+                         unsigned short *FrameAnt,
+                         int W, int X0, int X1, int Y0, int Y1,
+                         int sStride, int dStride,
+                         const unsigned int *BorderIn, unsigned int *BorderOut,
+                         int *Horizontal, int *Vertical, int *Temporal)
+{
+    /* Without spatial filtering, the temporal filter is always applied. */
+    const bool Spatial = Horizontal[0] || Vertical[0];
+    if(Spatial && !Temporal[0])
+        Temporal = NULL;
+
+    for (long Y = Y0; Y < Y1; Y++){
+        const unsigned char *Src = Frame + Y*sStride;
+        unsigned char *Dst = FrameDest + Y*dStride;
+        unsigned short *LinePrev = FrameAnt + Y*W;
+        unsigned int PixelAnt;
+        long X = X0;
+
+        if(!Spatial){
+            for (; X < X1; X++)
+                deNoiseStore(&Dst[X], &LinePrev[X], Src[X]<<16, Temporal);
+            continue;
+        }
 
-    for (long Y = 1; Y < H; Y++){
-        unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            PixelDst = LowPassMul(LinePrev[X]<<8, LineAnt[X], Temporal);
-            LinePrev[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
+        if(X == 0){
+            /* First pixel on each line doesn't have previous pixel */
+            PixelAnt = Src[0]<<16;
+            /* First line has no top neighbor */
+            LineAnt[0] = Y ? LowPassMul(LineAnt[0], PixelAnt, Vertical)
+                           : PixelAnt;
+            deNoiseStore(&Dst[0], &LinePrev[0], LineAnt[0], Temporal);
+            X++;
+        }else
+            PixelAnt = BorderIn[Y];
+
+        /* The spatial only first line always uses the first pixel as the
+         * left neighbor. */
+        const bool KeepAnt = Y == 0 && !Temporal;
+
+        for (; X < X1; X++){
+            unsigned int Pixel = LowPassMul(PixelAnt, Src[X]<<16, Horizontal);
+            if(!KeepAnt)
+                PixelAnt = Pixel;
+            LineAnt[X] = Y ? LowPassMul(LineAnt[X], Pixel, Vertical) : Pixel;
+            deNoiseStore(&Dst[X], &LinePrev[X], LineAnt[X], Temporal);
         }
+
+        if(BorderOut)
+            BorderOut[Y] = PixelAnt;
     }
 }
 
@@ -36,6 +36,13 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#ifndef _WIN32
+#  include <sys/uio.h>
+#else
+#  include <io.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -84,6 +91,7 @@ typedef struct attribute_packed
     es_out_id_t *p_es;
     block_t *p_block;
     int     i_offset;  /* We do not use file > INT_MAX */
+    int     i_size;    /* Record size in the file */
 } ts_cmd_send_t;
 
 typedef struct attribute_packed
@@ -172,19 +180,57 @@ typedef struct attribute_packed
     } u;
 } ts_cmd_t;
 
+/* Header of a block in a storage file, followed by the block data */
+typedef struct attribute_packed
+{
+    vlc_tick_t i_dts;
+    vlc_tick_t i_pts;
+    vlc_tick_t i_length;
+    uint32_t   i_flags;
+    uint32_t   i_nb_samples;
+    uint32_t   i_buffer;
+} ts_record_t;
+
+/* The records are written by batches, at most every TS_WRITE_RECORDS blocks
+ * or TS_WRITE_SIZE bytes, each full batch ending on a TS_WRITE_ALIGN
+ * boundary */
+#define TS_WRITE_RECORDS 128
+#define TS_WRITE_SIZE (1024*1024)
+#define TS_WRITE_ALIGN 4096
+
+/* The reader thread reads up to this amount of data ahead */
+#define TS_PREFETCH_SIZE (8*1024*1024)
+
+#ifndef IOV_MAX
+#   define IOV_MAX 16
+#endif
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
     ts_storage_t *p_next;
 
     /* */
+    bool    b_memory;   /* Blocks are kept in memory, not in a file */
 #ifdef _WIN32
     char    *psz_file;  /* Filename */
 #endif
     size_t  i_file_max; /* Max size in bytes */
     int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    int64_t i_file_written; /* Size in bytes already written */
+    bool    b_failed;   /* A write failed, the file is not written anymore */
+    int     i_fd_w;     /* File descriptor for data writing */
+    int     i_fd_r;     /* File descriptor for data reading */
+
+    /* Records not written yet */
+    int         i_pending;
+    ts_record_t p_records[TS_WRITE_RECORDS];
+    block_t     *pp_pending[TS_WRITE_RECORDS];
+
+    /* Read ahead */
+    bool    b_reading;      /* The reader thread uses the file */
+    int     i_cmd_prefetch; /* Next command to read ahead */
+    int64_t i_prefetched;   /* Bytes read ahead */
 
     /* */
     int      i_cmd_r;
@@ -200,11 +246,15 @@ typedef struct
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
     const char     *psz_tmp_path;
+    int64_t        i_mem_size_max;
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
     vlc_cond_t     wait;
 
+    /* Memory reserved by the memory storages */
+    int64_t        i_mem_size;
+
     /* */
     bool           b_paused;
     vlc_tick_t     i_pause_date;
@@ -224,6 +274,12 @@ typedef struct
 
     vlc_tick_t     i_cmd_delay;
 
+    /* Reader thread, reading the storage files ahead */
+    vlc_thread_t   reader;
+    vlc_cond_t     wait_reader;
+    bool           b_reader;
+    bool           b_reader_exit;
+
 } ts_thread_t;
 
 struct es_out_id_t
@@ -239,6 +295,7 @@ typedef struct
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
     char           *psz_tmp_path;     /* Path for temporary files */
+    int64_t        i_mem_size_max;    /* Maximal memory storage size in byte */
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -273,15 +330,23 @@ static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
 static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
 
+static ts_storage_t *TsNewStorage( ts_thread_t * );
+static void         TsDeleteStorage( ts_thread_t *, ts_storage_t * );
+
 static void         *TsRun( void * );
+static void         *TsReadRun( void * );
 
-static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max,
+                                   bool b_memory );
 static void         TsStorageDelete( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
-static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
+static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static void         TsStorageFlush( ts_storage_t *, bool b_align );
+static block_t      *TsStorageReadBlock( ts_storage_t *, const ts_cmd_send_t * );
+static bool         TsStorageGetPrefetch( ts_storage_t *, int *pi_cmd );
 
 static void CmdClean( ts_cmd_t * );
 static void cmd_cleanup_routine( void *p ) { CmdClean( p ); }
@@ -344,6 +409,12 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    const int64_t i_mem_size_max = var_InheritInteger( p_input, "input-timeshift-memory" );
+    p_sys->i_mem_size_max = __MAX( i_mem_size_max, 0 ) * 1024 * 1024;
+    if( p_sys->i_mem_size_max > 0 )
+        msg_Dbg( p_input, "using up to %"PRId64" MiB of memory for timeshift",
+                 i_mem_size_max );
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !VLC_WINSTORE_APP
     if( p_sys->psz_tmp_path == NULL )
@@ -878,6 +949,8 @@ static int TsStart( es_out_t *p_out )
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
+    p_ts->i_mem_size_max = p_sys->i_mem_size_max;
+    p_ts->i_mem_size = 0;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
     vlc_mutex_init( &p_ts->lock );
@@ -892,6 +965,8 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    vlc_cond_init( &p_ts->wait_reader );
+    p_ts->b_reader_exit = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -904,6 +979,12 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
     }
 
+    /* Without the reader thread, the files are read on demand */
+    p_ts->b_reader = !vlc_clone( &p_ts->reader, TsReadRun, p_ts,
+                                 VLC_THREAD_PRIORITY_INPUT );
+    if( !p_ts->b_reader )
+        msg_Warn( p_sys->p_input, "cannot create timeshift reader thread" );
+
     return VLC_SUCCESS;
 }
 static void TsAutoStop( es_out_t *p_out )
@@ -923,6 +1004,15 @@ static void TsStop( ts_thread_t *p_ts )
     vlc_cancel( p_ts->thread );
     vlc_join( p_ts->thread, NULL );
 
+    if( p_ts->b_reader )
+    {
+        vlc_mutex_lock( &p_ts->lock );
+        p_ts->b_reader_exit = true;
+        vlc_cond_signal( &p_ts->wait_reader );
+        vlc_mutex_unlock( &p_ts->lock );
+        vlc_join( p_ts->reader, NULL );
+    }
+
     vlc_mutex_lock( &p_ts->lock );
     for( ;; )
     {
@@ -935,18 +1025,43 @@ static void TsStop( ts_thread_t *p_ts )
     }
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
     if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+        TsDeleteStorage( p_ts, p_ts->p_storage_r );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
 }
+static ts_storage_t *TsNewStorage( ts_thread_t *p_ts )
+{
+    /* Keep the data in memory while the budget allows it, then spill the
+     * following storages to temporary files */
+    int64_t i_size = __MIN( p_ts->i_tmp_size_max,
+                            p_ts->i_mem_size_max - p_ts->i_mem_size );
+    if( i_size >= 1*1024*1024 )
+    {
+        ts_storage_t *p_storage = TsStorageNew( NULL, i_size, true );
+        if( p_storage )
+        {
+            p_ts->i_mem_size += i_size;
+            return p_storage;
+        }
+    }
+    return TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max, false );
+}
+static void TsDeleteStorage( ts_thread_t *p_ts, ts_storage_t *p_storage )
+{
+    while( p_storage->b_reading )
+        vlc_cond_wait( &p_ts->wait_reader, &p_ts->lock );
+    if( p_storage->b_memory )
+        p_ts->i_mem_size -= p_storage->i_file_max;
+    TsStorageDelete( p_storage );
+}
 static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        ts_storage_t *p_storage = TsNewStorage( p_ts );
 
         if( !p_storage )
         {
@@ -962,16 +1077,21 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
         }
         else
         {
+            if( p_ts->p_storage_w->b_memory )
+                p_ts->i_mem_size -= p_ts->p_storage_w->i_file_max;
             TsStoragePack( p_ts->p_storage_w );
+            if( p_ts->p_storage_w->b_memory )
+                p_ts->i_mem_size += p_ts->p_storage_w->i_file_max;
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
         }
     }
 
     /* TODO return error and warn the user (but only once) */
-    TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
+    TsStoragePushCmd( p_ts->p_storage_w, p_cmd );
 
     vlc_cond_signal( &p_ts->wait );
+    vlc_cond_signal( &p_ts->wait_reader );
 
     vlc_mutex_unlock( &p_ts->lock );
 }
@@ -983,6 +1103,7 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         return VLC_EGENERIC;
 
     TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+    vlc_cond_signal( &p_ts->wait_reader );
 
     while( TsStorageIsEmpty( p_ts->p_storage_r ) )
     {
@@ -990,7 +1111,7 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         if( !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
+        TsDeleteStorage( p_ts, p_ts->p_storage_r );
         p_ts->p_storage_r = p_next;
     }
 
@@ -1187,15 +1308,80 @@ static void *TsRun( void *p_data )
     return NULL;
 }
 
+static void *TsReadRun( void *p_data )
+{
+    ts_thread_t *p_ts = p_data;
+
+    vlc_mutex_lock( &p_ts->lock );
+    while( !p_ts->b_reader_exit )
+    {
+        ts_storage_t *p_storage = NULL;
+        int64_t i_prefetched = 0;
+        int i_cmd;
+
+        for( ts_storage_t *p = p_ts->p_storage_r; p; p = p->p_next )
+            i_prefetched += p->i_prefetched;
+
+        if( i_prefetched < TS_PREFETCH_SIZE )
+        {
+            for( p_storage = p_ts->p_storage_r; p_storage;
+                 p_storage = p_storage->p_next )
+                if( TsStorageGetPrefetch( p_storage, &i_cmd ) )
+                    break;
+        }
+        if( !p_storage )
+        {
+            vlc_cond_wait( &p_ts->wait_reader, &p_ts->lock );
+            continue;
+        }
+
+        /* The storage is not deleted while it is being read */
+        const ts_cmd_send_t send = p_storage->p_cmd[i_cmd].u.send;
+        p_storage->b_reading = true;
+        vlc_mutex_unlock( &p_ts->lock );
+
+        block_t *p_block = TsStorageReadBlock( p_storage, &send );
+
+        vlc_mutex_lock( &p_ts->lock );
+        p_storage->b_reading = false;
+        vlc_cond_broadcast( &p_ts->wait_reader );
+
+        if( !p_block )
+            continue;
+        if( i_cmd >= p_storage->i_cmd_r )
+        {
+            p_storage->p_cmd[i_cmd].u.send.p_block = p_block;
+            p_storage->i_prefetched += p_block->i_buffer;
+        }
+        else /* Already read on demand */
+            block_Release( p_block );
+    }
+    vlc_mutex_unlock( &p_ts->lock );
+
+    return NULL;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
-static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
+static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max,
+                                   bool b_memory )
 {
     ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
     if( unlikely(p_storage == NULL) )
         return NULL;
 
+    p_storage->b_memory = b_memory;
+    if( b_memory )
+    {
+#ifdef _WIN32
+        p_storage->psz_file = NULL;
+#endif
+        p_storage->i_fd_w = -1;
+        p_storage->i_fd_r = -1;
+        goto init;
+    }
+
     char *psz_file;
     int fd = GetTmpFile( &psz_file, psz_tmp_path );
     if( fd == -1 )
@@ -1203,19 +1389,12 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         free( p_storage );
         return NULL;
     }
+    p_storage->i_fd_w = fd;
 
-    p_storage->p_filew = fdopen( fd, "w+b" );
-    if( p_storage->p_filew == NULL )
+    p_storage->i_fd_r = vlc_open( psz_file, O_RDONLY );
+    if( p_storage->i_fd_r == -1 )
     {
-        vlc_close( fd );
-        vlc_unlink( psz_file );
-        goto error;
-    }
-
-    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
-    if( p_storage->p_filer == NULL )
-    {
-        fclose( p_storage->p_filew );
+        vlc_close( p_storage->i_fd_w );
         vlc_unlink( psz_file );
         goto error;
     }
@@ -1226,11 +1405,19 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
 #else
     p_storage->psz_file = psz_file;
 #endif
+
+init:
     p_storage->p_next = NULL;
 
     /* */
     p_storage->i_file_max = i_tmp_size_max;
     p_storage->i_file_size = 0;
+    p_storage->i_file_written = 0;
+    p_storage->b_failed = false;
+    p_storage->i_pending = 0;
+    p_storage->b_reading = false;
+    p_storage->i_cmd_prefetch = 0;
+    p_storage->i_prefetched = 0;
 
     /* */
     p_storage->i_cmd_w = 0;
@@ -1253,6 +1440,8 @@ error:
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
+    assert( !p_storage->b_reading );
+
     while( p_storage->i_cmd_r < p_storage->i_cmd_w )
     {
         ts_cmd_t cmd;
@@ -1263,32 +1452,54 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd );
 
-    fclose( p_storage->p_filer );
-    fclose( p_storage->p_filew );
+    for( int i = 0; i < p_storage->i_pending; i++ )
+        block_Release( p_storage->pp_pending[i] );
+
+    if( !p_storage->b_memory )
+    {
+        vlc_close( p_storage->i_fd_r );
+        vlc_close( p_storage->i_fd_w );
 #ifdef _WIN32
-    vlc_unlink( p_storage->psz_file );
-    free( p_storage->psz_file );
+        vlc_unlink( p_storage->psz_file );
+        free( p_storage->psz_file );
 #endif
+    }
     free( p_storage );
 }
 
 static void TsStoragePack( ts_storage_t *p_storage )
 {
+    /* Nothing will be added anymore, the reader needs all the records */
+    if( !p_storage->b_memory )
+        TsStorageFlush( p_storage, false );
+
     /* Try to release a bit of memory */
     if( p_storage->i_cmd_w >= p_storage->i_cmd_max )
         return;
 
     p_storage->i_cmd_max = __MAX( p_storage->i_cmd_w, 1 );
 
+    /* A memory storage will not grow anymore */
+    if( p_storage->b_memory )
+        p_storage->i_file_max = p_storage->i_file_size;
+
     ts_cmd_t *p_new = realloc( p_storage->p_cmd, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) );
     if( p_new )
         p_storage->p_cmd = p_new;
 }
 static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
+    /* Switch to a new storage */
+    if( p_storage->b_failed )
+        return true;
     if( p_cmd && p_cmd->i_type == C_SEND && p_storage->i_cmd_w > 0 )
     {
-        size_t i_size = sizeof(*p_cmd->u.send.p_block) + p_cmd->u.send.p_block->i_buffer;
+        size_t i_size = p_cmd->u.send.p_block->i_buffer;
+
+        if( p_storage->b_memory )
+            i_size += sizeof(*p_cmd->u.send.p_block);
+        else
+            i_size += sizeof(ts_record_t);
 
         if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
             return true;
@@ -1299,38 +1510,202 @@ static bool TsStorageIsEmpty( ts_storage_t *p_storage )
 {
     return !p_storage || p_storage->i_cmd_r >= p_storage->i_cmd_w;
 }
-static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bool b_flush )
+static ssize_t TsWriteAt( int fd, const struct iovec *p_iov, int i_iov,
+                          int64_t i_offset )
 {
-    ts_cmd_t cmd = *p_cmd;
-
-    assert( !TsStorageIsFull( p_storage, p_cmd ) );
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)(intptr_t)_get_osfhandle( fd );
+    if( handle == INVALID_HANDLE_VALUE )
+        return -1;
 
-    if( cmd.i_type == C_SEND )
+    OVERLAPPED olap = { .Offset = i_offset, .OffsetHigh = (i_offset >> 32) };
+    DWORD i_written;
+    if( !WriteFile( handle, p_iov->iov_base, p_iov->iov_len, &i_written, &olap ) )
+        return -1;
+    (void) i_iov;
+    return i_written;
+#elif defined(HAVE_PWRITEV)
+    return pwritev( fd, p_iov, __MIN( i_iov, IOV_MAX ), i_offset );
+#else
+    (void) i_iov;
+    return pwrite( fd, p_iov->iov_base, p_iov->iov_len, i_offset );
+#endif
+}
+/* Writes at the given offset, so that a failure leaves the previous
+ * records untouched */
+static int TsWriteAll( int fd, struct iovec *p_iov, int i_iov, int64_t i_offset )
+{
+    while( i_iov > 0 )
     {
-        block_t *p_block = cmd.u.send.p_block;
-
-        cmd.u.send.p_block = NULL;
-        cmd.u.send.i_offset = ftell( p_storage->p_filew );
+        ssize_t i_ret = TsWriteAt( fd, p_iov, i_iov, i_offset );
+        if( i_ret < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            return VLC_EGENERIC;
+        }
+        if( i_ret == 0 && p_iov->iov_len > 0 )
+            return VLC_EGENERIC;
+        i_offset += i_ret;
 
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
+        /* Skip what was written */
+        while( i_iov > 0 && (size_t)i_ret >= p_iov->iov_len )
         {
-            block_Release( p_block );
-            return;
+            i_ret -= p_iov->iov_len;
+            p_iov++;
+            i_iov--;
         }
-        p_storage->i_file_size += sizeof(*p_block);
-        if( p_block->i_buffer > 0 )
+        if( i_iov > 0 )
         {
-            if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
-            {
-                block_Release( p_block );
-                return;
-            }
+            p_iov->iov_base = (char *)p_iov->iov_base + i_ret;
+            p_iov->iov_len -= i_ret;
         }
-        p_storage->i_file_size += p_block->i_buffer;
+    }
+    return VLC_SUCCESS;
+}
+static void TsStorageFlush( ts_storage_t *p_storage, bool b_align )
+{
+    static const uint8_t p_padding[TS_WRITE_ALIGN];
+    struct iovec iov[2 * TS_WRITE_RECORDS + 1];
+    int i_iov = 0;
+
+    if( p_storage->i_pending <= 0 )
+        return;
+    assert( !p_storage->b_failed );
+
+    for( int i = 0; i < p_storage->i_pending; i++ )
+    {
+        iov[i_iov].iov_base = &p_storage->p_records[i];
+        iov[i_iov++].iov_len = sizeof(p_storage->p_records[i]);
+        iov[i_iov].iov_base = p_storage->pp_pending[i]->p_buffer;
+        iov[i_iov++].iov_len = p_storage->pp_pending[i]->i_buffer;
+    }
+
+    /* Start the next write on a page boundary */
+    if( b_align )
+    {
+        size_t i_pad = -p_storage->i_file_size & (TS_WRITE_ALIGN - 1);
+        if( i_pad > 0 )
+        {
+            iov[i_iov].iov_base = (void *)p_padding;
+            iov[i_iov++].iov_len = i_pad;
+            p_storage->i_file_size += i_pad;
+        }
+    }
+
+    if( TsWriteAll( p_storage->i_fd_w, iov, i_iov,
+                    p_storage->i_file_written ) == VLC_SUCCESS )
+        p_storage->i_file_written = p_storage->i_file_size;
+    else
+    {
+        /* The pending records are lost, and fail to be read back: the next
+         * commands go to a new storage */
+        p_storage->b_failed = true;
+    }
+
+    for( int i = 0; i < p_storage->i_pending; i++ )
+        block_Release( p_storage->pp_pending[i] );
+    p_storage->i_pending = 0;
+}
+static ssize_t TsReadAt( int fd, void *p_buf, size_t i_size, int64_t i_offset )
+{
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)(intptr_t)_get_osfhandle( fd );
+    if( handle == INVALID_HANDLE_VALUE )
+        return -1;
+
+    OVERLAPPED olap = { .Offset = i_offset, .OffsetHigh = (i_offset >> 32) };
+    DWORD i_read;
+    if( !ReadFile( handle, p_buf, i_size, &i_read, &olap ) )
+        return -1;
+    return i_read;
+#else
+    size_t i_done = 0;
+
+    while( i_done < i_size )
+    {
+        ssize_t i_ret = pread( fd, (uint8_t *)p_buf + i_done, i_size - i_done,
+                               i_offset + i_done );
+        if( i_ret < 0 && errno == EINTR )
+            continue;
+        if( i_ret <= 0 )
+            return i_done > 0 ? (ssize_t)i_done : i_ret;
+        i_done += i_ret;
+    }
+    return i_done;
+#endif
+}
+static block_t *TsStorageReadBlock( ts_storage_t *p_storage,
+                                    const ts_cmd_send_t *p_send )
+{
+    const size_t i_size = p_send->i_size;
+    ts_record_t record;
+
+    if( i_size < sizeof(record) )
+        return NULL;
+
+    /* Read the record at once, its payload becomes the block data */
+    block_t *p_block = block_Alloc( i_size );
+    if( !p_block )
+        return NULL;
+
+    if( TsReadAt( p_storage->i_fd_r, p_block->p_buffer, i_size,
+                  p_send->i_offset ) != (ssize_t)i_size )
+    {
         block_Release( p_block );
+        return NULL;
+    }
 
-        if( b_flush )
-            fflush( p_storage->p_filew );
+    memcpy( &record, p_block->p_buffer, sizeof(record) );
+    if( record.i_buffer != i_size - sizeof(record) )
+    {
+        block_Release( p_block );
+        return NULL;
+    }
+
+    p_block->p_buffer    += sizeof(record);
+    p_block->i_buffer     = record.i_buffer;
+    p_block->i_dts        = record.i_dts;
+    p_block->i_pts        = record.i_pts;
+    p_block->i_flags      = record.i_flags;
+    p_block->i_length     = record.i_length;
+    p_block->i_nb_samples = record.i_nb_samples;
+    return p_block;
+}
+static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
+{
+    ts_cmd_t cmd = *p_cmd;
+
+    assert( !TsStorageIsFull( p_storage, p_cmd ) );
+
+    if( cmd.i_type == C_SEND && p_storage->b_memory )
+    {
+        /* The command keeps the block itself */
+        p_storage->i_file_size += sizeof(*cmd.u.send.p_block) +
+                                  cmd.u.send.p_block->i_buffer;
+    }
+    else if( cmd.i_type == C_SEND )
+    {
+        block_t *p_block = cmd.u.send.p_block;
+        ts_record_t *p_record = &p_storage->p_records[p_storage->i_pending];
+
+        /* The block is written later, along with the following ones */
+        p_record->i_dts        = p_block->i_dts;
+        p_record->i_pts        = p_block->i_pts;
+        p_record->i_length     = p_block->i_length;
+        p_record->i_flags      = p_block->i_flags;
+        p_record->i_nb_samples = p_block->i_nb_samples;
+        p_record->i_buffer     = p_block->i_buffer;
+        p_storage->pp_pending[p_storage->i_pending++] = p_block;
+
+        cmd.u.send.p_block = NULL;
+        cmd.u.send.i_offset = p_storage->i_file_size;
+        cmd.u.send.i_size = sizeof(*p_record) + p_block->i_buffer;
+        p_storage->i_file_size += cmd.u.send.i_size;
+
+        if( p_storage->i_pending >= TS_WRITE_RECORDS ||
+            p_storage->i_file_size - p_storage->i_file_written >= TS_WRITE_SIZE )
+            TsStorageFlush( p_storage, true );
     }
     p_storage->p_cmd[p_storage->i_cmd_w++] = cmd;
 }
@@ -1339,32 +1714,56 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     assert( !TsStorageIsEmpty( p_storage ) );
 
     *p_cmd = p_storage->p_cmd[p_storage->i_cmd_r++];
-    if( p_cmd->i_type == C_SEND )
+    if( p_cmd->i_type == C_SEND && !p_storage->b_memory )
     {
-        block_t block;
+        block_t *p_block = p_cmd->u.send.p_block;
 
-        if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->u.send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+        if( p_block )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
-            if( p_block )
-            {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
-            }
-            p_cmd->u.send.p_block = p_block;
+            /* Read ahead by the reader thread */
+            p_storage->i_prefetched -= p_block->i_buffer;
+        }
+        else if( !b_flush )
+        {
+            if( p_cmd->u.send.i_offset + p_cmd->u.send.i_size > p_storage->i_file_written )
+                TsStorageFlush( p_storage, false );
+            p_block = TsStorageReadBlock( p_storage, &p_cmd->u.send );
+            if( !p_block )
+                p_block = block_Alloc( 1 );
         }
         else
+            p_block = block_Alloc( 1 );
+
+        p_cmd->u.send.p_block = p_block;
+    }
+}
+static bool TsStorageGetPrefetch( ts_storage_t *p_storage, int *pi_cmd )
+{
+    if( p_storage->b_memory )
+        return false;
+
+    p_storage->i_cmd_prefetch = __MAX( p_storage->i_cmd_prefetch,
+                                       p_storage->i_cmd_r );
+    for( ; p_storage->i_cmd_prefetch < p_storage->i_cmd_w;
+         p_storage->i_cmd_prefetch++ )
+    {
+        const ts_cmd_send_t *p_send =
+            &p_storage->p_cmd[p_storage->i_cmd_prefetch].u.send;
+
+        if( p_storage->p_cmd[p_storage->i_cmd_prefetch].i_type != C_SEND )
+            continue;
+        /* Wait for the record to be written, unless it never will be */
+        if( p_send->i_offset + p_send->i_size > p_storage->i_file_written )
         {
-            //perror( "TsStoragePopCmd" );
-            p_cmd->u.send.p_block = block_Alloc( 1 );
+            if( p_storage->b_failed )
+                continue;
+            return false;
         }
+
+        *pi_cmd = p_storage->i_cmd_prefetch++;
+        return true;
     }
+    return false;
 }
 
 /*****************************************************************************
@@ -401,6 +401,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads used by each video filter or converter that can " \
+    "process a picture in slices (0 = number of CPU cores).")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -731,6 +736,11 @@ static const char *const ppsz_prefres[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_MEMORY_TEXT N_("Timeshift memory size")
+#define INPUT_TIMESHIFT_MEMORY_LONGTEXT N_( \
+    "Amount of memory in MiB used to store the timeshifted streams " \
+    "before the temporary files. 0 only uses temporary files." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -897,6 +907,21 @@ static const char *const ppsz_prefres[] = {
     "However allocation of port numbers below 1025 is usually restricted " \
     "by the operating system." )
 
+#define HTTP_THREADS_TEXT N_( "HTTP server threads" )
+#define HTTP_THREADS_LONGTEXT N_( \
+    "Number of threads serving the clients of each HTTP and RTSP server. " \
+    "Set to 0 to use one thread per CPU." )
+
+#define HTTP_STREAM_BUFFER_TEXT N_( "HTTP stream buffer (kB)" )
+#define HTTP_STREAM_BUFFER_LONGTEXT N_( \
+    "Amount of data kept for each HTTP output stream. All clients share " \
+    "it. Clients lagging by more than this amount skip data." )
+
+#define HTTP_STREAM_DROP_TEXT N_( "Drop slow HTTP stream clients" )
+#define HTTP_STREAM_DROP_LONGTEXT N_( \
+    "Disconnect the HTTP stream clients that lag by more than the stream " \
+    "buffer, instead of making them skip data." )
+
 #define HTTP_CERT_TEXT N_("HTTP/TLS server certificate")
 #define CERT_LONGTEXT N_( \
    "This X.509 certicate file (PEM format) is used for server-side TLS. " \
@@ -1764,6 +1789,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer_with_range( "filter-threads", 0, 0, 64,
+                            FILTER_THREADS_TEXT, FILTER_THREADS_LONGTEXT, true )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -1921,6 +1948,14 @@ vlc_module_begin ()
         change_integer_range( 1, 65535 )
     add_integer( "https-port", 8443, HTTPS_PORT_TEXT, HTTPS_PORT_LONGTEXT, true )
         change_integer_range( 1, 65535 )
+    add_integer( "http-threads", 1, HTTP_THREADS_TEXT,
+                 HTTP_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 64 )
+    add_integer( "http-stream-buffer", 5000, HTTP_STREAM_BUFFER_TEXT,
+                 HTTP_STREAM_BUFFER_LONGTEXT, true )
+        change_integer_range( 16, 1000000 )
+    add_bool( "http-stream-drop-slow", false, HTTP_STREAM_DROP_TEXT,
+              HTTP_STREAM_DROP_LONGTEXT, true )
     add_string( "rtsp-host", NULL, RTSP_HOST_TEXT, RTSP_HOST_LONGTEXT, true )
     add_integer( "rtsp-port", 554, RTSP_PORT_TEXT, RTSP_PORT_LONGTEXT, true )
         change_integer_range( 1, 65535 )
@@ -2050,6 +2085,9 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT, true )
+    add_integer( "input-timeshift-memory", 0, INPUT_TIMESHIFT_MEMORY_TEXT,
+                 INPUT_TIMESHIFT_MEMORY_LONGTEXT, true )
+        change_integer_range( 0, 65536 )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT, false );
 
@@ -120,7 +120,7 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
     uint32_t i_capabilities = 0;
 
 #if defined( __i386__ ) || defined( __x86_64__ )
-    unsigned int i_eax, i_ebx, i_ecx, i_edx;
+    unsigned int i_eax, i_ebx, i_ecx, i_edx, i_level;
     bool b_amd;
 
     /* Needed for x86 CPU capabilities detection */
@@ -130,15 +130,21 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
                   "cpuid\n\t" \
                   "xchgl %%ebx,%1\n\t" \
                   : "=a" (i_eax), "=r" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                  : "a" (reg) \
+                  : "a" (reg), "c" (0) \
                   : "cc");
 # else
 #  define cpuid(reg) \
     asm volatile ("cpuid\n\t" \
                   : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                  : "a" (reg) \
+                  : "a" (reg), "c" (0) \
                   : "cc");
 # endif
+    /* Reads the extended control register 0, i.e. the register states that
+     * the OS saves (opcode spelled out for older assemblers) */
+# define xgetbv() \
+    asm volatile (".byte 0x0f, 0x01, 0xd0\n\t" \
+                  : "=a" (i_eax), "=d" (i_edx) \
+                  : "c" (0));
      /* Check if the OS really supports the requested instructions */
 # if defined (__i386__) && !defined (__i486__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -165,6 +171,7 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
 
     /* the CPU supports the CPUID instruction - get its level */
     cpuid( 0x00000000 );
+    i_level = i_eax;
 
 # if defined (__i386__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -203,6 +210,31 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
             i_capabilities |= VLC_CPU_SSE4_1;
         if (i_ecx & 0x00100000)
             i_capabilities |= VLC_CPU_SSE4_2;
+
+        /* AVX needs the OS to save the YMM registers, AVX-512 also the
+         * opmask and ZMM registers: check OSXSAVE, then XCR0 */
+        if ((i_ecx & 0x18000000) == 0x18000000)
+        {
+            xgetbv();
+            const uint32_t i_xcr0 = i_eax;
+
+            if ((i_xcr0 & 0x06) == 0x06)
+            {
+                i_capabilities |= VLC_CPU_AVX;
+
+                if (i_level >= 7)
+                {
+                    /* structured extended features, subleaf 0 */
+                    cpuid( 0x00000007 );
+                    if (i_ebx & 0x00000020)
+                        i_capabilities |= VLC_CPU_AVX2;
+                    /* AVX-512 F and BW */
+                    if ((i_ebx & 0x40010000) == 0x40010000
+                     && (i_xcr0 & 0xe6) == 0xe6)
+                        i_capabilities |= VLC_CPU_AVX512;
+                }
+            }
+        }
     }
 
     /* test for additional capabilities */
@@ -291,6 +323,8 @@ void vlc_CPU_dump (vlc_object_t *obj)
         vlc_memstream_puts(&stream, "AVX ");
     if (vlc_CPU_AVX2())
         vlc_memstream_puts(&stream, "AVX2 ");
+    if (vlc_CPU_AVX512())
+        vlc_memstream_puts(&stream, "AVX-512 ");
     if (vlc_CPU_3dNOW())
         vlc_memstream_puts(&stream, "3DNow! ");
     if (vlc_CPU_XOP())
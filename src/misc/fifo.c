@@ -26,6 +26,8 @@
 #endif
 
 #include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
@@ -233,3 +235,277 @@ size_t block_FifoCount (block_fifo_t *fifo)
     vlc_mutex_unlock (&fifo->lock);
     return depth;
 }
+
+/**
+ * Single producer single consumer queue
+ *
+ * The queue is a list of segments of block pointers. The producer fills the
+ * tail segment, linking a new one when it is full; the consumer empties the
+ * head segment and hands it back for reuse when it is done with it. A NULL
+ * slot is not written yet, so neither side ever looks at the other's index.
+ */
+#define SPSC_SEGMENT_SIZE 63
+#define SPSC_CACHE_LINE 64
+
+struct vlc_spsc_segment
+{
+    _Atomic(block_t *) slots[SPSC_SEGMENT_SIZE];
+    _Atomic(struct vlc_spsc_segment *) next;
+};
+
+struct vlc_spsc_fifo
+{
+    /* Consumer side */
+    alignas (SPSC_CACHE_LINE)
+    struct vlc_spsc_segment *read_seg;
+    unsigned read_index;
+    atomic_size_t out_count;
+    atomic_size_t out_bytes;
+
+    /* Producer side */
+    alignas (SPSC_CACHE_LINE)
+    struct vlc_spsc_segment *write_seg;
+    unsigned write_index;
+    atomic_size_t in_count;
+    atomic_size_t in_bytes;
+
+    /* Shared */
+    alignas (SPSC_CACHE_LINE)
+    _Atomic(struct vlc_spsc_segment *) spare;
+    atomic_uint waiting; /**< Consumer sleeping (futex) */
+};
+
+static struct vlc_spsc_segment *vlc_spsc_segment_New(vlc_spsc_fifo_t *fifo)
+{
+    struct vlc_spsc_segment *seg =
+        atomic_exchange_explicit(&fifo->spare, NULL, memory_order_acquire);
+
+    if (seg == NULL)
+    {
+        seg = malloc(sizeof (*seg));
+        if (unlikely(seg == NULL))
+            return NULL;
+    }
+
+    for (unsigned i = 0; i < SPSC_SEGMENT_SIZE; i++)
+        atomic_init(&seg->slots[i], NULL);
+    atomic_init(&seg->next, NULL);
+    return seg;
+}
+
+vlc_spsc_fifo_t *vlc_spsc_fifo_New(void)
+{
+    vlc_spsc_fifo_t *fifo = aligned_alloc(SPSC_CACHE_LINE, sizeof (*fifo));
+    if (unlikely(fifo == NULL))
+        return NULL;
+
+    atomic_init(&fifo->spare, NULL);
+    fifo->read_seg = fifo->write_seg = vlc_spsc_segment_New(fifo);
+    if (unlikely(fifo->read_seg == NULL))
+    {
+        aligned_free(fifo);
+        return NULL;
+    }
+
+    fifo->read_index = fifo->write_index = 0;
+    atomic_init(&fifo->out_count, 0);
+    atomic_init(&fifo->out_bytes, 0);
+    atomic_init(&fifo->in_count, 0);
+    atomic_init(&fifo->in_bytes, 0);
+    atomic_init(&fifo->waiting, 0);
+    return fifo;
+}
+
+void vlc_spsc_fifo_Delete(vlc_spsc_fifo_t *fifo)
+{
+    block_ChainRelease(vlc_spsc_fifo_DequeueAll(fifo));
+
+    assert(fifo->read_seg == fifo->write_seg);
+    free(fifo->read_seg);
+    free(atomic_load_explicit(&fifo->spare, memory_order_relaxed));
+    aligned_free(fifo);
+}
+
+int vlc_spsc_fifo_Queue(vlc_spsc_fifo_t *fifo, block_t *block)
+{
+    size_t count = 0, bytes = 0;
+    int ret = VLC_SUCCESS;
+
+    if (block == NULL)
+        return VLC_SUCCESS;
+
+    for (block_t *b = block; b != NULL; b = b->p_next)
+    {
+        count++;
+        bytes += b->i_buffer;
+    }
+
+    /* Account before publishing, so that the counts never go negative */
+    atomic_store_explicit(&fifo->in_count, count +
+        atomic_load_explicit(&fifo->in_count, memory_order_relaxed),
+        memory_order_relaxed);
+    atomic_store_explicit(&fifo->in_bytes, bytes +
+        atomic_load_explicit(&fifo->in_bytes, memory_order_relaxed),
+        memory_order_relaxed);
+
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        if (fifo->write_index == SPSC_SEGMENT_SIZE)
+        {
+            struct vlc_spsc_segment *seg = vlc_spsc_segment_New(fifo);
+            if (unlikely(seg == NULL))
+            {
+                /* Take the lost blocks back out of the accounting */
+                count = bytes = 0;
+                for (block_t *b = block; b != NULL; b = b->p_next)
+                {
+                    count++;
+                    bytes += b->i_buffer;
+                }
+                atomic_store_explicit(&fifo->in_count,
+                    atomic_load_explicit(&fifo->in_count,
+                                         memory_order_relaxed) - count,
+                    memory_order_relaxed);
+                atomic_store_explicit(&fifo->in_bytes,
+                    atomic_load_explicit(&fifo->in_bytes,
+                                         memory_order_relaxed) - bytes,
+                    memory_order_relaxed);
+                block_ChainRelease(block);
+                ret = VLC_ENOMEM;
+                break;
+            }
+
+            atomic_store_explicit(&fifo->write_seg->next, seg,
+                                  memory_order_release);
+            fifo->write_seg = seg;
+            fifo->write_index = 0;
+        }
+
+        block->p_next = NULL;
+        atomic_store_explicit(&fifo->write_seg->slots[fifo->write_index++],
+                              block, memory_order_release);
+        block = next;
+    }
+
+    /* Pairs with the fence in vlc_spsc_fifo_Get(): either the consumer sees
+     * the new blocks, or we see that it is going to sleep. */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&fifo->waiting, memory_order_relaxed)
+     && atomic_exchange_explicit(&fifo->waiting, 0, memory_order_relaxed))
+        vlc_atomic_notify_one(&fifo->waiting);
+
+    return ret;
+}
+
+block_t *vlc_spsc_fifo_Dequeue(vlc_spsc_fifo_t *fifo)
+{
+    struct vlc_spsc_segment *seg = fifo->read_seg;
+
+    if (fifo->read_index == SPSC_SEGMENT_SIZE)
+    {
+        struct vlc_spsc_segment *next =
+            atomic_load_explicit(&seg->next, memory_order_acquire);
+        if (next == NULL)
+            return NULL;
+
+        /* The producer is done with this segment: recycle it */
+        free(atomic_exchange_explicit(&fifo->spare, seg,
+                                      memory_order_release));
+        fifo->read_seg = seg = next;
+        fifo->read_index = 0;
+    }
+
+    block_t *block = atomic_load_explicit(&seg->slots[fifo->read_index],
+                                          memory_order_acquire);
+    if (block == NULL)
+        return NULL;
+    fifo->read_index++;
+
+    atomic_store_explicit(&fifo->out_count, 1 +
+        atomic_load_explicit(&fifo->out_count, memory_order_relaxed),
+        memory_order_release);
+    atomic_store_explicit(&fifo->out_bytes, block->i_buffer +
+        atomic_load_explicit(&fifo->out_bytes, memory_order_relaxed),
+        memory_order_release);
+    return block;
+}
+
+block_t *vlc_spsc_fifo_DequeueAll(vlc_spsc_fifo_t *fifo)
+{
+    block_t *head = NULL, **pp = &head, *block;
+
+    while ((block = vlc_spsc_fifo_Dequeue(fifo)) != NULL)
+        block_ChainLastAppend(&pp, block);
+    return head;
+}
+
+/* The consumer waits while the flag has this value. vlc_cancel() sets the
+ * lowest bit of the registered address, so it must not be set. */
+#define SPSC_SLEEPING 2
+
+#if defined(_WIN32) || defined(__ANDROID__)
+/* There, vlc_atomic_wait() is not a cancellation point: as vlc_cond_wait()
+ * does, register the flag so that vlc_cancel() wakes the consumer up. */
+static void vlc_spsc_fifo_CancelClear(void *data)
+{
+    vlc_cancel_addr_clear(data);
+}
+
+static void vlc_spsc_fifo_Wait(vlc_spsc_fifo_t *fifo)
+{
+    vlc_cancel_addr_set(&fifo->waiting);
+    vlc_cleanup_push(vlc_spsc_fifo_CancelClear, &fifo->waiting);
+    /* Check if cancellation was pending before vlc_cancel_addr_set() */
+    vlc_testcancel();
+    vlc_atomic_wait(&fifo->waiting, SPSC_SLEEPING);
+    vlc_cleanup_pop();
+    vlc_cancel_addr_clear(&fifo->waiting);
+    vlc_testcancel();
+}
+#else
+static void vlc_spsc_fifo_Wait(vlc_spsc_fifo_t *fifo)
+{
+    vlc_atomic_wait(&fifo->waiting, SPSC_SLEEPING);
+}
+#endif
+
+block_t *vlc_spsc_fifo_Get(vlc_spsc_fifo_t *fifo)
+{
+    block_t *block;
+
+    vlc_testcancel();
+
+    while ((block = vlc_spsc_fifo_Dequeue(fifo)) == NULL)
+    {
+        atomic_store_explicit(&fifo->waiting, SPSC_SLEEPING,
+                              memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        block = vlc_spsc_fifo_Dequeue(fifo);
+        if (block != NULL)
+        {
+            atomic_store_explicit(&fifo->waiting, 0, memory_order_relaxed);
+            break;
+        }
+
+        /* Returns immediately if the producer has cleared the flag */
+        vlc_spsc_fifo_Wait(fifo);
+    }
+
+    return block;
+}
+
+size_t vlc_spsc_fifo_GetCount(const vlc_spsc_fifo_t *fifo)
+{
+    /* Outgoing first: it can never overtake the incoming count */
+    size_t out = atomic_load_explicit(&fifo->out_count, memory_order_acquire);
+    return atomic_load_explicit(&fifo->in_count, memory_order_relaxed) - out;
+}
+
+size_t vlc_spsc_fifo_GetBytes(const vlc_spsc_fifo_t *fifo)
+{
+    size_t out = atomic_load_explicit(&fifo->out_bytes, memory_order_acquire);
+    return atomic_load_explicit(&fifo->in_bytes, memory_order_relaxed) - out;
+}
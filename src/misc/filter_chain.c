@@ -32,6 +32,9 @@
 #include <libvlc.h>
 #include <assert.h>
 
+/* Maximum number of pictures waiting at the input of a pipeline stage */
+#define FILTER_PIPELINE_DEPTH 2
+
 typedef struct chained_filter_t
 {
     /* Public part of the filter structure */
@@ -40,8 +43,35 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t *mouse;
     picture_t *pending;
+    struct filter_stage *stage; /**< Pipeline stage, if pipelined */
 } chained_filter_t;
 
+/**
+ * Pipeline stage: a thread running a group of consecutive filters
+ */
+struct filter_stage
+{
+    struct filter_pipeline *pipeline;
+    chained_filter_t *first, *last; /**< Filters of the stage */
+    vlc_cond_t wait; /**< Signaled when the stage may have work */
+    picture_t *queue, **queue_tail; /**< Input pictures */
+    unsigned queue_length;
+    bool busy; /**< The filters are in use (by the thread or the owner) */
+    vlc_thread_t thread;
+};
+
+struct filter_pipeline
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< Signaled when the owner may proceed */
+    picture_t *out, **out_tail; /**< Output pictures */
+    unsigned out_length;
+    unsigned pending; /**< Pictures queued in or being filtered by stages */
+    bool quit;
+    unsigned count;
+    struct filter_stage stages[];
+};
+
 /* */
 struct filter_chain_t
 {
@@ -56,12 +86,16 @@ struct filter_chain_t
     bool b_allow_fmt_out_change; /**< Each filter can change the output */
     const char *filter_cap; /**< Filter modules capability */
     const char *conv_cap; /**< Converter modules capability */
+
+    unsigned pipeline_stages; /**< Maximum number of pipeline threads */
+    struct filter_pipeline *pipeline; /**< Running pipeline, if any */
 };
 
 /**
  * Local prototypes
  */
 static void FilterDeletePictures( picture_t * );
+static void FilterPipelineStop( filter_chain_t * );
 
 static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     const char *cap, const char *conv_cap, bool fmt_out_change,
@@ -83,6 +117,8 @@ static filter_chain_t *filter_chain_NewInner( vlc_object_t *obj,
     chain->b_allow_fmt_out_change = fmt_out_change;
     chain->filter_cap = cap;
     chain->conv_cap = conv_cap;
+    chain->pipeline_stages = 0;
+    chain->pipeline = NULL;
     return chain;
 }
 
@@ -205,6 +241,8 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
     const char *name, const char *capability, config_chain_t *cfg,
     const es_format_t *fmt_out )
 {
+    FilterPipelineStop( chain );
+
     chained_filter_t *chained =
         vlc_custom_create( chain->obj, sizeof(*chained), "filter" );
     if( unlikely(chained == NULL) )
@@ -275,6 +313,7 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
         vlc_mouse_Init( mouse );
     chained->mouse = mouse;
     chained->pending = NULL;
+    chained->stage = NULL;
 
     msg_Dbg( chain->obj, "Filter '%s' (%p) appended to chain",
              (name != NULL) ? name : module_get_name(filter->p_module, false),
@@ -311,6 +350,8 @@ void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
 {
     chained_filter_t *chained = (chained_filter_t *)filter;
 
+    FilterPipelineStop( chain );
+
     /* Remove it from the chain */
     if( chained->prev != NULL )
         chained->prev->next = chained->next;
@@ -386,12 +427,353 @@ error:
     return VLC_EGENERIC;
 }
 
+/*
+ * Pipeline
+ *
+ * Each stage thread takes pictures from its input queue, runs them through
+ * its filters, and appends all the resulting pictures to the input queue of
+ * the next stage, or to the output queue for the last stage. A stage waits
+ * while the next input queue, or the output queue, is full; the output queue
+ * is drained by the owner. All queues and flags are protected by the
+ * pipeline lock.
+ */
+static picture_t *FilterStageRun( const struct filter_stage *stage,
+                                  picture_t *pic )
+{
+    for( chained_filter_t *f = stage->first; ; f = f->next )
+    {
+        filter_t *p_filter = &f->filter;
+        picture_t *out = NULL, **tail = &out;
+
+        while( pic != NULL )
+        {
+            picture_t *next = pic->p_next;
+
+            pic->p_next = NULL;
+            *tail = p_filter->pf_video_filter( p_filter, pic );
+            while( *tail != NULL )
+                tail = &(*tail)->p_next;
+            pic = next;
+        }
+
+        pic = out;
+        if( f == stage->last )
+            return pic;
+    }
+}
+
+static void *FilterStageThread( void *data )
+{
+    struct filter_stage *stage = data;
+    struct filter_pipeline *pipeline = stage->pipeline;
+    struct filter_stage *prev = NULL, *next = NULL;
+    const unsigned *next_length = &pipeline->out_length;
+
+    if( stage > pipeline->stages )
+        prev = stage - 1;
+    if( stage + 1 < pipeline->stages + pipeline->count )
+    {
+        next = stage + 1;
+        next_length = &next->queue_length;
+    }
+
+    vlc_mutex_lock( &pipeline->lock );
+    while( !pipeline->quit )
+    {
+        if( stage->queue == NULL || stage->busy
+         || *next_length >= FILTER_PIPELINE_DEPTH )
+        {
+            vlc_cond_wait( &stage->wait, &pipeline->lock );
+            continue;
+        }
+
+        picture_t *pic = stage->queue;
+        stage->queue = pic->p_next;
+        if( stage->queue == NULL )
+            stage->queue_tail = &stage->queue;
+        stage->queue_length--;
+        pic->p_next = NULL;
+        stage->busy = true;
+        /* Room in the input queue */
+        if( prev != NULL )
+            vlc_cond_signal( &prev->wait );
+        else
+            vlc_cond_broadcast( &pipeline->wait );
+        vlc_mutex_unlock( &pipeline->lock );
+
+        pic = FilterStageRun( stage, pic );
+
+        vlc_mutex_lock( &pipeline->lock );
+        stage->busy = false;
+        pipeline->pending--;
+        if( next != NULL )
+        {
+            *next->queue_tail = pic;
+            while( *next->queue_tail != NULL )
+            {
+                next->queue_tail = &(*next->queue_tail)->p_next;
+                next->queue_length++;
+                pipeline->pending++;
+            }
+            vlc_cond_signal( &next->wait );
+        }
+        else
+        {
+            *pipeline->out_tail = pic;
+            while( *pipeline->out_tail != NULL )
+            {
+                pipeline->out_tail = &(*pipeline->out_tail)->p_next;
+                pipeline->out_length++;
+            }
+        }
+        vlc_cond_broadcast( &pipeline->wait );
+    }
+    vlc_mutex_unlock( &pipeline->lock );
+    return NULL;
+}
+
+static void FilterPipelineStart( filter_chain_t *chain )
+{
+    unsigned count = 0;
+
+    for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
+        count++;
+    if( count > chain->pipeline_stages )
+        count = chain->pipeline_stages;
+    if( count < 2 )
+        return; /* nothing to pipeline */
+
+    struct filter_pipeline *pipeline =
+        malloc( sizeof (*pipeline) + count * sizeof (pipeline->stages[0]) );
+    if( unlikely(pipeline == NULL) )
+        return;
+
+    vlc_mutex_init( &pipeline->lock );
+    vlc_cond_init( &pipeline->wait );
+    pipeline->out = NULL;
+    pipeline->out_tail = &pipeline->out;
+    pipeline->out_length = 0;
+    pipeline->pending = 0;
+    pipeline->quit = false;
+    pipeline->count = count;
+
+    /* Split the filters as evenly as possible */
+    unsigned filters = 0;
+    for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
+        filters++;
+
+    chained_filter_t *f = chain->first;
+    for( unsigned i = 0; i < count; i++ )
+    {
+        struct filter_stage *stage = &pipeline->stages[i];
+        unsigned n = (i + 1) * filters / count - i * filters / count;
+
+        stage->pipeline = pipeline;
+        stage->first = f;
+        for( unsigned j = 1; j < n; j++ )
+            f = f->next;
+        stage->last = f;
+        f = f->next;
+        vlc_cond_init( &stage->wait );
+        stage->queue = NULL;
+        stage->queue_tail = &stage->queue;
+        stage->queue_length = 0;
+        stage->busy = false;
+    }
+    assert( f == NULL );
+
+    chain->pipeline = pipeline;
+    for( unsigned i = 0; i < count; i++ )
+    {
+        struct filter_stage *stage = &pipeline->stages[i];
+
+        if( vlc_clone( &stage->thread, FilterStageThread, stage,
+                       VLC_THREAD_PRIORITY_VIDEO ) )
+        {
+            msg_Err( chain->obj, "cannot start filter pipeline" );
+            pipeline->count = i;
+            FilterPipelineStop( chain );
+            chain->pipeline_stages = 0;
+            return;
+        }
+
+        for( f = stage->first; f != stage->last->next; f = f->next )
+            f->stage = stage;
+    }
+
+    msg_Dbg( chain->obj, "filter pipeline started with %u stages", count );
+}
+
+static void FilterPipelineStop( filter_chain_t *chain )
+{
+    struct filter_pipeline *pipeline = chain->pipeline;
+    if( pipeline == NULL )
+        return;
+
+    vlc_mutex_lock( &pipeline->lock );
+    pipeline->quit = true;
+    for( unsigned i = 0; i < pipeline->count; i++ )
+        vlc_cond_signal( &pipeline->stages[i].wait );
+    vlc_mutex_unlock( &pipeline->lock );
+
+    for( unsigned i = 0; i < pipeline->count; i++ )
+        vlc_join( pipeline->stages[i].thread, NULL );
+
+    if( pipeline->pending > 0 || pipeline->out != NULL )
+        msg_Warn( chain->obj, "dropping pictures" );
+    for( unsigned i = 0; i < pipeline->count; i++ )
+        FilterDeletePictures( pipeline->stages[i].queue );
+    FilterDeletePictures( pipeline->out );
+
+    for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
+        f->stage = NULL;
+    chain->pipeline = NULL;
+    free( pipeline );
+}
+
+/**
+ * Gets exclusive use of the filters of a pipeline stage.
+ *
+ * The stage thread is paused after the picture being filtered, if any.
+ */
+static void FilterStageAcquire( struct filter_stage *stage )
+{
+    struct filter_pipeline *pipeline = stage->pipeline;
+
+    vlc_mutex_assert( &pipeline->lock );
+    while( stage->busy )
+        vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+    stage->busy = true;
+}
+
+static void FilterStageRelease( struct filter_stage *stage )
+{
+    vlc_mutex_assert( &stage->pipeline->lock );
+    stage->busy = false;
+    vlc_cond_signal( &stage->wait );
+    vlc_cond_broadcast( &stage->pipeline->wait );
+}
+
+/** Prevents a filter from running in its pipeline stage, if any */
+static void FilterLock( chained_filter_t *f )
+{
+    struct filter_stage *stage = f->stage;
+
+    if( stage != NULL )
+    {
+        vlc_mutex_lock( &stage->pipeline->lock );
+        FilterStageAcquire( stage );
+        vlc_mutex_unlock( &stage->pipeline->lock );
+    }
+}
+
+static void FilterUnlock( chained_filter_t *f )
+{
+    struct filter_stage *stage = f->stage;
+
+    if( stage != NULL )
+    {
+        vlc_mutex_lock( &stage->pipeline->lock );
+        FilterStageRelease( stage );
+        vlc_mutex_unlock( &stage->pipeline->lock );
+    }
+}
+
+static picture_t *FilterPipelineVideoFilter( struct filter_pipeline *pipeline,
+                                             picture_t *pic, bool wait )
+{
+    struct filter_stage *first = &pipeline->stages[0];
+    struct filter_stage *last = &pipeline->stages[pipeline->count - 1];
+
+    vlc_mutex_lock( &pipeline->lock );
+    if( pic != NULL )
+    {
+        /* With the output queue full, the stages may only resume once the
+         * owner takes output pictures, so queue the picture regardless. */
+        while( first->queue_length >= FILTER_PIPELINE_DEPTH
+            && pipeline->out_length < FILTER_PIPELINE_DEPTH )
+            vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+
+        *first->queue_tail = pic;
+        first->queue_tail = &pic->p_next;
+        first->queue_length++;
+        pipeline->pending++;
+        vlc_cond_signal( &first->wait );
+    }
+
+    if( wait )
+        while( pipeline->out == NULL && pipeline->pending > 0 )
+            vlc_cond_wait( &pipeline->wait, &pipeline->lock );
+
+    pic = pipeline->out;
+    if( pic != NULL )
+    {
+        pipeline->out = pic->p_next;
+        if( pipeline->out == NULL )
+            pipeline->out_tail = &pipeline->out;
+        pipeline->out_length--;
+        pic->p_next = NULL;
+        /* Room in the output queue */
+        vlc_cond_signal( &last->wait );
+    }
+    vlc_mutex_unlock( &pipeline->lock );
+    return pic;
+}
+
+static void FilterPipelineFlush( struct filter_pipeline *pipeline )
+{
+    vlc_mutex_lock( &pipeline->lock );
+    /* In order, so that no stage outputs pictures to a flushed stage */
+    for( unsigned i = 0; i < pipeline->count; i++ )
+    {
+        struct filter_stage *stage = &pipeline->stages[i];
+
+        FilterStageAcquire( stage );
+
+        picture_t *pics = stage->queue;
+        pipeline->pending -= stage->queue_length;
+        stage->queue = NULL;
+        stage->queue_tail = &stage->queue;
+        stage->queue_length = 0;
+        vlc_mutex_unlock( &pipeline->lock );
+
+        FilterDeletePictures( pics );
+        for( chained_filter_t *f = stage->first; f != stage->last->next;
+             f = f->next )
+            filter_Flush( &f->filter );
+
+        vlc_mutex_lock( &pipeline->lock );
+        FilterStageRelease( stage );
+    }
+    assert( pipeline->pending == 0 );
+
+    picture_t *pics = pipeline->out;
+    pipeline->out = NULL;
+    pipeline->out_tail = &pipeline->out;
+    pipeline->out_length = 0;
+    vlc_cond_signal( &pipeline->stages[pipeline->count - 1].wait );
+    vlc_mutex_unlock( &pipeline->lock );
+
+    FilterDeletePictures( pics );
+}
+
+void filter_chain_SetPipeline( filter_chain_t *chain, unsigned stages )
+{
+    assert( chain->fmt_in.i_cat == VIDEO_ES );
+
+    if( stages != chain->pipeline_stages )
+        FilterPipelineStop( chain );
+    chain->pipeline_stages = stages;
+}
+
 int filter_chain_ForEach( filter_chain_t *chain,
                           int (*cb)( filter_t *, void * ), void *opaque )
 {
     for( chained_filter_t *f = chain->first; f != NULL; f = f->next )
     {
+        FilterLock( f );
         int ret = cb( &f->filter, opaque );
+        FilterUnlock( f );
         if( ret )
             return ret;
     }
@@ -443,6 +825,11 @@ static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic
 
 picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
 {
+    if( p_chain->pipeline == NULL && p_chain->pipeline_stages > 1 )
+        FilterPipelineStart( p_chain );
+    if( p_chain->pipeline != NULL )
+        return FilterPipelineVideoFilter( p_chain->pipeline, p_pic, false );
+
     if( p_pic )
     {
         p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
@@ -464,8 +851,21 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
     return NULL;
 }
 
+picture_t *filter_chain_VideoDrain( filter_chain_t *p_chain )
+{
+    if( p_chain->pipeline != NULL )
+        return FilterPipelineVideoFilter( p_chain->pipeline, NULL, true );
+    return filter_chain_VideoFilter( p_chain, NULL );
+}
+
 void filter_chain_VideoFlush( filter_chain_t *p_chain )
 {
+    if( p_chain->pipeline != NULL )
+    {
+        FilterPipelineFlush( p_chain->pipeline );
+        return;
+    }
+
     for( chained_filter_t *f = p_chain->first; f != NULL; f = f->next )
     {
         filter_t *p_filter = &f->filter;
@@ -516,9 +916,13 @@ int filter_chain_MouseFilter( filter_chain_t *p_chain, vlc_mouse_t *p_dst, const
         {
             vlc_mouse_t old = *p_mouse;
             vlc_mouse_t filtered;
+            int ret;
 
             *p_mouse = current;
-            if( p_filter->pf_video_mouse( p_filter, &filtered, &old, &current ) )
+            FilterLock( f );
+            ret = p_filter->pf_video_mouse( p_filter, &filtered, &old, &current );
+            FilterUnlock( f );
+            if( ret )
                 return VLC_EGENERIC;
             current = filtered;
         }
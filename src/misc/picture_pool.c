@@ -27,6 +27,7 @@
 #endif
 #include <assert.h>
 #include <limits.h>
+#include <stdalign.h>
 #include <stdatomic.h>
 #include <stdlib.h>
 
@@ -34,19 +35,36 @@
 #include <vlc_picture_pool.h>
 #include "picture.h"
 
-#define POOL_MAX (CHAR_BIT * sizeof (unsigned long long))
+#define POOL_MAX 1024
 
-static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
+/* Free pictures bitmap word */
+#define POOL_WORD_BITS (CHAR_BIT * sizeof (unsigned long))
+#define POOL_WORDS(count) (((count) + POOL_WORD_BITS - 1) / POOL_WORD_BITS)
 
+struct picture_pool_slot {
+    picture_pool_t *pool;
+    picture_t      *picture;
+};
+
+static_assert (sizeof (atomic_ulong) % alignof (struct picture_pool_slot) == 0,
+               "Misaligned slots");
+
+/*
+ * Free pictures are tracked with one bit each, in an array of words. Taking a
+ * picture clears its bit with a compare-and-swap, releasing it sets the bit,
+ * so that neither takes the lock. The lock and condition variable are only
+ * used to sleep in picture_pool_Wait(), and to wake such waiters up.
+ */
 struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
-    atomic_ushort      refs;
-    unsigned short     picture_count;
-    picture_t  *picture[];
+    atomic_bool    canceled;
+    atomic_uint    waiters;
+    atomic_uint    refs;
+    unsigned       picture_count;
+    struct picture_pool_slot *slots;
+    atomic_ulong   available[];
 };
 
 static void picture_pool_Destroy(picture_pool_t *pool)
@@ -55,31 +73,40 @@ static void picture_pool_Destroy(picture_pool_t *pool)
         return;
 
     atomic_thread_fence(memory_order_acquire);
-    aligned_free(pool);
+    free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
     for (unsigned i = 0; i < pool->picture_count; i++)
-        picture_Release(pool->picture[i]);
+        picture_Release(pool->slots[i].picture);
     picture_pool_Destroy(pool);
 }
 
 static void picture_pool_ReleasePicture(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
-    uintptr_t sys = (uintptr_t)priv->gc.opaque;
-    picture_pool_t *pool = (void *)(sys & ~(POOL_MAX - 1));
-    unsigned offset = sys & (POOL_MAX - 1);
-    picture_t *picture = pool->picture[offset];
-
-    picture_Release(picture);
-
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+    struct picture_pool_slot *slot = priv->gc.opaque;
+    picture_pool_t *pool = slot->pool;
+    unsigned offset = slot - pool->slots;
+    unsigned long bit = 1UL << (offset % POOL_WORD_BITS);
+
+    picture_Release(slot->picture);
+
+    unsigned long prev =
+        atomic_fetch_or_explicit(&pool->available[offset / POOL_WORD_BITS],
+                                 bit, memory_order_release);
+    assert(!(prev & bit));
+    (void) prev;
+
+    /* Pairs with the fence in picture_pool_Wait() */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool->waiters, memory_order_relaxed) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
     picture_pool_Destroy(pool);
 }
@@ -87,11 +114,48 @@ static void picture_pool_ReleasePicture(picture_t *clone)
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
                                             unsigned offset)
 {
-    picture_t *picture = pool->picture[offset];
-    uintptr_t sys = ((uintptr_t)pool) + offset;
+    struct picture_pool_slot *slot = &pool->slots[offset];
 
-    return picture_InternalClone(picture, picture_pool_ReleasePicture,
-                                 (void*)sys);
+    picture_t *clone = picture_InternalClone(slot->picture,
+                                             picture_pool_ReleasePicture,
+                                             slot);
+    if (clone != NULL) {
+        assert(clone->p_next == NULL);
+        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    } else {
+        /* Put the picture back */
+        atomic_fetch_or_explicit(&pool->available[offset / POOL_WORD_BITS],
+                                 1UL << (offset % POOL_WORD_BITS),
+                                 memory_order_release);
+    }
+    return clone;
+}
+
+/**
+ * Takes a free picture from the bitmap.
+ *
+ * @return the picture offset, or -1 if all pictures are in use
+ */
+static int picture_pool_Take(picture_pool_t *pool)
+{
+    for (unsigned w = 0; w < POOL_WORDS(pool->picture_count); w++)
+    {
+        unsigned long available =
+            atomic_load_explicit(&pool->available[w], memory_order_relaxed);
+
+        while (available != 0)
+        {
+            unsigned long bit = available & -available;
+
+            if (atomic_compare_exchange_weak_explicit(&pool->available[w],
+                                                      &available,
+                                                      available & ~bit,
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                return w * POOL_WORD_BITS + ctz(bit);
+        }
+    }
+    return -1;
 }
 
 picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
@@ -100,23 +164,33 @@ picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
         return NULL;
 
     picture_pool_t *pool;
-    size_t size = sizeof (*pool) + count * sizeof (picture_t *);
+    size_t words = POOL_WORDS(count);
 
-    size += (-size) & (POOL_MAX - 1);
-    pool = aligned_alloc(POOL_MAX, size);
+    pool = malloc(sizeof (*pool) + words * sizeof (pool->available[0])
+                  + count * sizeof (pool->slots[0]));
     if (unlikely(pool == NULL))
         return NULL;
 
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
-    if (count == POOL_MAX)
-        pool->available = ~0ULL;
-    else
-        pool->available = (1ULL << count) - 1;
+    atomic_init(&pool->canceled, false);
+    atomic_init(&pool->waiters, 0);
     atomic_init(&pool->refs,  1);
     pool->picture_count = count;
-    memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+    pool->slots = (struct picture_pool_slot *)(pool->available + words);
+
+    for (size_t w = 0; w < words; w++)
+    {
+        unsigned bits = count - w * POOL_WORD_BITS;
+
+        atomic_init(&pool->available[w], (bits >= POOL_WORD_BITS)
+                    ? ~0UL : (1UL << bits) - 1);
+    }
+    for (unsigned i = 0; i < count; i++)
+    {
+        pool->slots[i].pool = pool;
+        pool->slots[i].picture = tab[i];
+    }
     return pool;
 }
 
@@ -169,68 +243,50 @@ error:
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
-    available = pool->available;
-
-    while (available != 0)
-    {
-        int i = ctz(available);
-
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-        picture_t *clone = picture_pool_ClonePicture(pool, i);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-        }
-        return clone;
-    }
+    if (unlikely(atomic_load_explicit(&pool->canceled, memory_order_relaxed)))
+        return NULL;
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    int i = picture_pool_Take(pool);
+    if (i < 0)
+        return NULL;
+    return picture_pool_ClonePicture(pool, i);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
+
+    int i = picture_pool_Take(pool);
+    if (i >= 0)
+        return picture_pool_ClonePicture(pool, i);
+
     vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    atomic_fetch_add_explicit(&pool->waiters, 1, memory_order_relaxed);
+    /* Pairs with the fence in picture_pool_ReleasePicture(): either the
+     * releasing thread sees the waiter, or the waiter sees the picture. */
+    atomic_thread_fence(memory_order_seq_cst);
 
-    while (pool->available == 0)
+    while ((i = picture_pool_Take(pool)) < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
+        if (atomic_load_explicit(&pool->canceled, memory_order_relaxed))
+            break;
         vlc_cond_wait(&pool->wait, &pool->lock);
     }
 
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
+    atomic_fetch_sub_explicit(&pool->waiters, 1, memory_order_relaxed);
     vlc_mutex_unlock(&pool->lock);
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-    }
-    return clone;
+    return (i >= 0) ? picture_pool_ClonePicture(pool, i) : NULL;
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load_explicit(&pool->refs, memory_order_relaxed) > 0);
 
-    pool->canceled = canceled;
+    vlc_mutex_lock(&pool->lock);
+    atomic_store_explicit(&pool->canceled, canceled, memory_order_relaxed);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
@@ -0,0 +1,178 @@
+/*****************************************************************************
+ * slice.c: slice-parallel work sharing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_slice.h>
+
+#define SLICE_MAX_THREADS 64
+
+struct vlc_slice_pool
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  work; /**< Workers wait for a job */
+    vlc_cond_t  idle; /**< Dispatchers wait for the job to complete */
+
+    /* Current job, if run is not NULL */
+    void      (*run)(void *, unsigned, unsigned);
+    void       *opaque;
+    unsigned    count;
+    unsigned    next;    /**< First slice not started yet */
+    unsigned    pending; /**< Slices not completed yet */
+    bool        quit;
+
+    unsigned     threads;
+    vlc_thread_t workers[];
+};
+
+/* Runs slices of the current job until none are left to start */
+static void RunSlices(vlc_slice_pool_t *pool)
+{
+    vlc_mutex_assert(&pool->lock);
+
+    while (pool->run != NULL && pool->next < pool->count)
+    {
+        void (*run)(void *, unsigned, unsigned) = pool->run;
+        void *opaque = pool->opaque;
+        unsigned count = pool->count;
+        unsigned index = pool->next++;
+
+        vlc_mutex_unlock(&pool->lock);
+        run(opaque, index, count);
+        vlc_mutex_lock(&pool->lock);
+
+        assert(pool->pending > 0);
+        if (--pool->pending == 0)
+            vlc_cond_broadcast(&pool->idle);
+    }
+}
+
+static void *Worker(void *data)
+{
+    vlc_slice_pool_t *pool = data;
+
+    vlc_mutex_lock(&pool->lock);
+    while (!pool->quit)
+    {
+        if (pool->run == NULL || pool->next >= pool->count)
+        {
+            vlc_cond_wait(&pool->work, &pool->lock);
+            continue;
+        }
+        RunSlices(pool);
+    }
+    vlc_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+vlc_slice_pool_t *vlc_slice_pool_New(unsigned threads)
+{
+    if (threads == 0)
+        threads = vlc_GetCPUCount();
+    if (threads > SLICE_MAX_THREADS)
+        threads = SLICE_MAX_THREADS;
+    if (threads == 0)
+        threads = 1;
+
+    vlc_slice_pool_t *pool = malloc(sizeof (*pool)
+                                    + (threads - 1) * sizeof (vlc_thread_t));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    vlc_mutex_init(&pool->lock);
+    vlc_cond_init(&pool->work);
+    vlc_cond_init(&pool->idle);
+    pool->run = NULL;
+    pool->count = pool->next = pool->pending = 0;
+    pool->quit = false;
+    pool->threads = 1;
+
+    /* The dispatching thread is the first one */
+    while (pool->threads < threads)
+    {
+        if (vlc_clone(&pool->workers[pool->threads - 1], Worker, pool,
+                      VLC_THREAD_PRIORITY_VIDEO))
+            break; /* fewer threads is still fine */
+        pool->threads++;
+    }
+    return pool;
+}
+
+#undef vlc_slice_pool_Inherit
+vlc_slice_pool_t *vlc_slice_pool_Inherit(vlc_object_t *obj)
+{
+    int64_t threads = var_InheritInteger(obj, "filter-threads");
+
+    return vlc_slice_pool_New(threads > 0 ? threads : 0);
+}
+
+void vlc_slice_pool_Delete(vlc_slice_pool_t *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    assert(pool->run == NULL);
+    pool->quit = true;
+    vlc_cond_broadcast(&pool->work);
+    vlc_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 1; i < pool->threads; i++)
+        vlc_join(pool->workers[i - 1], NULL);
+    free(pool);
+}
+
+unsigned vlc_slice_pool_GetThreads(const vlc_slice_pool_t *pool)
+{
+    return (pool != NULL) ? pool->threads : 1;
+}
+
+void vlc_slice_dispatch(vlc_slice_pool_t *pool, unsigned count,
+                        void (*run)(void *, unsigned, unsigned), void *opaque)
+{
+    if (pool == NULL || pool->threads == 1 || count <= 1)
+    {
+        for (unsigned i = 0; i < count; i++)
+            run(opaque, i, count);
+        return;
+    }
+
+    vlc_mutex_lock(&pool->lock);
+    while (pool->run != NULL) /* another thread is dispatching */
+        vlc_cond_wait(&pool->idle, &pool->lock);
+
+    pool->run = run;
+    pool->opaque = opaque;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    vlc_cond_broadcast(&pool->work);
+
+    RunSlices(pool);
+    while (pool->pending > 0)
+        vlc_cond_wait(&pool->idle, &pool->lock);
+
+    pool->run = NULL;
+    vlc_cond_broadcast(&pool->idle);
+    vlc_mutex_unlock(&pool->lock);
+}
@@ -42,6 +42,7 @@
 #include <vlc_url.h>
 #include <vlc_mime.h>
 #include <vlc_block.h>
+#include <vlc_fs.h>
 #include "../libvlc.h"
 
 #include <string.h>
@@ -54,6 +55,12 @@
 #ifdef HAVE_POLL
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+# include <sys/epoll.h>
+#endif
+#ifndef _WIN32
+# include <fcntl.h>
+#endif
 
 #if defined(_WIN32)
 #   include <winsock2.h>
@@ -68,10 +75,32 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* maximum number of stream chunks sent to a client at once */
+#define HTTPD_STREAM_IOV_MAX 64
+
+typedef struct httpd_stream_chunk httpd_stream_chunk;
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_StreamChunkRelease(httpd_stream_chunk *chunk);
+
+/* each host runs one or more worker threads, each serving its own clients */
+struct httpd_worker
+{
+    httpd_host_t *host;
+    vlc_thread_t  thread;
+
+    vlc_mutex_t lock;
+    size_t client_count;
+    struct vlc_list clients;
+
+#ifndef _WIN32
+    int wakefd[2]; /* pipe to wake the worker up */
+#endif
+#ifdef HAVE_SYS_EPOLL_H
+    int epfd;
+#endif
+};
 
-/* each host run in his own thread */
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -85,7 +114,11 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
+    /* the first worker also accepts the new connections */
+    struct httpd_worker *workers;
+    unsigned    nworkers;
+    atomic_uint next_worker;
+
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
@@ -95,9 +128,6 @@ struct httpd_host_t
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
-
     /* TLS data */
     vlc_tls_server_t *p_tls;
 };
@@ -146,6 +176,7 @@ struct httpd_client_t
 
     bool    b_stream_mode;
     uint8_t i_state;
+    short   i_poll_events; /* events waited for */
 
     vlc_tick_t i_activity_date;
     vlc_tick_t i_activity_timeout;
@@ -162,6 +193,13 @@ struct httpd_client_t
      */
     int64_t i_keyframe_wait_to_pass;
 
+    /*
+     * Stream chunks being sent to a client in stream mode. They are shared
+     * by all clients of the stream and sent without copying.
+     */
+    unsigned            i_chunks;
+    httpd_stream_chunk *pp_chunks[HTTPD_STREAM_IOV_MAX];
+
     /* */
     httpd_message_t query;  /* client -> httpd */
     httpd_message_t answer; /* httpd -> client */
@@ -588,6 +626,50 @@ void httpd_RedirectDelete(httpd_redirect_t *rdir)
 /*****************************************************************************
  * High Level Funtions: httpd_stream_t
  *****************************************************************************/
+
+/* Reference-counted piece of stream data, shared by all clients */
+struct httpd_stream_chunk
+{
+    atomic_uint refs;
+    int64_t     i_pos;  /* absolute position of the first byte */
+    size_t      i_size;
+    uint8_t     p_data[];
+};
+
+static httpd_stream_chunk *httpd_StreamChunkNew(int64_t i_pos,
+                                                const uint8_t *p_data,
+                                                size_t i_size)
+{
+    httpd_stream_chunk *chunk = malloc(sizeof (*chunk) + i_size);
+    if (unlikely(chunk == NULL))
+        return NULL;
+
+    atomic_init(&chunk->refs, 1);
+    chunk->i_pos = i_pos;
+    chunk->i_size = i_size;
+    memcpy(chunk->p_data, p_data, i_size);
+    return chunk;
+}
+
+static httpd_stream_chunk *httpd_StreamChunkHold(httpd_stream_chunk *chunk)
+{
+    atomic_fetch_add_explicit(&chunk->refs, 1, memory_order_relaxed);
+    return chunk;
+}
+
+static void httpd_StreamChunkRelease(httpd_stream_chunk *chunk)
+{
+    if (atomic_fetch_sub_explicit(&chunk->refs, 1, memory_order_acq_rel) == 1)
+        free(chunk);
+}
+
+static void httpd_ClientReleaseChunks(httpd_client_t *cl)
+{
+    for (unsigned i = 0; i < cl->i_chunks; i++)
+        httpd_StreamChunkRelease(cl->pp_chunks[i]);
+    cl->i_chunks = 0;
+}
+
 struct httpd_stream_t
 {
     vlc_mutex_t lock;
@@ -607,9 +689,15 @@ struct httpd_stream_t
     bool        b_has_keyframes;
     int64_t     i_last_keyframe_seen_pos;
 
-    /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* ring of chunks, from oldest to newest */
+    httpd_stream_chunk **pp_chunks;
+    size_t      i_chunks_alloc;
+    size_t      i_chunks_start;     /* index of the oldest chunk */
+    size_t      i_chunks;           /* number of chunks in the ring */
+    size_t      i_ring_bytes;       /* bytes held by the ring */
+    size_t      i_ring_max;         /* ring depth (bytes) */
+    bool        b_drop_slow;        /* drop clients falling out of the ring */
+
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -618,6 +706,62 @@ struct httpd_stream_t
     httpd_header * p_http_headers;
 };
 
+static int64_t httpd_StreamRingStart(const httpd_stream_t *stream)
+{
+    if (stream->i_chunks == 0)
+        return stream->i_buffer_pos;
+    return stream->pp_chunks[stream->i_chunks_start]->i_pos;
+}
+
+static httpd_stream_chunk *httpd_StreamChunkAt(const httpd_stream_t *stream,
+                                               size_t i)
+{
+    assert(i < stream->i_chunks);
+    i += stream->i_chunks_start;
+    if (i >= stream->i_chunks_alloc)
+        i -= stream->i_chunks_alloc;
+    return stream->pp_chunks[i];
+}
+
+/**
+ * Takes references to the chunks following the given stream position,
+ * so that they can be sent to the client without copying.
+ *
+ * \return the number of bytes to send, starting at i_offset.
+ */
+static size_t httpd_StreamHoldChunks(httpd_stream_t *stream,
+                                     httpd_client_t *cl, int64_t i_offset)
+{
+    size_t lo = 0, hi = stream->i_chunks;
+
+    assert(cl->i_chunks == 0);
+
+    /* Find the chunk containing the offset */
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+
+        if (httpd_StreamChunkAt(stream, mid)->i_pos <= i_offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    size_t i_body = 0;
+
+    for (size_t i = lo; i < stream->i_chunks
+                     && cl->i_chunks < HTTPD_STREAM_IOV_MAX; i++) {
+        httpd_stream_chunk *chunk = httpd_StreamChunkAt(stream, i);
+        int64_t i_end = chunk->i_pos + chunk->i_size;
+
+        if (i_end <= i_offset)
+            continue;
+
+        cl->pp_chunks[cl->i_chunks++] = httpd_StreamChunkHold(chunk);
+        i_body += i_end - __MAX(i_offset, chunk->i_pos);
+    }
+    return i_body;
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -628,45 +772,51 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
-
-        if (answer->i_body_offset >= stream->i_buffer_pos)
+        vlc_mutex_lock(&stream->lock);
+        if (answer->i_body_offset >= stream->i_buffer_pos) {
+            vlc_mutex_unlock(&stream->lock);
             return VLC_EGENERIC;    /* wait, no data available */
+        }
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
-            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
+            if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass) {
                 /* still waiting for the next keyframe */
+                vlc_mutex_unlock(&stream->lock);
                 return VLC_EGENERIC;
+            }
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
-            answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
+        if (answer->i_body_offset < httpd_StreamRingStart(stream)) {
+            /* this client isn't fast enough */
+            if (stream->b_drop_slow) {
+                vlc_mutex_unlock(&stream->lock);
+                cl->i_state = HTTPD_CLIENT_DEAD;
+                return VLC_EGENERIC;
+            }
+            answer->i_body_offset = stream->i_buffer_last_pos;
+        }
 
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
-        int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
+        size_t i_body = httpd_StreamHoldChunks(stream, cl,
+                                               answer->i_body_offset);
+        vlc_mutex_unlock(&stream->lock);
 
-        if (i_write > HTTPD_CL_BUFSIZE)
-            i_write = HTTPD_CL_BUFSIZE;
-        else if (i_write <= 0)
+        if (i_body == 0)
             return VLC_EGENERIC;    /* wait, no data available */
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
-
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
+        /* The body is sent straight from the held chunks */
+        answer->i_body = i_body;
+        answer->p_body = NULL;
 
-        answer->i_body_offset += i_write;
+        answer->i_body_offset += i_body;
 
         return VLC_SUCCESS;
     } else {
@@ -752,7 +902,7 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
         return NULL;
 
     stream->psz_mime = NULL;
-    stream->p_buffer = NULL;
+    stream->pp_chunks = NULL;
 
     stream->url = httpd_UrlNew(host, psz_url, psz_user, psz_password);
     if (!stream->url)
@@ -768,10 +918,18 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
 
     stream->i_header = 0;
     stream->p_header = NULL;
-    stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
 
-    stream->p_buffer = malloc(stream->i_buffer_size);
-    if (stream->p_buffer == NULL)
+    stream->i_chunks_alloc = 256;
+    stream->i_chunks_start = 0;
+    stream->i_chunks = 0;
+    stream->i_ring_bytes = 0;
+    stream->i_ring_max = 1000 * var_InheritInteger(host,
+                                                   "http-stream-buffer");
+    stream->b_drop_slow = var_InheritBool(host, "http-stream-drop-slow");
+
+    stream->pp_chunks = vlc_alloc(stream->i_chunks_alloc,
+                                  sizeof (*stream->pp_chunks));
+    if (stream->pp_chunks == NULL)
         goto error;
 
     /* We set to 1 to make life simpler
@@ -793,6 +951,7 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     return stream;
 
 error:
+    free(stream->pp_chunks);
     free(stream->psz_mime);
 
     if (stream->url)
@@ -819,43 +978,74 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+static int httpd_AppendData(httpd_stream_t *stream, const uint8_t *p_data,
+                            size_t i_data)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
+    httpd_stream_chunk *chunk = httpd_StreamChunkNew(stream->i_buffer_pos,
+                                                     p_data, i_data);
+    if (unlikely(chunk == NULL))
+        return VLC_ENOMEM;
 
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
+    /* Drop the oldest chunks beyond the ring depth. Clients still sending
+     * them hold their own references. */
+    while (stream->i_chunks > 0
+        && stream->i_ring_bytes + i_data > stream->i_ring_max) {
+        httpd_stream_chunk *old = stream->pp_chunks[stream->i_chunks_start];
+
+        stream->i_ring_bytes -= old->i_size;
+        httpd_StreamChunkRelease(old);
+        if (++stream->i_chunks_start == stream->i_chunks_alloc)
+            stream->i_chunks_start = 0;
+        stream->i_chunks--;
+    }
 
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+    if (stream->i_chunks == stream->i_chunks_alloc) {
+        size_t i_alloc = 2 * stream->i_chunks_alloc;
+        httpd_stream_chunk **pp = vlc_alloc(i_alloc, sizeof (*pp));
+        if (unlikely(pp == NULL)) {
+            httpd_StreamChunkRelease(chunk);
+            return VLC_ENOMEM;
+        }
+
+        for (size_t i = 0; i < stream->i_chunks; i++)
+            pp[i] = httpd_StreamChunkAt(stream, i);
+        free(stream->pp_chunks);
+        stream->pp_chunks = pp;
+        stream->i_chunks_alloc = i_alloc;
+        stream->i_chunks_start = 0;
     }
 
+    size_t i = stream->i_chunks_start + stream->i_chunks++;
+    if (i >= stream->i_chunks_alloc)
+        i -= stream->i_chunks_alloc;
+    stream->pp_chunks[i] = chunk;
+    stream->i_ring_bytes += i_data;
     stream->i_buffer_pos += i_data;
+    return VLC_SUCCESS;
 }
 
 int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
 {
-    if (!p_block || !p_block->p_buffer)
+    if (!p_block || !p_block->p_buffer || p_block->i_buffer == 0)
         return VLC_SUCCESS;
 
     vlc_mutex_lock(&stream->lock);
 
-    /* save this pointer (to be used by new connection) */
-    stream->i_buffer_last_pos = stream->i_buffer_pos;
+    int64_t i_pos = stream->i_buffer_pos;
+    int ret = httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
 
-    if (p_block->i_flags & BLOCK_FLAG_TYPE_I) {
-        stream->b_has_keyframes = true;
-        stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
-    }
+    if (ret == VLC_SUCCESS) {
+        /* save this pointer (to be used by new connection) */
+        stream->i_buffer_last_pos = i_pos;
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+        if (p_block->i_flags & BLOCK_FLAG_TYPE_I) {
+            stream->b_has_keyframes = true;
+            stream->i_last_keyframe_seen_pos = i_pos;
+        }
+    }
 
     vlc_mutex_unlock(&stream->lock);
-    return VLC_SUCCESS;
+    return ret;
 }
 
 void httpd_StreamDelete(httpd_stream_t *stream)
@@ -868,7 +1058,9 @@ void httpd_StreamDelete(httpd_stream_t *stream)
     free(stream->p_http_headers);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
+    for (size_t i = 0; i < stream->i_chunks; i++)
+        httpd_StreamChunkRelease(httpd_StreamChunkAt(stream, i));
+    free(stream->pp_chunks);
     free(stream);
 }
 
@@ -914,6 +1106,70 @@ httpd_host_t *vlc_rtsp_HostNew(vlc_object_t *p_this)
     return httpd_HostCreate(p_this, "rtsp-host", "rtsp-port", NULL);
 }
 
+static void httpd_WorkerWake(struct httpd_worker *);
+static void httpd_WorkerRemoveClient(struct httpd_worker *, httpd_client_t *);
+
+static int httpd_WorkerStart(httpd_host_t *host, struct httpd_worker *worker)
+{
+    worker->host = host;
+    vlc_mutex_init(&worker->lock);
+    worker->client_count = 0;
+    vlc_list_init(&worker->clients);
+
+#ifndef _WIN32
+    if (vlc_pipe(worker->wakefd))
+        return -1;
+    fcntl(worker->wakefd[0], F_SETFL,
+          fcntl(worker->wakefd[0], F_GETFL) | O_NONBLOCK);
+    fcntl(worker->wakefd[1], F_SETFL,
+          fcntl(worker->wakefd[1], F_GETFL) | O_NONBLOCK);
+#endif
+
+#ifdef HAVE_SYS_EPOLL_H
+    worker->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker->epfd == -1)
+        goto error;
+
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = worker->wakefd };
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, worker->wakefd[0], &ev))
+        goto error;
+
+    /* The first worker accepts the new connections */
+    for (unsigned i = 0; worker == host->workers && i < host->nfd; i++) {
+        ev.data.ptr = &host->fds[i];
+        if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, host->fds[i], &ev))
+            goto error;
+    }
+#endif
+
+    if (vlc_clone(&worker->thread, httpd_HostThread, worker,
+                   VLC_THREAD_PRIORITY_LOW))
+        goto error;
+    return 0;
+
+error:
+#ifdef HAVE_SYS_EPOLL_H
+    if (worker->epfd != -1)
+        vlc_close(worker->epfd);
+#endif
+#ifndef _WIN32
+    vlc_close(worker->wakefd[1]);
+    vlc_close(worker->wakefd[0]);
+#endif
+    return -1;
+}
+
+static void httpd_WorkerClean(struct httpd_worker *worker)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    vlc_close(worker->epfd);
+#endif
+#ifndef _WIN32
+    vlc_close(worker->wakefd[1]);
+    vlc_close(worker->wakefd[0]);
+#endif
+}
+
 static struct httpd
 {
     vlc_mutex_t  mutex;
@@ -958,6 +1214,7 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     char *hostname = var_InheritString(p_this, hostvar);
 
+    host->workers = NULL;
     host->fds = net_ListenTCP(p_this, hostname, port);
     free(hostname);
 
@@ -969,16 +1226,32 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host,
-                   VLC_THREAD_PRIORITY_LOW)) {
+    /* create the worker threads */
+    int64_t nworkers = var_InheritInteger(p_this, "http-threads");
+    if (nworkers <= 0)
+        nworkers = vlc_GetCPUCount();
+#ifdef _WIN32
+    /* no pipe to wake a worker up: the only worker accepts the clients */
+    nworkers = 1;
+#endif
+
+    host->workers = vlc_alloc(nworkers, sizeof (*host->workers));
+    if (unlikely(host->workers == NULL))
+        goto error;
+    atomic_init(&host->next_worker, 0);
+
+    for (host->nworkers = 0; host->nworkers < nworkers; host->nworkers++)
+        if (httpd_WorkerStart(host, &host->workers[host->nworkers]))
+            break;
+
+    if (host->nworkers == 0) {
         msg_Err(p_this, "cannot spawn http host thread");
         goto error;
     }
+    msg_Dbg(p_this, "HTTP host serving clients with %u thread(s)",
+            host->nworkers);
 
     /* now add it to httpd */
     vlc_list_append(&host->node, &httpd.hosts);
@@ -990,7 +1263,9 @@ error:
     vlc_mutex_unlock(&httpd.mutex);
 
     if (host) {
-        net_ListenClose(host->fds);
+        if (host->fds != NULL)
+            net_ListenClose(host->fds);
+        free(host->workers);
         vlc_object_delete(host);
     }
 
@@ -1013,15 +1288,23 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
+    for (unsigned i = 0; i < host->nworkers; i++)
+        vlc_cancel(host->workers[i].thread);
 
-    msg_Dbg(host, "HTTP host removed");
+    for (unsigned i = 0; i < host->nworkers; i++) {
+        struct httpd_worker *worker = &host->workers[i];
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
+        vlc_join(worker->thread, NULL);
+
+        vlc_list_foreach(client, &worker->clients, node) {
+            msg_Warn(host, "client still connected");
+            httpd_ClientDestroy(client);
+        }
+        httpd_WorkerClean(worker);
     }
+    free(host->workers);
+
+    msg_Dbg(host, "HTTP host removed");
 
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
@@ -1111,22 +1394,41 @@ void httpd_UrlDelete(httpd_url_t *url)
 
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
+    vlc_mutex_unlock(&host->lock);
 
-    free(url->psz_url);
-    free(url->psz_user);
-    free(url->psz_password);
+    /* No client can pick the URL anymore. Once each worker is unlocked,
+     * no callback can be running either: detach the remaining clients.
+     * Their worker destroys them. */
+    for (unsigned i = 0; i < host->nworkers; i++) {
+        struct httpd_worker *worker = &host->workers[i];
+        bool b_wake = false;
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+        vlc_mutex_lock(&worker->lock);
+        vlc_list_foreach(client, &worker->clients, node) {
+            if (client->url != url)
+                continue;
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
+            msg_Warn(host, "force closing connections");
+#ifdef HAVE_SYS_EPOLL_H
+            /* pending events may point to the client */
+            client->url = NULL;
+            client->i_state = HTTPD_CLIENT_DEAD;
+            b_wake = true;
+#else
+            /* poll() results are matched to the clients by socket */
+            httpd_WorkerRemoveClient(worker, client);
+#endif
+        }
+        vlc_mutex_unlock(&worker->lock);
+
+        if (b_wake)
+            httpd_WorkerWake(worker);
     }
+
+    free(url->psz_url);
+    free(url->psz_user);
+    free(url->psz_password);
     free(url);
-    vlc_mutex_unlock(&host->lock);
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1208,6 +1510,7 @@ static void httpd_ClientInit(httpd_client_t *cl, vlc_tick_t now)
     cl->p_buffer = xmalloc(cl->i_buffer_size);
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
+    cl->i_chunks = 0;
 
     httpd_MsgInit(&cl->query);
     httpd_MsgInit(&cl->answer);
@@ -1227,6 +1530,7 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
 {
     vlc_list_remove(&cl->node);
     vlc_tls_Close(cl->sock);
+    httpd_ClientReleaseChunks(cl);
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
@@ -1263,6 +1567,37 @@ ssize_t httpd_NetSend (httpd_client_t *cl, const uint8_t *p, size_t i_len)
     return sock->ops->writev(sock, &iov, 1);
 }
 
+/* Sends the remaining data of the held stream chunks, in one call */
+static
+ssize_t httpd_NetSendChunks (httpd_client_t *cl)
+{
+    vlc_tls_t *sock = cl->sock;
+    struct iovec iov[HTTPD_STREAM_IOV_MAX];
+    size_t i_total = 0;
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < cl->i_chunks; i++)
+        i_total += cl->pp_chunks[i]->i_size;
+
+    /* Skip the data preceding the client position, and the data sent */
+    size_t i_skip = i_total - cl->i_buffer_size + cl->i_buffer;
+
+    for (unsigned i = 0; i < cl->i_chunks; i++) {
+        const httpd_stream_chunk *chunk = cl->pp_chunks[i];
+
+        if (i_skip >= chunk->i_size) {
+            i_skip -= chunk->i_size;
+            continue;
+        }
+
+        iov[n].iov_base = (void *)(chunk->p_data + i_skip);
+        iov[n].iov_len = chunk->i_size - i_skip;
+        i_skip = 0;
+        n++;
+    }
+    return sock->ops->writev(sock, iov, n);
+}
+
 
 static const struct
 {
@@ -1605,12 +1940,17 @@ static void httpd_ClientSend(httpd_client_t *cl)
         cl->i_buffer_size = (uint8_t*)p - cl->p_buffer;
     }
 
-    i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
-                           cl->i_buffer_size - cl->i_buffer);
+    if (cl->i_chunks > 0)
+        i_len = httpd_NetSendChunks(cl);
+    else
+        i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
+                              cl->i_buffer_size - cl->i_buffer);
     if (i_len >= 0) {
         cl->i_buffer += i_len;
 
         if (cl->i_buffer >= cl->i_buffer_size) {
+            httpd_ClientReleaseChunks(cl);
+
             if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
                 /* catch more body data */
                 int     i_msg = cl->query.i_type;
@@ -1621,6 +1961,8 @@ static void httpd_ClientSend(httpd_client_t *cl)
 
                 cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
                                           &cl->answer, &cl->query);
+                if (cl->i_state == HTTPD_CLIENT_DEAD)
+                    return; /* dropped by the callback */
             }
 
             if (cl->answer.i_body > 0) {
@@ -1699,272 +2041,527 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+/* Processes the state of a client before waiting for its socket */
+static void httpd_ClientPrepare(httpd_host_t *host, httpd_client_t *cl)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
-    unsigned nfd;
-    for (nfd = 0; nfd < host->nfd; nfd++) {
-        ufd[nfd].fd = host->fds[nfd];
-        ufd[nfd].events = POLLIN;
-        ufd[nfd].revents = 0;
+    int64_t i_offset;
+
+    switch (cl->i_state) {
+        default:
+            break;
+
+        case HTTPD_CLIENT_RECEIVE_DONE: {
+            httpd_message_t *answer = &cl->answer;
+            httpd_message_t *query  = &cl->query;
+
+            httpd_MsgInit(answer);
+
+            /* Handle what we received */
+            switch (query->i_type) {
+                case HTTPD_MSG_ANSWER:
+                    cl->url     = NULL;
+                    cl->i_state = HTTPD_CLIENT_DEAD;
+                    break;
+
+                case HTTPD_MSG_OPTIONS:
+                    answer->i_type   = HTTPD_MSG_ANSWER;
+                    answer->i_proto  = query->i_proto;
+                    answer->i_status = 200;
+                    answer->i_body = 0;
+                    answer->p_body = NULL;
+
+                    httpd_MsgAdd(answer, "Server", "VLC/%s", VERSION);
+                    httpd_MsgAdd(answer, "Content-Length", "0");
+
+                    switch(query->i_proto) {
+                    case HTTPD_PROTO_HTTP:
+                        answer->i_version = 1;
+                        httpd_MsgAdd(answer, "Allow", "GET,HEAD,POST,OPTIONS");
+                        break;
+
+                    case HTTPD_PROTO_RTSP:
+                        answer->i_version = 0;
+
+                        const char *p = httpd_MsgGet(query, "Cseq");
+                        if (p)
+                            httpd_MsgAdd(answer, "Cseq", "%s", p);
+                        p = httpd_MsgGet(query, "Timestamp");
+                        if (p)
+                            httpd_MsgAdd(answer, "Timestamp", "%s", p);
+
+                        p = httpd_MsgGet(query, "Require");
+                        if (p) {
+                            answer->i_status = 551;
+                            httpd_MsgAdd(query, "Unsupported", "%s", p);
+                        }
+
+                        httpd_MsgAdd(answer, "Public", "DESCRIBE,SETUP,"
+                                "TEARDOWN,PLAY,PAUSE,GET_PARAMETER");
+                        break;
+                    }
+
+                    if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+                        httpd_MsgAdd(answer, "Connection", "close");
+
+                    cl->i_buffer = -1;  /* Force the creation of the answer in
+                                         * httpd_ClientSend */
+                    cl->i_state = HTTPD_CLIENT_SENDING;
+                    break;
+
+                case HTTPD_MSG_NONE:
+                    if (query->i_proto == HTTPD_PROTO_NONE) {
+                        cl->url = NULL;
+                        cl->i_state = HTTPD_CLIENT_DEAD;
+                    } else {
+                        /* unimplemented */
+                        answer->i_proto  = query->i_proto ;
+                        answer->i_type   = HTTPD_MSG_ANSWER;
+                        answer->i_version= 0;
+                        answer->i_status = 501;
+
+                        char *p;
+                        answer->i_body = httpd_HtmlError (&p, 501, NULL);
+                        answer->p_body = (uint8_t *)p;
+                        httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
+                        httpd_MsgAdd(answer, "Connection", "close");
+
+                        cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
+                        cl->i_state = HTTPD_CLIENT_SENDING;
+                    }
+                    break;
+
+                default: {
+                    httpd_url_t *url;
+                    int i_msg = query->i_type;
+                    bool b_auth_failed = false;
+
+                    /* Search the url and trigger callbacks */
+                    vlc_mutex_lock(&host->lock);
+                    vlc_list_foreach(url, &host->urls, node) {
+                        if (strcmp(url->psz_url, query->psz_url))
+                            continue;
+                        if (!url->catch[i_msg].cb)
+                            continue;
+
+                        if (answer) {
+                            b_auth_failed = !httpdAuthOk(url->psz_user,
+                               url->psz_password,
+                               httpd_MsgGet(query, "Authorization")); /* BASIC id */
+                            if (b_auth_failed)
+                               break;
+                        }
+
+                        if (url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query))
+                            continue;
+
+                        if (answer->i_proto == HTTPD_PROTO_NONE)
+                            cl->i_buffer = cl->i_buffer_size; /* Raw answer from a CGI */
+                        else
+                            cl->i_buffer = -1;
+
+                        /* only one url can answer */
+                        answer = NULL;
+                        if (!cl->url)
+                            cl->url = url;
+                    }
+                    vlc_mutex_unlock(&host->lock);
+
+                    if (answer) {
+                        answer->i_proto  = query->i_proto;
+                        answer->i_type   = HTTPD_MSG_ANSWER;
+                        answer->i_version= 0;
+
+                       if (b_auth_failed) {
+                            httpd_MsgAdd(answer, "WWW-Authenticate",
+                                    "Basic realm=\"VLC stream\"");
+                            answer->i_status = 401;
+                        } else
+                            answer->i_status = 404; /* no url registered */
+
+                        char *p;
+                        answer->i_body = httpd_HtmlError (&p, answer->i_status,
+                                query->psz_url);
+                        answer->p_body = (uint8_t *)p;
+
+                        cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
+                        httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
+                        httpd_MsgAdd(answer, "Content-Type", "%s", "text/html");
+                        if (httpd_MsgGet(&cl->query, "Connection") != NULL)
+                            httpd_MsgAdd(answer, "Connection", "close");
+                    }
+
+                    cl->i_state = HTTPD_CLIENT_SENDING;
+                }
+            }
+            break;
+        }
+
+        case HTTPD_CLIENT_SEND_DONE:
+            if (!cl->b_stream_mode || cl->answer.i_body_offset == 0) {
+                bool do_close = false;
+
+                cl->url = NULL;
+
+                if (cl->query.i_proto != HTTPD_PROTO_HTTP
+                 || cl->query.i_version > 0)
+                {
+                    const char *psz_connection = httpd_MsgGet(&cl->answer,
+                                                             "Connection");
+                    if (psz_connection != NULL)
+                        do_close = !strcasecmp(psz_connection, "close");
+                }
+                else
+                    do_close = true;
+
+                if (!do_close) {
+                    httpd_MsgClean(&cl->query);
+                    httpd_MsgInit(&cl->query);
+
+                    cl->i_buffer = 0;
+                    cl->i_buffer_size = 1000;
+                    free(cl->p_buffer);
+                    // Allocate an extra byte for the null terminating byte
+                    cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
+                    cl->i_state = HTTPD_CLIENT_RECEIVING;
+                } else
+                    cl->i_state = HTTPD_CLIENT_DEAD;
+                httpd_MsgClean(&cl->answer);
+            } else {
+                i_offset = cl->answer.i_body_offset;
+                httpd_MsgClean(&cl->answer);
+
+                cl->answer.i_body_offset = i_offset;
+                free(cl->p_buffer);
+                cl->p_buffer = NULL;
+                cl->i_buffer = 0;
+                cl->i_buffer_size = 0;
+
+                cl->i_state = HTTPD_CLIENT_WAITING;
+            }
+            break;
+
+        case HTTPD_CLIENT_WAITING:
+            i_offset = cl->answer.i_body_offset;
+            int i_msg = cl->query.i_type;
+
+            httpd_MsgInit(&cl->answer);
+            cl->answer.i_body_offset = i_offset;
+
+            cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
+                    &cl->answer, &cl->query);
+            if (cl->answer.i_type != HTTPD_MSG_NONE) {
+                /* we have new data, so re-enter send mode */
+                cl->i_buffer      = 0;
+                cl->p_buffer      = cl->answer.p_body;
+                cl->i_buffer_size = cl->answer.i_body;
+                cl->answer.p_body = NULL;
+                cl->answer.i_body = 0;
+                cl->i_state = HTTPD_CLIENT_SENDING;
+            }
     }
+}
 
-    vlc_mutex_lock(&host->lock);
-    /* add all socket that should be read/write and close dead connection */
-    while (vlc_list_is_empty(&host->urls)) {
-        mutex_cleanup_push(&host->lock);
-        vlc_cond_wait(&host->wait, &host->lock);
-        vlc_cleanup_pop();
+static void httpd_ClientProcess(httpd_host_t *host, httpd_client_t *cl,
+                                vlc_tick_t now)
+{
+    cl->i_activity_date = now;
+
+    switch (cl->i_state) {
+        case HTTPD_CLIENT_RECEIVING: httpd_ClientRecv(cl); break;
+        case HTTPD_CLIENT_SENDING:   httpd_ClientSend(cl); break;
+        case HTTPD_CLIENT_TLS_HS_IN:
+        case HTTPD_CLIENT_TLS_HS_OUT:
+            httpd_ClientTlsHandshake(host, cl);
+            break;
     }
+}
 
-    vlc_tick_t now = vlc_tick_now();
-    bool b_low_delay = false;
-    httpd_client_t *cl;
+static void httpd_WorkerWake(struct httpd_worker *worker)
+{
+#ifndef _WIN32
+    static const uint64_t one = 1;
 
-    int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
-        int64_t i_offset;
+    if (write(worker->wakefd[1], &one, sizeof (one)) < 0) {
+        /* the pipe is full: the worker will wake up anyway */
+    }
+#else
+    /* single worker, never woken up by another thread */
+    (void) worker;
+    vlc_assert_unreachable();
+#endif
+}
+
+#ifndef _WIN32
+static void httpd_WorkerDrain(struct httpd_worker *worker)
+{
+    uint64_t buf[8];
+
+    while (read(worker->wakefd[0], buf, sizeof (buf)) > 0);
+}
+#endif
+
+/* Removes a client from its worker, and destroys it */
+static void httpd_WorkerRemoveClient(struct httpd_worker *worker,
+                                     httpd_client_t *cl)
+{
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_ctl(worker->epfd, EPOLL_CTL_DEL, vlc_tls_GetFD(cl->sock), NULL);
+#endif
+    worker->client_count--;
+    httpd_ClientDestroy(cl);
+}
 
+/* Hands a new client over to a worker. The worker must be locked. */
+static void httpd_WorkerAddClient(struct httpd_worker *worker,
+                                  httpd_client_t *cl)
+{
+    cl->i_poll_events = 0;
+    worker->client_count++;
+    vlc_list_append(&cl->node, &worker->clients);
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event ev = { .events = 0, .data.ptr = cl };
+
+    if (epoll_ctl(worker->epfd, EPOLL_CTL_ADD, vlc_tls_GetFD(cl->sock),
+                  &ev))
+        httpd_WorkerRemoveClient(worker, cl);
+#endif
+}
+
+static void httpd_HostAccept(httpd_host_t *host, struct httpd_worker *self,
+                             int fd, vlc_tick_t now)
+{
+    fd = vlc_accept (fd, NULL, NULL, true);
+    if (fd == -1)
+        return;
+    setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
+            &(int){ 1 }, sizeof(int));
+
+    vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
+    if (unlikely(sk == NULL))
+    {
+        vlc_close(fd);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+    {
+        const char *alpn[] = { "http/1.1", NULL };
+        vlc_tls_t *tls;
+
+        tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
+        if (tls == NULL)
+        {
+            vlc_tls_SessionDelete(sk);
+            return;
+        }
+        sk = tls;
+    }
+
+    httpd_client_t *cl = httpd_ClientNew(sk, now);
+    if (unlikely(cl == NULL))
+    {
+        vlc_tls_Close(sk);
+        return;
+    }
+
+    if (host->p_tls != NULL)
+        cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
+
+    /* Spread the clients across the workers */
+    unsigned i = atomic_fetch_add_explicit(&host->next_worker, 1,
+                                           memory_order_relaxed);
+    struct httpd_worker *worker = &host->workers[i % host->nworkers];
+
+    if (worker == self)
+        httpd_WorkerAddClient(worker, cl);
+    else
+    {
+        vlc_mutex_lock(&worker->lock);
+        httpd_WorkerAddClient(worker, cl);
+        vlc_mutex_unlock(&worker->lock);
+        httpd_WorkerWake(worker);
+    }
+}
+
+/**
+ * Runs the state machine of the clients of a worker, destroys the dead and
+ * inactive ones, and computes the events to wait for.
+ *
+ * \return whether a client is waiting for stream data
+ */
+static bool httpd_WorkerPrepare(struct httpd_worker *worker, vlc_tick_t now)
+{
+    httpd_host_t *host = worker->host;
+    httpd_client_t *cl;
+    bool b_low_delay = false;
+
+    vlc_list_foreach(cl, &worker->clients, node) {
         if (cl->i_state == HTTPD_CLIENT_DEAD
          || (cl->i_activity_timeout > 0
           && cl->i_activity_date + cl->i_activity_timeout < now)) {
-            host->client_count--;
-            httpd_ClientDestroy(cl);
+            httpd_WorkerRemoveClient(worker, cl);
             continue;
         }
 
-        struct pollfd *pufd = ufd + nfd;
-        assert (pufd < ufd + ARRAY_SIZE (ufd));
+        short events = 0;
 
-        pufd->events = pufd->revents = 0;
+        httpd_ClientPrepare(host, cl);
 
         switch (cl->i_state) {
             case HTTPD_CLIENT_RECEIVING:
             case HTTPD_CLIENT_TLS_HS_IN:
-                pufd->events = POLLIN;
+                events = POLLIN;
                 break;
 
             case HTTPD_CLIENT_SENDING:
             case HTTPD_CLIENT_TLS_HS_OUT:
-                pufd->events = POLLOUT;
+                events = POLLOUT;
                 break;
+        }
 
-            case HTTPD_CLIENT_RECEIVE_DONE: {
-                httpd_message_t *answer = &cl->answer;
-                httpd_message_t *query  = &cl->query;
+        vlc_tls_GetPollFD(cl->sock, &events);
 
-                httpd_MsgInit(answer);
+        if (events == 0)
+            b_low_delay = true;
 
-                /* Handle what we received */
-                switch (query->i_type) {
-                    case HTTPD_MSG_ANSWER:
-                        cl->url     = NULL;
-                        cl->i_state = HTTPD_CLIENT_DEAD;
-                        break;
+#ifdef HAVE_SYS_EPOLL_H
+        if (events != cl->i_poll_events) {
+            struct epoll_event ev = { .events = 0, .data.ptr = cl };
 
-                    case HTTPD_MSG_OPTIONS:
-                        answer->i_type   = HTTPD_MSG_ANSWER;
-                        answer->i_proto  = query->i_proto;
-                        answer->i_status = 200;
-                        answer->i_body = 0;
-                        answer->p_body = NULL;
+            if (events & POLLIN)
+                ev.events |= EPOLLIN;
+            if (events & POLLOUT)
+                ev.events |= EPOLLOUT;
+            epoll_ctl(worker->epfd, EPOLL_CTL_MOD, vlc_tls_GetFD(cl->sock),
+                      &ev);
+        }
+#endif
+        cl->i_poll_events = events;
+    }
+    return b_low_delay;
+}
 
-                        httpd_MsgAdd(answer, "Server", "VLC/%s", VERSION);
-                        httpd_MsgAdd(answer, "Content-Length", "0");
+static void httpd_WorkerWaitHost(httpd_host_t *host)
+{
+    vlc_mutex_lock(&host->lock);
+    while (vlc_list_is_empty(&host->urls)) {
+        mutex_cleanup_push(&host->lock);
+        vlc_cond_wait(&host->wait, &host->lock);
+        vlc_cleanup_pop();
+    }
+    vlc_mutex_unlock(&host->lock);
+}
 
-                        switch(query->i_proto) {
-                        case HTTPD_PROTO_HTTP:
-                            answer->i_version = 1;
-                            httpd_MsgAdd(answer, "Allow", "GET,HEAD,POST,OPTIONS");
-                            break;
+#ifdef HAVE_SYS_EPOLL_H
+#define HTTPD_EPOLL_EVENTS 256
 
-                        case HTTPD_PROTO_RTSP:
-                            answer->i_version = 0;
+static void httpdLoop(struct httpd_worker *worker)
+{
+    httpd_host_t *host = worker->host;
+    const bool b_listen = worker == host->workers;
+    struct epoll_event events[HTTPD_EPOLL_EVENTS];
 
-                            const char *p = httpd_MsgGet(query, "Cseq");
-                            if (p)
-                                httpd_MsgAdd(answer, "Cseq", "%s", p);
-                            p = httpd_MsgGet(query, "Timestamp");
-                            if (p)
-                                httpd_MsgAdd(answer, "Timestamp", "%s", p);
+    if (b_listen)
+        httpd_WorkerWaitHost(host);
 
-                            p = httpd_MsgGet(query, "Require");
-                            if (p) {
-                                answer->i_status = 551;
-                                httpd_MsgAdd(query, "Unsupported", "%s", p);
-                            }
+    int canc = vlc_savecancel();
+    vlc_mutex_lock(&worker->lock);
+    bool b_low_delay = httpd_WorkerPrepare(worker, vlc_tick_now());
+    vlc_mutex_unlock(&worker->lock);
+    vlc_restorecancel(canc);
 
-                            httpd_MsgAdd(answer, "Public", "DESCRIBE,SETUP,"
-                                    "TEARDOWN,PLAY,PAUSE,GET_PARAMETER");
-                            break;
-                        }
+    /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
+    int n = epoll_wait(worker->epfd, events, ARRAY_SIZE(events),
+                       b_low_delay ? 20 : -1);
+    if (n < 0) {
+        if (errno != EINTR)
+            msg_Err(host, "polling error: %s", vlc_strerror_c(errno));
+        return;
+    }
 
-                        if (httpd_MsgGet(&cl->query, "Connection") != NULL)
-                            httpd_MsgAdd(answer, "Connection", "close");
+    canc = vlc_savecancel();
+    vlc_mutex_lock(&worker->lock);
 
-                        cl->i_buffer = -1;  /* Force the creation of the answer in
-                                             * httpd_ClientSend */
-                        cl->i_state = HTTPD_CLIENT_SENDING;
-                        break;
+    vlc_tick_t now = vlc_tick_now();
 
-                    case HTTPD_MSG_NONE:
-                        if (query->i_proto == HTTPD_PROTO_NONE) {
-                            cl->url = NULL;
-                            cl->i_state = HTTPD_CLIENT_DEAD;
-                        } else {
-                            /* unimplemented */
-                            answer->i_proto  = query->i_proto ;
-                            answer->i_type   = HTTPD_MSG_ANSWER;
-                            answer->i_version= 0;
-                            answer->i_status = 501;
-
-                            char *p;
-                            answer->i_body = httpd_HtmlError (&p, 501, NULL);
-                            answer->p_body = (uint8_t *)p;
-                            httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
-                            httpd_MsgAdd(answer, "Connection", "close");
+    for (int i = 0; i < n; i++) {
+        void *ptr = events[i].data.ptr;
 
-                            cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
-                            cl->i_state = HTTPD_CLIENT_SENDING;
-                        }
-                        break;
+        if (ptr == worker->wakefd) {
+            httpd_WorkerDrain(worker);
+            continue;
+        }
 
-                    default: {
-                        httpd_url_t *url;
-                        int i_msg = query->i_type;
-                        bool b_auth_failed = false;
-
-                        /* Search the url and trigger callbacks */
-                        vlc_list_foreach(url, &host->urls, node) {
-                            if (strcmp(url->psz_url, query->psz_url))
-                                continue;
-                            if (!url->catch[i_msg].cb)
-                                continue;
-
-                            if (answer) {
-                                b_auth_failed = !httpdAuthOk(url->psz_user,
-                                   url->psz_password,
-                                   httpd_MsgGet(query, "Authorization")); /* BASIC id */
-                                if (b_auth_failed)
-                                   break;
-                            }
-
-                            if (url->catch[i_msg].cb(url->catch[i_msg].p_sys, cl, answer, query))
-                                continue;
-
-                            if (answer->i_proto == HTTPD_PROTO_NONE)
-                                cl->i_buffer = cl->i_buffer_size; /* Raw answer from a CGI */
-                            else
-                                cl->i_buffer = -1;
-
-                            /* only one url can answer */
-                            answer = NULL;
-                            if (!cl->url)
-                                cl->url = url;
-                        }
+        if (b_listen && (int *)ptr >= host->fds
+         && (int *)ptr < host->fds + host->nfd) {
+            /* accept new connections */
+            httpd_HostAccept(host, worker, *(int *)ptr, now);
+            continue;
+        }
 
-                        if (answer) {
-                            answer->i_proto  = query->i_proto;
-                            answer->i_type   = HTTPD_MSG_ANSWER;
-                            answer->i_version= 0;
-
-                           if (b_auth_failed) {
-                                httpd_MsgAdd(answer, "WWW-Authenticate",
-                                        "Basic realm=\"VLC stream\"");
-                                answer->i_status = 401;
-                            } else
-                                answer->i_status = 404; /* no url registered */
-
-                            char *p;
-                            answer->i_body = httpd_HtmlError (&p, answer->i_status,
-                                    query->psz_url);
-                            answer->p_body = (uint8_t *)p;
-
-                            cl->i_buffer = -1;  /* Force the creation of the answer in httpd_ClientSend */
-                            httpd_MsgAdd(answer, "Content-Length", "%d", answer->i_body);
-                            httpd_MsgAdd(answer, "Content-Type", "%s", "text/html");
-                            if (httpd_MsgGet(&cl->query, "Connection") != NULL)
-                                httpd_MsgAdd(answer, "Connection", "close");
-                        }
+        httpd_client_t *cl = ptr;
 
-                        cl->i_state = HTTPD_CLIENT_SENDING;
-                    }
-                }
-                break;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            /* also reported when not waiting for the client */
+            if (cl->i_poll_events == 0) {
+                cl->i_state = HTTPD_CLIENT_DEAD;
+                continue;
             }
+        }
+        httpd_ClientProcess(host, cl, now);
+    }
 
-            case HTTPD_CLIENT_SEND_DONE:
-                if (!cl->b_stream_mode || cl->answer.i_body_offset == 0) {
-                    bool do_close = false;
-
-                    cl->url = NULL;
+    vlc_mutex_unlock(&worker->lock);
+    vlc_restorecancel(canc);
+}
+#else
+static void httpdLoop(struct httpd_worker *worker)
+{
+    httpd_host_t *host = worker->host;
+    const unsigned nlisten = (worker == host->workers) ? host->nfd : 0;
 
-                    if (cl->query.i_proto != HTTPD_PROTO_HTTP
-                     || cl->query.i_version > 0)
-                    {
-                        const char *psz_connection = httpd_MsgGet(&cl->answer,
-                                                                 "Connection");
-                        if (psz_connection != NULL)
-                            do_close = !strcasecmp(psz_connection, "close");
-                    }
-                    else
-                        do_close = true;
-
-                    if (!do_close) {
-                        httpd_MsgClean(&cl->query);
-                        httpd_MsgInit(&cl->query);
-
-                        cl->i_buffer = 0;
-                        cl->i_buffer_size = 1000;
-                        free(cl->p_buffer);
-                        // Allocate an extra byte for the null terminating byte
-                        cl->p_buffer = xmalloc(cl->i_buffer_size + 1);
-                        cl->i_state = HTTPD_CLIENT_RECEIVING;
-                    } else
-                        cl->i_state = HTTPD_CLIENT_DEAD;
-                    httpd_MsgClean(&cl->answer);
-                } else {
-                    i_offset = cl->answer.i_body_offset;
-                    httpd_MsgClean(&cl->answer);
+    if (nlisten > 0)
+        httpd_WorkerWaitHost(host);
 
-                    cl->answer.i_body_offset = i_offset;
-                    free(cl->p_buffer);
-                    cl->p_buffer = NULL;
-                    cl->i_buffer = 0;
-                    cl->i_buffer_size = 0;
+    int canc = vlc_savecancel();
+    vlc_mutex_lock(&worker->lock);
 
-                    cl->i_state = HTTPD_CLIENT_WAITING;
-                }
-                break;
+    vlc_tick_t now = vlc_tick_now();
+    bool b_low_delay = httpd_WorkerPrepare(worker, now);
 
-            case HTTPD_CLIENT_WAITING:
-                i_offset = cl->answer.i_body_offset;
-                int i_msg = cl->query.i_type;
+#ifndef _WIN32
+    const unsigned nwake = 1;
+#else
+    const unsigned nwake = 0;
+#endif
+    struct pollfd ufd[nlisten + nwake + worker->client_count];
+    unsigned nfd;
+    httpd_client_t *cl;
 
-                httpd_MsgInit(&cl->answer);
-                cl->answer.i_body_offset = i_offset;
+    for (nfd = 0; nfd < nlisten; nfd++) {
+        ufd[nfd].fd = host->fds[nfd];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+    }
+#ifndef _WIN32
+    ufd[nfd].fd = worker->wakefd[0];
+    ufd[nfd].events = POLLIN;
+    ufd[nfd].revents = 0;
+    nfd++;
+#endif
 
-                cl->url->catch[i_msg].cb(cl->url->catch[i_msg].p_sys, cl,
-                        &cl->answer, &cl->query);
-                if (cl->answer.i_type != HTTPD_MSG_NONE) {
-                    /* we have new data, so re-enter send mode */
-                    cl->i_buffer      = 0;
-                    cl->p_buffer      = cl->answer.p_body;
-                    cl->i_buffer_size = cl->answer.i_body;
-                    cl->answer.p_body = NULL;
-                    cl->answer.i_body = 0;
-                    cl->i_state = HTTPD_CLIENT_SENDING;
-                }
-        }
+    vlc_list_foreach(cl, &worker->clients, node) {
+        struct pollfd *pufd = ufd + nfd;
+        assert (pufd < ufd + ARRAY_SIZE (ufd));
 
-        pufd->fd = vlc_tls_GetPollFD(cl->sock, &pufd->events);
+        pufd->events = cl->i_poll_events;
+        pufd->revents = 0;
+        pufd->fd = vlc_tls_GetFD(cl->sock);
 
         if (pufd->events != 0)
             nfd++;
-        else
-            b_low_delay = true;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&worker->lock);
     vlc_restorecancel(canc);
 
     /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
@@ -1975,91 +2572,54 @@ static void httpdLoop(httpd_host_t *host)
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
+    vlc_mutex_lock(&worker->lock);
+
+#ifndef _WIN32
+    if (ufd[nlisten].revents)
+        httpd_WorkerDrain(worker);
+#endif
 
     /* Handle client sockets */
     now = vlc_tick_now();
-    nfd = host->nfd;
+    nfd = nlisten + nwake;
 
-    vlc_list_foreach(cl, &host->clients, node) {
+    vlc_list_foreach(cl, &worker->clients, node) {
         const struct pollfd *pufd = &ufd[nfd];
 
-        assert(pufd < &ufd[ARRAY_SIZE(ufd)]);
+        assert(pufd <= &ufd[ARRAY_SIZE(ufd)]);
 
-        if (vlc_tls_GetFD(cl->sock) != pufd->fd)
+        if (pufd == &ufd[ARRAY_SIZE(ufd)]
+         || vlc_tls_GetFD(cl->sock) != pufd->fd)
             continue; // we were not waiting for this client
         ++nfd;
         if (pufd->revents == 0)
             continue; // no event received
 
-        cl->i_activity_date = now;
-
-        switch (cl->i_state) {
-            case HTTPD_CLIENT_RECEIVING: httpd_ClientRecv(cl); break;
-            case HTTPD_CLIENT_SENDING:   httpd_ClientSend(cl); break;
-            case HTTPD_CLIENT_TLS_HS_IN:
-            case HTTPD_CLIENT_TLS_HS_OUT:
-                httpd_ClientTlsHandshake(host, cl);
-                break;
-        }
+        httpd_ClientProcess(host, cl, now);
     }
 
     /* Handle server sockets (accept new connections) */
-    for (nfd = 0; nfd < host->nfd; nfd++) {
-        int fd = ufd[nfd].fd;
-
-        assert (fd == host->fds[nfd]);
+    for (nfd = 0; nfd < nlisten; nfd++) {
+        assert (ufd[nfd].fd == host->fds[nfd]);
 
         if (ufd[nfd].revents == 0)
             continue;
 
-        /* */
-        fd = vlc_accept (fd, NULL, NULL, true);
-        if (fd == -1)
-            continue;
-        setsockopt (fd, SOL_SOCKET, SO_REUSEADDR,
-                &(int){ 1 }, sizeof(int));
-
-        vlc_tls_t *sk = vlc_tls_SocketOpen(fd);
-        if (unlikely(sk == NULL))
-        {
-            vlc_close(fd);
-            continue;
-        }
-
-        if (host->p_tls != NULL)
-        {
-            const char *alpn[] = { "http/1.1", NULL };
-            vlc_tls_t *tls;
-
-            tls = vlc_tls_ServerSessionCreate(host->p_tls, sk, alpn);
-            if (tls == NULL)
-            {
-                vlc_tls_SessionDelete(sk);
-                continue;
-            }
-            sk = tls;
-        }
-
-        cl = httpd_ClientNew(sk, now);
-
-        if (host->p_tls != NULL)
-            cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
-
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+        httpd_HostAccept(host, worker, ufd[nfd].fd, now);
     }
 
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&worker->lock);
     vlc_restorecancel(canc);
 }
+#endif
 
 static void* httpd_HostThread(void *data)
 {
-    httpd_host_t *host = data;
+    struct httpd_worker *worker = data;
+    httpd_host_t *host = worker->host;
 
     while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+        httpdLoop(worker);
     return NULL;
 }
 
@@ -0,0 +1,301 @@
+/*****************************************************************************
+ * block_fifo.c: Test and benchmark for the block FIFOs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define BLOCK_SIZE 1316
+#define MAX_THREADS 8
+
+static unsigned char payload[BLOCK_SIZE];
+
+static void FreeNothing(block_t *block)
+{
+    (void) block; /* owned by the producer array */
+}
+
+static const struct vlc_block_callbacks cbs = { FreeNothing };
+
+static void InitBlocks(block_t *blocks, unsigned count)
+{
+    for (unsigned i = 0; i < count; i++)
+    {
+        block_Init(&blocks[i], &cbs, payload, sizeof (payload));
+        blocks[i].i_dts = VLC_TICK_0 + i;
+    }
+}
+
+static void test_spsc_api(void)
+{
+    block_t blocks[200];
+    vlc_spsc_fifo_t *fifo = vlc_spsc_fifo_New();
+
+    assert(fifo != NULL);
+    InitBlocks(blocks, ARRAY_SIZE(blocks));
+    assert(vlc_spsc_fifo_IsEmpty(fifo));
+    assert(vlc_spsc_fifo_Dequeue(fifo) == NULL);
+    assert(vlc_spsc_fifo_Queue(fifo, NULL) == VLC_SUCCESS);
+
+    /* Chains span segments and are split into blocks */
+    block_t *chain = NULL, **pp = &chain;
+    for (unsigned i = 0; i < ARRAY_SIZE(blocks); i++)
+        block_ChainLastAppend(&pp, &blocks[i]);
+    assert(vlc_spsc_fifo_Queue(fifo, chain) == VLC_SUCCESS);
+    assert(vlc_spsc_fifo_GetCount(fifo) == ARRAY_SIZE(blocks));
+    assert(vlc_spsc_fifo_GetBytes(fifo) == ARRAY_SIZE(blocks) * BLOCK_SIZE);
+
+    for (unsigned i = 0; i < 100; i++)
+    {
+        block_t *block = vlc_spsc_fifo_Get(fifo);
+        assert(block == &blocks[i]);
+        assert(block->p_next == NULL);
+    }
+    assert(vlc_spsc_fifo_GetCount(fifo) == ARRAY_SIZE(blocks) - 100);
+    assert(vlc_spsc_fifo_GetBytes(fifo) ==
+           (ARRAY_SIZE(blocks) - 100) * BLOCK_SIZE);
+
+    chain = vlc_spsc_fifo_DequeueAll(fifo);
+    for (unsigned i = 100; i < ARRAY_SIZE(blocks); i++)
+    {
+        assert(chain == &blocks[i]);
+        chain = chain->p_next;
+    }
+    assert(chain == NULL);
+    assert(vlc_spsc_fifo_IsEmpty(fifo));
+    assert(vlc_spsc_fifo_GetBytes(fifo) == 0);
+
+    /* Left-over blocks are released */
+    assert(vlc_spsc_fifo_Queue(fifo, &blocks[0]) == VLC_SUCCESS);
+    vlc_spsc_fifo_Delete(fifo);
+}
+
+static void *GetThread(void *data)
+{
+    vlc_spsc_fifo_t *fifo = data;
+
+    for (;;)
+    {
+        block_t *block = vlc_spsc_fifo_Get(fifo);
+        block_Release(block);
+    }
+    vlc_assert_unreachable();
+}
+
+static void test_spsc_cancel(vlc_tick_t delay)
+{
+    vlc_spsc_fifo_t *fifo = vlc_spsc_fifo_New();
+    vlc_thread_t th;
+    void *ret;
+
+    assert(fifo != NULL);
+    assert(vlc_clone(&th, GetThread, fifo, VLC_THREAD_PRIORITY_LOW) == 0);
+    /* with a delay, the consumer is most likely asleep in the wait */
+    if (delay > 0)
+        vlc_tick_sleep(delay);
+    vlc_cancel(th);
+    vlc_join(th, &ret);
+    assert(ret == VLC_THREAD_CANCELED);
+    vlc_spsc_fifo_Delete(fifo);
+}
+
+/*
+ * Benchmark
+ *
+ * Each producer pushes its blocks one at a time, as a packetizer or an
+ * access would. The block FIFO is measured shared by all threads, and with
+ * one FIFO per producer/consumer pair, which is the only arrangement the
+ * SPSC FIFO allows.
+ */
+enum bench_mode
+{
+    MODE_SHARED,
+    MODE_PAIRED,
+    MODE_SPSC,
+};
+
+static const char *const mode_names[] = {
+    "fifo shared", "fifo paired", "spsc paired",
+};
+
+struct bench_thread
+{
+    enum bench_mode mode;
+    void *fifo;
+    block_t *blocks;
+    unsigned count;
+    unsigned long received;
+    vlc_thread_t thread;
+};
+
+static void Put(enum bench_mode mode, void *fifo, block_t *block)
+{
+    if (mode == MODE_SPSC)
+        assert(vlc_spsc_fifo_Queue(fifo, block) == VLC_SUCCESS);
+    else
+        block_FifoPut(fifo, block);
+}
+
+static void *Produce(void *data)
+{
+    struct bench_thread *p = data;
+
+    for (unsigned i = 0; i < p->count; i++)
+        Put(p->mode, p->fifo, &p->blocks[i]);
+    /* End of stream marker */
+    if (p->mode != MODE_SHARED)
+        Put(p->mode, p->fifo, &p->blocks[p->count]);
+    return NULL;
+}
+
+static void *Consume(void *data)
+{
+    struct bench_thread *c = data;
+
+    for (;;)
+    {
+        block_t *block = c->mode == MODE_SPSC ? vlc_spsc_fifo_Get(c->fifo)
+                                              : block_FifoGet(c->fifo);
+        if (block->i_dts == VLC_TICK_INVALID)
+            break;
+        /* Order is only kept between two threads */
+        if (c->mode != MODE_SHARED)
+            assert(block->i_dts == VLC_TICK_0 + (vlc_tick_t)c->received);
+        c->received++;
+        block_Release(block);
+    }
+    return NULL;
+}
+
+static void Bench(enum bench_mode mode, unsigned threads, unsigned count)
+{
+    struct bench_thread producers[MAX_THREADS], consumers[MAX_THREADS];
+    block_t *blocks = malloc(threads * (count + 1) * sizeof (*blocks));
+    block_fifo_t *shared = NULL;
+
+    assert(blocks != NULL);
+    if (mode == MODE_SHARED)
+    {
+        shared = block_FifoNew();
+        assert(shared != NULL);
+    }
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        void *fifo = shared;
+
+        if (mode == MODE_PAIRED)
+            fifo = block_FifoNew();
+        else if (mode == MODE_SPSC)
+            fifo = vlc_spsc_fifo_New();
+        assert(fifo != NULL);
+
+        producers[i].mode = consumers[i].mode = mode;
+        producers[i].fifo = consumers[i].fifo = fifo;
+        producers[i].blocks = blocks + i * (count + 1);
+        producers[i].count = count;
+        consumers[i].received = 0;
+        InitBlocks(producers[i].blocks, count + 1);
+        producers[i].blocks[count].i_dts = VLC_TICK_INVALID;
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        assert(vlc_clone(&consumers[i].thread, Consume, &consumers[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+        assert(vlc_clone(&producers[i].thread, Produce, &producers[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    }
+    for (unsigned i = 0; i < threads; i++)
+        vlc_join(producers[i].thread, NULL);
+    if (mode == MODE_SHARED)
+        for (unsigned i = 0; i < threads; i++)
+            block_FifoPut(shared, &blocks[i * (count + 1) + count]);
+
+    unsigned long total = 0;
+    for (unsigned i = 0; i < threads; i++)
+    {
+        vlc_join(consumers[i].thread, NULL);
+        total += consumers[i].received;
+    }
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    assert(total == (unsigned long)threads * count);
+    printf("%s %ux%u: %8.3f Mblocks/s\n", mode_names[mode], threads, threads,
+           (double)total / (double)US_FROM_VLC_TICK(elapsed + 1));
+
+    for (unsigned i = 0; i < threads; i++)
+    {
+        if (mode == MODE_PAIRED)
+        {
+            vlc_fifo_Lock(producers[i].fifo);
+            assert(vlc_fifo_IsEmpty(producers[i].fifo));
+            vlc_fifo_Unlock(producers[i].fifo);
+            block_FifoRelease(producers[i].fifo);
+        }
+        else if (mode == MODE_SPSC)
+        {
+            assert(vlc_spsc_fifo_IsEmpty(producers[i].fifo));
+            vlc_spsc_fifo_Delete(producers[i].fifo);
+        }
+    }
+    if (shared != NULL)
+    {
+        vlc_fifo_Lock(shared);
+        assert(vlc_fifo_IsEmpty(shared));
+        vlc_fifo_Unlock(shared);
+        block_FifoRelease(shared);
+    }
+    free(blocks);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned count = 20000;
+    unsigned max_threads = 4;
+
+    /* Keep the default run short for make check */
+    if (argc > 1)
+        count = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        max_threads = strtoul(argv[2], NULL, 0);
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+
+    test_spsc_api();
+    test_spsc_cancel(0);
+    test_spsc_cancel(VLC_TICK_FROM_MS(20));
+
+    for (unsigned n = 1; n <= max_threads; n++)
+        for (unsigned m = MODE_SHARED; m <= MODE_SPSC; m++)
+            Bench(m, n, count);
+    return 0;
+}
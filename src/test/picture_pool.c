@@ -23,6 +23,8 @@
 #endif
 
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #undef NDEBUG
 #include <assert.h>
 
@@ -31,6 +33,8 @@
 #include <vlc_picture_pool.h>
 
 #define PICTURES 10
+#define BIG_PICTURES 300
+#define MAX_THREADS 8
 
 const char vlc_module_name[] = "test_picture_pool";
 
@@ -108,8 +112,198 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
-int main(void)
+static void test_big(void)
 {
+    picture_t *pics[BIG_PICTURES];
+    picture_pool_t *big = picture_pool_NewFromFormat(&fmt, BIG_PICTURES);
+
+    assert(big != NULL);
+    assert(picture_pool_GetSize(big) == BIG_PICTURES);
+
+    for (unsigned i = 0; i < BIG_PICTURES; i++) {
+        pics[i] = picture_pool_Get(big);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[j]->p[0].p_pixels != pics[i]->p[0].p_pixels);
+    }
+    assert(picture_pool_Get(big) == NULL);
+
+    /* Free pictures in the last word are found */
+    void *plane = pics[BIG_PICTURES - 1]->p[0].p_pixels;
+    picture_Release(pics[BIG_PICTURES - 1]);
+    pics[BIG_PICTURES - 1] = picture_pool_Get(big);
+    assert(pics[BIG_PICTURES - 1] != NULL);
+    assert(pics[BIG_PICTURES - 1]->p[0].p_pixels == plane);
+
+    for (unsigned i = 0; i < BIG_PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(big);
+}
+
+static void *WaitThread(void *data)
+{
+    return picture_pool_Wait(data);
+}
+
+static void test_wait(void)
+{
+    picture_t *pics[PICTURES];
+    vlc_thread_t th;
+    void *ret;
+
+    pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < PICTURES; i++) {
+        pics[i] = picture_pool_Wait(pool);
+        assert(pics[i] != NULL);
+    }
+
+    /* A release wakes the waiter up */
+    assert(vlc_clone(&th, WaitThread, pool, VLC_THREAD_PRIORITY_LOW) == 0);
+    picture_Release(pics[0]);
+    vlc_join(th, &ret);
+    assert(ret != NULL);
+    pics[0] = ret;
+
+    /* Cancellation wakes the waiter up */
+    assert(vlc_clone(&th, WaitThread, pool, VLC_THREAD_PRIORITY_LOW) == 0);
+    picture_pool_Cancel(pool, true);
+    vlc_join(th, &ret);
+    assert(ret == NULL);
+
+    /* Only free pictures are returned while canceled */
+    picture_Release(pics[0]);
+    assert(picture_pool_Get(pool) == NULL);
+    pics[0] = picture_pool_Wait(pool);
+    assert(pics[0] != NULL);
+    assert(picture_pool_Wait(pool) == NULL);
+
+    picture_pool_Cancel(pool, false);
+    picture_Release(pics[0]);
+    pics[0] = picture_pool_Get(pool);
+    assert(pics[0] != NULL);
+
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
+/*
+ * Stress benchmark
+ *
+ * Each decoder thread waits for pictures from the shared pool and hands
+ * them to its own display thread, which releases them, as the decoders and
+ * video outputs of several streams sharing one pool would.
+ */
+struct bench_thread
+{
+    picture_pool_t *pool;
+    picture_t *queue[16];
+    unsigned head, tail;
+    unsigned count;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_thread_t decoder, display;
+};
+
+static void *Decode(void *data)
+{
+    struct bench_thread *t = data;
+
+    for (unsigned i = 0; i < t->count; i++) {
+        picture_t *pic = picture_pool_Wait(t->pool);
+        assert(pic != NULL);
+
+        vlc_mutex_lock(&t->lock);
+        while (t->tail - t->head >= ARRAY_SIZE(t->queue))
+            vlc_cond_wait(&t->wait, &t->lock);
+        t->queue[t->tail++ % ARRAY_SIZE(t->queue)] = pic;
+        vlc_cond_signal(&t->wait);
+        vlc_mutex_unlock(&t->lock);
+    }
+    return NULL;
+}
+
+static void *Display(void *data)
+{
+    struct bench_thread *t = data;
+
+    for (unsigned i = 0; i < t->count; i++) {
+        vlc_mutex_lock(&t->lock);
+        while (t->tail == t->head)
+            vlc_cond_wait(&t->wait, &t->lock);
+        picture_t *pic = t->queue[t->head++ % ARRAY_SIZE(t->queue)];
+        vlc_cond_signal(&t->wait);
+        vlc_mutex_unlock(&t->lock);
+
+        picture_Release(pic);
+    }
+    return NULL;
+}
+
+static void bench(unsigned size, unsigned threads, unsigned count)
+{
+    struct bench_thread t[MAX_THREADS];
+    video_format_t small;
+
+    /* Tiny pictures: this measures the pool, not the allocator */
+    video_format_Setup(&small, VLC_CODEC_I420, 16, 16, 16, 16, 1, 1);
+    picture_pool_t *p = picture_pool_NewFromFormat(&small, size);
+    assert(p != NULL);
+
+    for (unsigned i = 0; i < threads; i++) {
+        t[i].pool = p;
+        t[i].head = t[i].tail = 0;
+        t[i].count = count;
+        vlc_mutex_init(&t[i].lock);
+        vlc_cond_init(&t[i].wait);
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < threads; i++) {
+        assert(vlc_clone(&t[i].display, Display, &t[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+        assert(vlc_clone(&t[i].decoder, Decode, &t[i],
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        vlc_join(t[i].decoder, NULL);
+        vlc_join(t[i].display, NULL);
+    }
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("pool %4u pictures, %u threads: %8.3f Mpictures/s\n", size,
+           threads, (double)threads * count
+                    / (double)US_FROM_VLC_TICK(elapsed + 1));
+
+    /* All pictures are back */
+    picture_t *pics[size];
+    for (unsigned i = 0; i < size; i++) {
+        pics[i] = picture_pool_Get(p);
+        assert(pics[i] != NULL);
+    }
+    assert(picture_pool_Get(p) == NULL);
+    for (unsigned i = 0; i < size; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(p);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned count = 20000;
+    unsigned max_threads = 4;
+
+    /* Keep the default run short for make check */
+    if (argc > 1)
+        count = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        max_threads = strtoul(argv[2], NULL, 0);
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
 
     pool = picture_pool_NewFromFormat(&fmt, PICTURES);
@@ -124,6 +318,13 @@ int main(void)
 
     test(false);
     test(true);
+    test_big();
+    test_wait();
+
+    static const unsigned sizes[] = { 8, 64, 256 };
+    for (unsigned i = 0; i < ARRAY_SIZE(sizes); i++)
+        for (unsigned n = 1; n <= max_threads; n++)
+            bench(sizes[i], n, count);
 
     return 0;
 }
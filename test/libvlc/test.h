@@ -64,6 +64,13 @@ static const char test_default_video[] = SRCDIR"/samples/image.jpg";
 
 #define test_log( ... ) printf( "testapi: " __VA_ARGS__ );
 
+/* Reads a tuning parameter of a test or benchmark from the environment */
+static inline unsigned test_getenv_uint(const char *name, unsigned def)
+{
+    const char *str = getenv(name);
+    return (str != NULL) ? strtoul(str, NULL, 10) : def;
+}
+
 static inline void on_timeout(int signum)
 {
     assert(signum == SIGALRM);
@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * rtp_queue.c: RTP session re-ordering queue benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Replays a synthetic packet list, as received from a 2022-style MPEG-TS
+ * over RTP source with some re-ordering, through the RTP session layer.
+ * Packets are queued one at a time, then in batches as from recvmmsg().
+ * Tunables (environment):
+ *  VLC_RTP_PACKETS  number of packets (default 200000)
+ *  VLC_RTP_DEPTH    packets held in the jitter buffer (default 1000)
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+
+#include "../../../modules/access/rtp/rtp.h"
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define TEST_PAYLOAD_TYPE 33
+#define TEST_PACKET_SIZE (12 + 7 * 188)
+#define TEST_BATCH 32
+
+static size_t decoded;
+
+static void *test_init_pt(demux_t *demux)
+{
+    VLC_UNUSED(demux);
+    return NULL;
+}
+
+static void test_destroy_pt(demux_t *demux, void *data)
+{
+    VLC_UNUSED(demux); VLC_UNUSED(data);
+}
+
+static void test_decode_pt(demux_t *demux, void *data, block_t *block)
+{
+    VLC_UNUSED(demux); VLC_UNUSED(data);
+    decoded++;
+    block_Release(block);
+}
+
+/* Sequence number of the n-th received packet: mostly in order, with
+ * neighbouring packets swapped every now and then (within a batch). */
+static uint16_t test_seq(unsigned n)
+{
+    if ((n / TEST_BATCH) % 3 == 0)
+    {
+        if (n % TEST_BATCH == 5)
+            return n + 1;
+        if (n % TEST_BATCH == 6)
+            return n - 1;
+    }
+    return n;
+}
+
+static block_t *test_packet(unsigned n)
+{
+    block_t *block = block_Alloc(TEST_PACKET_SIZE);
+    assert(block != NULL);
+
+    uint16_t seq = test_seq(n);
+
+    block->p_buffer[0] = 0x80;
+    block->p_buffer[1] = TEST_PAYLOAD_TYPE;
+    SetWBE(block->p_buffer + 2, seq);
+    SetDWBE(block->p_buffer + 4, seq * 900u);
+    SetDWBE(block->p_buffer + 8, 0x12345678);
+    memset(block->p_buffer + 12, 0x47, TEST_PACKET_SIZE - 12);
+    return block;
+}
+
+static vlc_tick_t test_run(demux_t *demux, block_t **packets, unsigned count,
+                           unsigned depth, bool batch)
+{
+    rtp_session_t *session = rtp_session_create(demux);
+    assert(session != NULL);
+
+    static const rtp_pt_t pt = {
+        .init = test_init_pt,
+        .destroy = test_destroy_pt,
+        .decode = test_decode_pt,
+        .frequency = 90000,
+        .number = TEST_PAYLOAD_TYPE,
+    };
+    int ret = rtp_add_type(demux, session, &pt);
+    assert(ret == 0);
+
+    decoded = 0;
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < count; i += TEST_BATCH)
+    {
+        unsigned n = __MIN(TEST_BATCH, count - i);
+
+        if (batch)
+            rtp_queue_batch(demux, session, packets + i, n);
+        else
+            for (unsigned j = 0; j < n; j++)
+                rtp_queue(demux, session, packets[i + j]);
+
+        /* Keep the jitter buffer filled, as when waiting for a lost packet */
+        if ((i + n) % depth < TEST_BATCH)
+            rtp_dequeue_force(demux, session);
+    }
+    rtp_dequeue_force(demux, session);
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    rtp_session_destroy(demux, session);
+    return elapsed;
+}
+
+int main(void)
+{
+    unsigned count = test_getenv_uint("VLC_RTP_PACKETS", 200000);
+    unsigned depth = test_getenv_uint("VLC_RTP_DEPTH", 1000);
+
+    test_init();
+
+    const char *argv[] = { "-v" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    demux_t *demux = vlc_object_create(vlc->p_libvlc_int, sizeof (*demux));
+    assert(demux != NULL);
+
+    demux_sys_t sys = {
+        .timeout = VLC_TICK_FROM_SEC(60),
+        .max_dropout = 3000,
+        .max_misorder = 100,
+        .max_src = 1,
+    };
+    demux->p_sys = &sys;
+
+    block_t **packets = malloc(count * sizeof (*packets));
+    assert(packets != NULL);
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool batch = pass != 0;
+
+        for (unsigned i = 0; i < count; i++)
+            packets[i] = test_packet(i);
+
+        vlc_tick_t elapsed = test_run(demux, packets, count, depth, batch);
+        double secs = secf_from_vlc_tick(elapsed);
+
+        printf("%s: %u packets (depth %u) in %.3f s, %.0f packets/s\n",
+               batch ? "batch" : "single", count, depth, secs,
+               count / secs);
+        assert(decoded == count);
+    }
+
+    free(packets);
+    vlc_object_delete(demux);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,366 @@
+/*****************************************************************************
+ * dash_latency.c: adaptive streaming startup and rebuffering benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Serves a synthetic DASH presentation of MPEG-TS segments from the HTTP
+ * server on the loopback, delaying each answer by a fixed latency plus the
+ * transfer time at a given bandwidth, and plays it. From the times the
+ * segments were served, it reports the startup time and the rebuffering a
+ * player starting with the first segment would have had.
+ *
+ * Environment variables:
+ *  VLC_DASH_LATENCY: latency per request in ms (default: 300)
+ *  VLC_DASH_BANDWIDTH: bandwidth per request in kbit/s (default: 2400)
+ *  VLC_DASH_SEGMENTS: number of 2 s segments (default: 20)
+ * The adaptive options, such as --adaptive-lookahead, can be given on the
+ * command line.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_httpd.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+#include "../../src/ts_gen.h"
+
+#include <vlc/vlc.h>
+
+#define TEST_PORT 18082
+#define BITRATE (2 * 1000 * 1000)
+#define FRAME_RATE 25
+#define FRAME_SIZE (BITRATE / 8 / FRAME_RATE)
+#define SEGMENT_DURATION 2 /* seconds */
+#define PID_PMT 0x1000
+#define PID_VIDEO 0x100
+
+struct fixture
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    vlc_tick_t  latency;
+    unsigned    bandwidth; /* bit/s */
+    unsigned    requests;
+    unsigned    served_count;
+    vlc_tick_t *served; /* per segment, 0 until served */
+    bool        ended;
+};
+
+struct httpd_file_sys_t
+{
+    struct fixture *fx;
+    int             index; /* -1 for the manifest */
+    uint8_t        *data;
+    size_t          size;
+    httpd_file_t   *file;
+};
+
+/* Synthetic stream, generated at once so that the continuity counters and
+ * timestamps follow through the segments */
+struct generator
+{
+    uint8_t  *data;
+    size_t    size;
+    uint64_t  frame;
+    uint8_t   cc[3]; /* PAT, PMT, video */
+};
+
+static uint8_t *NewPacket(struct generator *gen, unsigned pid, bool start,
+                          uint8_t *cc)
+{
+    uint8_t *p = &gen->data[gen->size];
+
+    gen->size += TS_PACKET_SIZE;
+    memset(p, 0, TS_PACKET_SIZE);
+    ts_write_header(p, pid, start, cc);
+    return p;
+}
+
+static void WriteSection(struct generator *gen, unsigned pid, uint8_t *cc,
+                         const uint8_t *section, size_t size)
+{
+    ts_write_section(&gen->data[gen->size], pid, cc, section, size);
+    gen->size += TS_PACKET_SIZE;
+}
+
+static void WriteTables(struct generator *gen)
+{
+    const uint8_t pat[] = {
+        0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0x00, 0x01, 0xe0 | (PID_PMT >> 8), PID_PMT & 0xff,
+    };
+    const uint8_t pmt[] = {
+        0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00,
+        0x02, 0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00,
+    };
+
+    WriteSection(gen, 0, &gen->cc[0], pat, sizeof (pat));
+    WriteSection(gen, PID_PMT, &gen->cc[1], pmt, sizeof (pmt));
+}
+
+static void WriteFrame(struct generator *gen)
+{
+    const uint64_t ts = 90000 * gen->frame / FRAME_RATE;
+    uint8_t *p = NewPacket(gen, PID_VIDEO, true, &gen->cc[2]);
+
+    p[3] |= 0x20; /* adaptation field */
+    p[4] = 7;
+    p[5] = 0x10; /* PCR */
+    p[6] = ts >> 25;
+    p[7] = ts >> 17;
+    p[8] = ts >> 9;
+    p[9] = ts >> 1;
+    p[10] = ((ts & 1) << 7) | 0x7e;
+
+    uint8_t *pes = &p[12];
+    pes[2] = 0x01; pes[3] = 0xe0;
+    pes[6] = 0x80;
+    pes[7] = 0xc0; /* PTS and DTS */
+    pes[8] = 10;
+    ts_write_timestamp(&pes[9], 3, ts + 9000);
+    ts_write_timestamp(&pes[14], 1, ts);
+    pes[19 + 2] = 0x01; /* picture start code */
+
+    /* the rest of the frame is zeroes */
+    for (size_t left = FRAME_SIZE - (TS_PACKET_SIZE - 12 - 19); left > 0;)
+    {
+        NewPacket(gen, PID_VIDEO, false, &gen->cc[2]);
+        left -= __MIN(left, TS_PACKET_SIZE - 4);
+    }
+    gen->frame++;
+}
+
+static void GenerateSegment(struct generator *gen, struct httpd_file_sys_t *sys)
+{
+    const unsigned frames = FRAME_RATE * SEGMENT_DURATION;
+    const size_t packets = 2 + frames
+                         * (1 + (FRAME_SIZE + TS_PACKET_SIZE - 5) / (TS_PACKET_SIZE - 4));
+
+    gen->data = malloc(packets * TS_PACKET_SIZE);
+    assert(gen->data != NULL);
+    gen->size = 0;
+
+    WriteTables(gen);
+    for (unsigned i = 0; i < frames; i++)
+        WriteFrame(gen);
+    assert(gen->size <= packets * TS_PACKET_SIZE);
+
+    sys->data = gen->data;
+    sys->size = gen->size;
+}
+
+static int Fill(httpd_file_sys_t *sys, httpd_file_t *file, uint8_t *request,
+                uint8_t **datap, int *sizep)
+{
+    struct fixture *fx = sys->fx;
+    (void) file; (void) request;
+
+    vlc_tick_sleep(fx->latency
+                   + vlc_tick_from_samples((uint64_t)sys->size * 8,
+                                           fx->bandwidth));
+
+    *datap = malloc(sys->size);
+    if (*datap == NULL)
+        return VLC_ENOMEM;
+    memcpy(*datap, sys->data, sys->size);
+    *sizep = sys->size;
+
+    vlc_mutex_lock(&fx->lock);
+    fx->requests++;
+    if (sys->index >= 0 && fx->served[sys->index] == 0)
+    {
+        fx->served[sys->index] = vlc_tick_now();
+        fx->served_count++;
+    }
+    vlc_cond_signal(&fx->wait);
+    vlc_mutex_unlock(&fx->lock);
+    return VLC_SUCCESS;
+}
+
+static void OnEvent(const libvlc_event_t *event, void *data)
+{
+    struct fixture *fx = data;
+    (void) event;
+
+    vlc_mutex_lock(&fx->lock);
+    fx->ended = true;
+    vlc_cond_signal(&fx->wait);
+    vlc_mutex_unlock(&fx->lock);
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned segments = test_getenv_uint("VLC_DASH_SEGMENTS", 20);
+    const char *args[test_defaults_nargs + argc + 2];
+    char port_arg[32];
+    int nargs = 0;
+
+    test_init();
+
+    snprintf(port_arg, sizeof (port_arg), "--http-port=%u", TEST_PORT);
+    for (int i = 0; i < test_defaults_nargs; i++)
+        args[nargs++] = test_defaults_args[i];
+    args[nargs++] = port_arg;
+    /* let concurrent downloads be served concurrently */
+    args[nargs++] = "--http-threads=8";
+    for (int i = 1; i < argc; i++)
+        args[nargs++] = argv[i];
+
+    libvlc_instance_t *vlc = libvlc_new(nargs, args);
+    assert(vlc != NULL);
+
+    struct fixture fx = {
+        .latency = VLC_TICK_FROM_MS(test_getenv_uint("VLC_DASH_LATENCY", 300)),
+        .bandwidth = test_getenv_uint("VLC_DASH_BANDWIDTH", 2400) * 1000,
+    };
+    vlc_mutex_init(&fx.lock);
+    vlc_cond_init(&fx.wait);
+    fx.served = calloc(segments, sizeof (*fx.served));
+    assert(fx.served != NULL && fx.bandwidth > 0);
+
+    httpd_host_t *host = vlc_http_HostNew(VLC_OBJECT(vlc->p_libvlc_int));
+    assert(host != NULL);
+
+    /* Manifest */
+    struct httpd_file_sys_t manifest = { .fx = &fx, .index = -1 };
+    char *mpd;
+    int len = asprintf(&mpd,
+        "<?xml version=\"1.0\"?>\n"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"static\""
+        " profiles=\"urn:mpeg:dash:profile:mp2t-simple:2011\""
+        " mediaPresentationDuration=\"PT%uS\" minBufferTime=\"PT%uS\">\n"
+        " <Period>\n"
+        "  <AdaptationSet mimeType=\"video/mp2t\">\n"
+        "   <Representation id=\"1\" bandwidth=\"%u\">\n"
+        "    <SegmentTemplate media=\"seg-$Number$.ts\" startNumber=\"0\""
+        " duration=\"%u\" timescale=\"1\"/>\n"
+        "   </Representation>\n"
+        "  </AdaptationSet>\n"
+        " </Period>\n"
+        "</MPD>\n", segments * SEGMENT_DURATION, SEGMENT_DURATION, BITRATE,
+        SEGMENT_DURATION);
+    assert(len > 0);
+    manifest.data = (uint8_t *)mpd;
+    manifest.size = len;
+    manifest.file = httpd_FileNew(host, "/test.mpd", "application/dash+xml",
+                                  NULL, NULL, Fill, &manifest);
+    assert(manifest.file != NULL);
+
+    /* Segments */
+    struct httpd_file_sys_t *files = calloc(segments, sizeof (*files));
+    struct generator gen = { .frame = 0 };
+    assert(files != NULL);
+
+    for (unsigned i = 0; i < segments; i++)
+    {
+        char url[32];
+
+        files[i].fx = &fx;
+        files[i].index = i;
+        GenerateSegment(&gen, &files[i]);
+        snprintf(url, sizeof (url), "/seg-%u.ts", i);
+        files[i].file = httpd_FileNew(host, url, "video/mp2t", NULL, NULL,
+                                      Fill, &files[i]);
+        assert(files[i].file != NULL);
+    }
+
+    char mrl[64];
+    snprintf(mrl, sizeof (mrl), "http://127.0.0.1:%u/test.mpd", TEST_PORT);
+    libvlc_media_t *md = libvlc_media_new_location(vlc, mrl);
+    assert(md != NULL);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    libvlc_event_attach(em, libvlc_MediaPlayerEndReached, OnEvent, &fx);
+    libvlc_event_attach(em, libvlc_MediaPlayerEncounteredError, OnEvent, &fx);
+
+    vlc_tick_t start = vlc_tick_now();
+    int ret = libvlc_media_player_play(mp);
+    assert(ret == 0);
+
+    vlc_mutex_lock(&fx.lock);
+    while (!fx.ended && fx.served_count < segments)
+        vlc_cond_wait(&fx.wait, &fx.lock);
+    vlc_mutex_unlock(&fx.lock);
+
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+
+    /* Replay the served times against a player starting with the first
+     * segment and consuming them in real time */
+    unsigned rebuffers = 0;
+    vlc_tick_t stalled = 0;
+
+    vlc_mutex_lock(&fx.lock);
+    printf("latency %u ms, bandwidth %u kbit/s, %u x %u s segments "
+           "at %u kbit/s\n", (unsigned)MS_FROM_VLC_TICK(fx.latency),
+           fx.bandwidth / 1000, segments, SEGMENT_DURATION, BITRATE / 1000);
+
+    const bool played = fx.served[0] != 0;
+    if (played)
+    {
+        const vlc_tick_t playback = fx.served[0];
+        for (unsigned i = 1; i < segments && fx.served[i] != 0; i++)
+        {
+            vlc_tick_t due = playback + stalled
+                           + VLC_TICK_FROM_SEC(i * SEGMENT_DURATION);
+            if (fx.served[i] > due)
+            {
+                rebuffers++;
+                stalled += fx.served[i] - due;
+            }
+        }
+
+        printf("startup %.1f ms, %u rebuffer(s) for %.1f ms, "
+               "%u/%u segments served, %u requests\n",
+               secf_from_vlc_tick(playback - start) * 1000., rebuffers,
+               secf_from_vlc_tick(stalled) * 1000., fx.served_count, segments,
+               fx.requests);
+    }
+    else
+        printf("the first segment was not served\n");
+    vlc_mutex_unlock(&fx.lock);
+
+    for (unsigned i = 0; i < segments; i++)
+    {
+        httpd_FileDelete(files[i].file);
+        free(files[i].data);
+    }
+    free(files);
+    httpd_FileDelete(manifest.file);
+    free(mpd);
+    httpd_HostDelete(host);
+    free(fx.served);
+
+    libvlc_release(vlc);
+    return played ? 0 : 1;
+}
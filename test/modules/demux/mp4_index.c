@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * mp4_index.c: MP4 sample tables open and seek benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Generates a video track with a huge moov (one ctts entry per sample, as
+ * with B-frames, and two samples per chunk), then reports the time and
+ * resident memory needed by the mp4 demuxer to open it, and to seek in it.
+ * Set VLC_MP4_SAMPLES to change the number of samples (default: 10 hours
+ * at 30 fps).
+ *
+ * This is not part of the test suite; from the build directory:
+ *   make -C test test_modules_demux_mp4_index
+ *   VLC_MP4_SAMPLES=1080000 ./test/test_modules_demux_mp4_index
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+#include "../lib/libvlc_internal.h"
+
+#include "../../src/input/common.h"
+
+#define TIMESCALE 90000
+#define DELTA 3000
+#define SAMPLES_PER_CHUNK 2
+
+struct buffer
+{
+    uint8_t *p;
+    size_t len;
+    size_t size;
+};
+
+static void Put(struct buffer *b, const void *data, size_t len)
+{
+    if (b->len + len > b->size)
+    {
+        b->size = (b->size + len) * 2;
+        b->p = realloc(b->p, b->size);
+        assert(b->p != NULL);
+    }
+    if (data != NULL)
+        memcpy(b->p + b->len, data, len);
+    else
+        memset(b->p + b->len, 0, len);
+    b->len += len;
+}
+
+static void Put32(struct buffer *b, uint32_t v)
+{
+    uint8_t d[4];
+    SetDWBE(d, v);
+    Put(b, d, 4);
+}
+
+static void Put16(struct buffer *b, uint16_t v)
+{
+    uint8_t d[2];
+    SetWBE(d, v);
+    Put(b, d, 2);
+}
+
+static size_t BoxStart(struct buffer *b, const char *type)
+{
+    size_t pos = b->len;
+    Put32(b, 0);
+    Put(b, type, 4);
+    return pos;
+}
+
+static void BoxEnd(struct buffer *b, size_t pos)
+{
+    SetDWBE(b->p + pos, b->len - pos);
+}
+
+static size_t FullBoxStart(struct buffer *b, const char *type, uint32_t flags)
+{
+    size_t pos = BoxStart(b, type);
+    Put32(b, flags);
+    return pos;
+}
+
+static const uint32_t matrix[9] = {
+    0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000
+};
+
+static void PutMatrix(struct buffer *b)
+{
+    for (unsigned i = 0; i < 9; i++)
+        Put32(b, matrix[i]);
+}
+
+static uint32_t SampleDelta(uint32_t i)
+{
+    /* Slight drift every 1000 samples, so that stts has several entries */
+    return (i % 1000 == 999) ? DELTA + 3 : DELTA;
+}
+
+static uint8_t *Generate(uint32_t samples, size_t *restrict sizep)
+{
+    struct buffer b = { NULL, 0, 0 };
+    uint32_t chunks = (samples + SAMPLES_PER_CHUNK - 1) / SAMPLES_PER_CHUNK;
+    uint64_t duration = 0;
+
+    for (uint32_t i = 0; i < samples; i++)
+        duration += SampleDelta(i);
+    assert(duration <= UINT32_MAX);
+
+    size_t box = BoxStart(&b, "ftyp");
+    Put(&b, "isom", 4);
+    Put32(&b, 0);
+    Put(&b, "isom", 4);
+    BoxEnd(&b, box);
+
+    /* One byte samples */
+    box = BoxStart(&b, "mdat");
+    uint32_t data = b.len;
+    Put(&b, NULL, samples);
+    BoxEnd(&b, box);
+
+    size_t moov = BoxStart(&b, "moov");
+    box = FullBoxStart(&b, "mvhd", 0);
+    Put32(&b, 0); Put32(&b, 0);
+    Put32(&b, TIMESCALE); Put32(&b, duration);
+    Put32(&b, 0x00010000); Put16(&b, 0x0100); Put(&b, NULL, 10);
+    PutMatrix(&b);
+    Put(&b, NULL, 24);
+    Put32(&b, 2);
+    BoxEnd(&b, box);
+
+    size_t trak = BoxStart(&b, "trak");
+    box = FullBoxStart(&b, "tkhd", 3);
+    Put32(&b, 0); Put32(&b, 0);
+    Put32(&b, 1); Put32(&b, 0); Put32(&b, duration);
+    Put(&b, NULL, 8);
+    Put16(&b, 0); Put16(&b, 0); Put16(&b, 0); Put16(&b, 0);
+    PutMatrix(&b);
+    Put32(&b, 320 << 16); Put32(&b, 240 << 16);
+    BoxEnd(&b, box);
+
+    size_t mdia = BoxStart(&b, "mdia");
+    box = FullBoxStart(&b, "mdhd", 0);
+    Put32(&b, 0); Put32(&b, 0);
+    Put32(&b, TIMESCALE); Put32(&b, duration);
+    Put16(&b, 0x55C4); Put16(&b, 0);
+    BoxEnd(&b, box);
+    box = FullBoxStart(&b, "hdlr", 0);
+    Put32(&b, 0); Put(&b, "vide", 4); Put(&b, NULL, 12 + 1);
+    BoxEnd(&b, box);
+
+    size_t minf = BoxStart(&b, "minf");
+    box = FullBoxStart(&b, "vmhd", 1);
+    Put(&b, NULL, 8);
+    BoxEnd(&b, box);
+    size_t dinf = BoxStart(&b, "dinf");
+    size_t dref = FullBoxStart(&b, "dref", 0);
+    Put32(&b, 1);
+    box = FullBoxStart(&b, "url ", 1);
+    BoxEnd(&b, box);
+    BoxEnd(&b, dref);
+    BoxEnd(&b, dinf);
+
+    size_t stbl = BoxStart(&b, "stbl");
+    size_t stsd = FullBoxStart(&b, "stsd", 0);
+    Put32(&b, 1);
+    box = BoxStart(&b, "mp4v");
+    Put(&b, NULL, 6); Put16(&b, 1);
+    Put(&b, NULL, 16);
+    Put16(&b, 320); Put16(&b, 240);
+    Put32(&b, 0x00480000); Put32(&b, 0x00480000);
+    Put32(&b, 0); Put16(&b, 1);
+    Put(&b, NULL, 32);
+    Put16(&b, 0x18); Put16(&b, 0xFFFF);
+    BoxEnd(&b, box);
+    BoxEnd(&b, stsd);
+
+    box = FullBoxStart(&b, "stts", 0);
+    size_t count = b.len;
+    uint32_t entries = 0;
+    Put32(&b, 0);
+    for (uint32_t i = 0; i < samples; )
+    {
+        uint32_t run = 1;
+        while (i + run < samples && SampleDelta(i + run) == SampleDelta(i))
+            run++;
+        Put32(&b, run);
+        Put32(&b, SampleDelta(i));
+        entries++;
+        i += run;
+    }
+    SetDWBE(b.p + count, entries);
+    BoxEnd(&b, box);
+
+    /* I P B pattern, one entry per sample */
+    box = FullBoxStart(&b, "ctts", 0);
+    Put32(&b, samples);
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        Put32(&b, 1);
+        Put32(&b, (i % 3 == 2) ? 0 : 2 * DELTA);
+    }
+    BoxEnd(&b, box);
+
+    box = FullBoxStart(&b, "stsc", 0);
+    Put32(&b, 1);
+    Put32(&b, 1); Put32(&b, SAMPLES_PER_CHUNK); Put32(&b, 1);
+    BoxEnd(&b, box);
+
+    box = FullBoxStart(&b, "stsz", 0);
+    Put32(&b, 0); Put32(&b, samples);
+    for (uint32_t i = 0; i < samples; i++)
+        Put32(&b, 1);
+    BoxEnd(&b, box);
+
+    box = FullBoxStart(&b, "stco", 0);
+    Put32(&b, chunks);
+    for (uint32_t i = 0; i < chunks; i++)
+        Put32(&b, data + i * SAMPLES_PER_CHUNK);
+    BoxEnd(&b, box);
+
+    BoxEnd(&b, stbl);
+    BoxEnd(&b, minf);
+    BoxEnd(&b, mdia);
+    BoxEnd(&b, trak);
+    BoxEnd(&b, moov);
+
+    *sizep = b.len;
+    return b.p;
+}
+
+static long GetResident(void)
+{
+    FILE *stream = fopen("/proc/self/statm", "r");
+    long size, resident;
+
+    if (stream == NULL)
+        return -1;
+    if (fscanf(stream, "%ld %ld", &size, &resident) != 2)
+        resident = -1;
+    fclose(stream);
+    return (resident < 0) ? -1 : resident * sysconf(_SC_PAGESIZE);
+}
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    (void) out; (void) in;
+    return (es_out_id_t *)(uintptr_t)(fmt->i_id + 1);
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    (void) out; (void) id;
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    (void) out; (void) id;
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    (void) out; (void) in;
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_SET_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_ES_DEFAULT:
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void EsOutDelete(es_out_t *out)
+{
+    (void) out;
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDelete,
+};
+
+int main(void)
+{
+    uint32_t samples = 10 * 3600 * 30;
+    const char *env = getenv("VLC_MP4_SAMPLES");
+    if (env != NULL)
+        samples = strtoul(env, NULL, 10);
+    assert(samples > 0);
+
+    size_t size;
+    uint8_t *buf = Generate(samples, &size);
+
+    struct vlc_run_args args;
+    vlc_run_args_init(&args);
+    libvlc_instance_t *vlc = libvlc_create(&args);
+    assert(vlc != NULL);
+
+    stream_t *s = vlc_stream_MemoryNew(VLC_OBJECT(vlc->p_libvlc_int),
+                                       buf, size, true);
+    assert(s != NULL);
+
+    es_out_t out = { .cbs = &es_out_cbs };
+
+    long rss = GetResident();
+    vlc_tick_t start = vlc_tick_now();
+    demux_t *demux = demux_New(VLC_OBJECT(s), "mp4", s, &out);
+    vlc_tick_t t_open = vlc_tick_now() - start;
+    long rss_open = GetResident();
+    assert(demux != NULL);
+
+    vlc_tick_t length;
+    assert(demux_Control(demux, DEMUX_GET_LENGTH, &length) == VLC_SUCCESS);
+
+    /* Seek at random positions, and read a few samples */
+    const unsigned seeks = 1000;
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < seeks; i++)
+    {
+        vlc_tick_t time = length / seeks * ((i * 7919) % seeks);
+        assert(demux_Control(demux, DEMUX_SET_TIME, time, true)
+               == VLC_SUCCESS);
+        for (unsigned j = 0; j < 4; j++)
+            demux_Demux(demux);
+    }
+    vlc_tick_t t_seek = vlc_tick_now() - start;
+
+    printf("%"PRIu32" samples, moov %zu KiB, length %"PRId64" s\n",
+           samples, (size - samples) / 1024, SEC_FROM_VLC_TICK(length));
+    printf("open: %.1f ms", secf_from_vlc_tick(t_open) * 1000.);
+    if (rss >= 0 && rss_open >= 0)
+        printf(", +%ld KiB resident", (rss_open - rss) / 1024);
+    printf("\nseek: %.1f us per seek\n",
+           secf_from_vlc_tick(t_seek) * 1e6 / seeks);
+
+    demux_Delete(demux);
+    libvlc_release(vlc);
+    free(buf);
+    return 0;
+}
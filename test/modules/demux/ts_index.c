@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * ts_index.c: MPEG TS seek index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+
+#include "../../../modules/demux/mpeg/ts_index.h"
+
+#define FIRST 1000
+#define SECOND TO_SCALE_NZ(VLC_TICK_FROM_SEC(1))
+
+static void Lookup(const ts_index_t *index, int program, stime_t time,
+                   int ret, stime_t before_time, uint64_t before,
+                   uint64_t after)
+{
+    stime_t t;
+    uint64_t b, a;
+
+    assert(ts_index_Lookup(index, program, FIRST, time, &t, &b, &a) == ret);
+    if (ret != VLC_SUCCESS)
+        return;
+    assert(t == before_time);
+    assert(b == before);
+    assert(a == after);
+}
+
+int main(void)
+{
+    ts_index_t *index = ts_index_New();
+    assert(index != NULL);
+
+    Lookup(index, 1, FIRST, VLC_EGENERIC, 0, 0, 0);
+
+    /* One point per TS_INDEX_INTERVAL, with PCR every 100ms */
+    for (unsigned i = 0; i < 100; i++)
+        ts_index_Add(index, 1, FIRST, FIRST + i * SECOND / 10, i * 1880);
+    /* Out of order: seek positions found later on */
+    ts_index_Add(index, 1, FIRST, FIRST + 20 * SECOND, 200 * 1880);
+    ts_index_Add(index, 1, FIRST, FIRST + 15 * SECOND, 150 * 1880);
+    /* Not monotonic: discontinuity */
+    ts_index_Add(index, 1, FIRST, FIRST + 30 * SECOND, 160 * 1880);
+
+    Lookup(index, 1, FIRST - 1, VLC_EGENERIC, 0, 0, 0);
+    Lookup(index, 1, FIRST, VLC_SUCCESS, FIRST, 0, 5 * 1880);
+    Lookup(index, 1, FIRST + 5 * SECOND + 1, VLC_SUCCESS,
+           FIRST + 5 * SECOND, 50 * 1880, 55 * 1880);
+    Lookup(index, 1, FIRST + 12 * SECOND, VLC_SUCCESS,
+           FIRST + 95 * SECOND / 10, 95 * 1880, 150 * 1880);
+    Lookup(index, 1, FIRST + 17 * SECOND, VLC_SUCCESS,
+           FIRST + 15 * SECOND, 150 * 1880, 200 * 1880);
+    Lookup(index, 1, FIRST + 60 * SECOND, VLC_SUCCESS,
+           FIRST + 20 * SECOND, 200 * 1880, UINT64_MAX);
+    Lookup(index, 2, FIRST + SECOND, VLC_EGENERIC, 0, 0, 0);
+
+    /* Persistence and invalidation */
+    char path[] = "/tmp/vlc-ts-index-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd != -1);
+    close(fd);
+
+    assert(ts_index_Save(index, path, 123456, 42) == VLC_SUCCESS);
+
+    ts_index_t *loaded = ts_index_New();
+    assert(loaded != NULL);
+    assert(ts_index_Load(loaded, path, 123457, 42) == VLC_EGENERIC);
+    assert(ts_index_Load(loaded, path, 123456, 43) == VLC_EGENERIC);
+    Lookup(loaded, 1, FIRST + 17 * SECOND, VLC_EGENERIC, 0, 0, 0);
+    assert(ts_index_Load(loaded, path, 123456, 42) == VLC_SUCCESS);
+    Lookup(loaded, 1, FIRST + 17 * SECOND, VLC_SUCCESS,
+           FIRST + 15 * SECOND, 150 * 1880, 200 * 1880);
+
+    /* Another first PCR, stale points are dropped */
+    ts_index_Add(loaded, 1, FIRST + 1, FIRST + SECOND, 1880);
+    Lookup(loaded, 1, FIRST + 17 * SECOND, VLC_EGENERIC, 0, 0, 0);
+
+    unlink(path);
+    ts_index_Delete(loaded);
+    ts_index_Delete(index);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * ts_prescan.c: MPEG TS headers pre-scan tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks ts_prescan() against a per-packet parser, then compares the
+ * per-packet header parsing and sorted PID list lookup with the bulk
+ * pre-scan and direct PID table lookup.
+ * Set VLC_TS_FILE to a (large, multi-program) capture to benchmark it
+ * instead of synthetic data.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/demux/mpeg/ts_prescan.h"
+
+#define TS_SIZE 188
+#define SYNTH_PACKETS 200000
+#define SYNTH_PIDS 400
+
+static uint8_t *LoadFile(const char *path, size_t *restrict sizep)
+{
+    FILE *stream = fopen(path, "rb");
+    if (stream == NULL)
+        return NULL;
+
+    uint8_t *buf = NULL;
+    size_t size = 0;
+
+    for (;;)
+    {
+        uint8_t *nbuf = realloc(buf, size + 1048576);
+        assert(nbuf != NULL);
+        buf = nbuf;
+
+        size_t len = fread(buf + size, 1, 1048576, stream);
+        size += len;
+        if (len < 1048576)
+            break;
+    }
+    fclose(stream);
+
+    /* Start on sync */
+    size_t skip = 0;
+    while (skip + TS_SIZE < size
+        && (buf[skip] != 0x47 || buf[skip + TS_SIZE] != 0x47))
+        skip++;
+    memmove(buf, buf + skip, size - skip);
+    *sizep = size - skip;
+    return buf;
+}
+
+static uint8_t *Synthesize(size_t *restrict sizep)
+{
+    uint8_t *buf = malloc(SYNTH_PACKETS * TS_SIZE);
+    assert(buf != NULL);
+
+    for (unsigned i = 0; i < SYNTH_PACKETS; i++)
+    {
+        uint8_t *p = buf + i * TS_SIZE;
+        uint16_t pid = 0x100 + (i * 7919) % SYNTH_PIDS;
+
+        if (i % 97 == 0)
+            pid = 0x1FFF;
+        p[0] = 0x47;
+        p[1] = ((i % 13 == 0) ? 0x40 : 0) | (pid >> 8);
+        p[2] = pid & 0xFF;
+        p[3] = ((i % 5 == 0) ? 0x30 : 0x10) | (i & 0xF);
+        memset(p + 4, 0xFF, TS_SIZE - 4);
+    }
+    *sizep = SYNTH_PACKETS * TS_SIZE;
+    return buf;
+}
+
+static void CheckPrescan(void)
+{
+    uint8_t buf[TS_PRESCAN_MAX * 192];
+    ts_prescan_t scan;
+
+    /* 192 bytes packets with a 4 bytes extra header (BluRay) */
+    memset(buf, 0, sizeof (buf));
+    for (unsigned i = 0; i < TS_PRESCAN_MAX; i++)
+    {
+        uint8_t *p = buf + i * 192 + 4;
+        p[0] = 0x47;
+        p[1] = 0x80 | 0x40 | ((i * 100) >> 8);
+        p[2] = (i * 100) & 0xFF;
+        p[3] = 0xC0 | 0x30;
+    }
+
+    assert(ts_prescan(&scan, buf, sizeof (buf), 192, 4) == TS_PRESCAN_MAX);
+    for (unsigned i = 0; i < TS_PRESCAN_MAX; i++)
+    {
+        assert(scan.pid[i] == i * 100);
+        assert(scan.flags[i] == (TS_PRESCAN_TEI | TS_PRESCAN_PUSI
+                                 | TS_PRESCAN_SCRAMBLED | TS_PRESCAN_ADAPTATION
+                                 | TS_PRESCAN_PAYLOAD));
+    }
+    assert(scan.i_index == 0);
+
+    /* Incomplete trailing packet */
+    assert(ts_prescan(&scan, buf, 3 * 192 - 1, 192, 4) == 2);
+
+    /* Lost sync */
+    buf[17 * 192 + 4] = 0x46;
+    assert(ts_prescan(&scan, buf, sizeof (buf), 192, 4) == 17);
+    buf[4] = 0x00;
+    assert(ts_prescan(&scan, buf, sizeof (buf), 192, 4) == 0);
+}
+
+/* Per packet parsing and lookup, as done before the pre-scan */
+static int ComparePID(const void *a, const void *b)
+{
+    uint16_t pa = *(const uint16_t *)a, pb = *(const uint16_t *)b;
+    return (pa > pb) - (pa < pb);
+}
+
+static uint64_t RunLegacy(const uint8_t *buf, size_t count,
+                          const uint16_t *sorted, size_t pidcount)
+{
+    uint64_t sum = 0;
+    uint16_t last_pid = 0xFFFF;
+    const uint16_t *last = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *p = buf + i * TS_SIZE;
+        if (p[0] != 0x47)
+            break;
+
+        uint16_t pid = ((p[1] & 0x1F) << 8) | p[2];
+        const uint16_t *entry = last;
+        if (pid != last_pid)
+            entry = bsearch(&pid, sorted, pidcount, sizeof (*sorted),
+                            ComparePID);
+        last = entry;
+        last_pid = pid;
+        if (entry != NULL)
+            sum += (entry - sorted) + ((p[3] & 0x20) ? 1 : 0)
+                 + ((p[1] & 0x40) ? 1 : 0);
+    }
+    return sum;
+}
+
+static uint64_t RunPrescan(const uint8_t *buf, size_t count,
+                           const uint16_t *table)
+{
+    ts_prescan_t scan;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < count; i += TS_PRESCAN_MAX)
+    {
+        size_t n = ts_prescan(&scan, buf + i * TS_SIZE,
+                              (count - i) * TS_SIZE, TS_SIZE, 0);
+        for (size_t j = 0; j < n; j++)
+        {
+            uint16_t index = table[scan.pid[j]];
+            if (index != 0xFFFF)
+                sum += index + ((scan.flags[j] & TS_PRESCAN_ADAPTATION) ? 1 : 0)
+                     + ((scan.flags[j] & TS_PRESCAN_PUSI) ? 1 : 0);
+        }
+        if (n < TS_PRESCAN_MAX)
+            break;
+    }
+    return sum;
+}
+
+int main(void)
+{
+    CheckPrescan();
+
+    const char *path = getenv("VLC_TS_FILE");
+    size_t size;
+    uint8_t *buf = (path != NULL) ? LoadFile(path, &size) : Synthesize(&size);
+    if (buf == NULL)
+    {
+        perror(path);
+        return 77;
+    }
+
+    size_t count = size / TS_SIZE;
+
+    /* Collect the PIDs */
+    static uint16_t table[8192];
+    uint16_t *sorted = malloc(8192 * sizeof (*sorted));
+    size_t pidcount = 0;
+
+    assert(sorted != NULL);
+    memset(table, 0xFF, sizeof (table));
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *p = buf + i * TS_SIZE;
+        uint16_t pid = ((p[1] & 0x1F) << 8) | p[2];
+        if (table[pid] == 0xFFFF)
+        {
+            table[pid] = 0;
+            sorted[pidcount++] = pid;
+        }
+    }
+    qsort(sorted, pidcount, sizeof (*sorted), ComparePID);
+    for (size_t i = 0; i < pidcount; i++)
+        table[sorted[i]] = i;
+
+    vlc_tick_t start = vlc_tick_now();
+    uint64_t legacy = RunLegacy(buf, count, sorted, pidcount);
+    vlc_tick_t t_legacy = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    uint64_t prescan = RunPrescan(buf, count, table);
+    vlc_tick_t t_prescan = vlc_tick_now() - start;
+
+    assert(legacy == prescan);
+
+    printf("%zu packets, %zu PIDs\n", count, pidcount);
+    printf("per packet: %.1f ms, %.1f Mpackets/s\n",
+           secf_from_vlc_tick(t_legacy) * 1000.,
+           count / secf_from_vlc_tick(t_legacy) / 1e6);
+    printf("pre-scan:   %.1f ms, %.1f Mpackets/s\n",
+           secf_from_vlc_tick(t_prescan) * 1000.,
+           count / secf_from_vlc_tick(t_prescan) / 1e6);
+
+    free(sorted);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*****************************************************************************
+ * transcode_queue.c: transcode decode queue test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Transcodes a mock video stream with the decode queue enabled, through a
+ * decoder that outputs each picture a few blocks late, as with B-frames
+ * reordering, and an encoder checking the pictures it receives. All the
+ * pictures must be encoded once, in order, including the ones the decoder
+ * only outputs when drained.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#define MODULE_NAME test_transcode_queue
+#define MODULE_STRING "test_transcode_queue"
+#undef __PLUGIN__
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define DECODER_DELAY 3 /* pictures */
+#define FRAME_RATE 25
+#define LENGTH VLC_TICK_FROM_SEC(2)
+
+static atomic_uint decoded;
+static atomic_uint encoded;
+static atomic_uint held_max;
+static atomic_bool out_of_order;
+
+struct decoder_sys
+{
+    picture_t *held[DECODER_DELAY];
+    unsigned   count;
+};
+
+static void Output(decoder_t *dec)
+{
+    struct decoder_sys *sys = dec->p_sys;
+    picture_t *pic = sys->held[0];
+
+    memmove(&sys->held[0], &sys->held[1],
+            (sys->count - 1) * sizeof (sys->held[0]));
+    sys->count--;
+    atomic_fetch_add(&decoded, 1);
+    decoder_QueueVideo(dec, pic);
+}
+
+static int Decode(decoder_t *dec, block_t *block)
+{
+    struct decoder_sys *sys = dec->p_sys;
+
+    if (block == NULL) /* Drain */
+    {
+        while (sys->count > 0)
+            Output(dec);
+        return VLCDEC_SUCCESS;
+    }
+
+    picture_t *pic = NULL;
+    if (decoder_UpdateVideoFormat(dec) == 0)
+        pic = decoder_NewPicture(dec);
+    if (pic == NULL)
+    {
+        block_Release(block);
+        return VLCDEC_SUCCESS;
+    }
+    pic->date = block->i_pts;
+    pic->b_progressive = true;
+    block_Release(block);
+
+    if (sys->count == DECODER_DELAY)
+        Output(dec);
+    sys->held[sys->count++] = pic;
+    if (sys->count > atomic_load(&held_max))
+        atomic_store(&held_max, sys->count);
+    return VLCDEC_SUCCESS;
+}
+
+static void Flush(decoder_t *dec)
+{
+    struct decoder_sys *sys = dec->p_sys;
+
+    while (sys->count > 0)
+        picture_Release(sys->held[--sys->count]);
+}
+
+static int OpenDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+
+    if (dec->fmt_in.i_codec != VLC_CODEC_I420)
+        return VLC_EGENERIC;
+
+    struct decoder_sys *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (sys == NULL)
+        return VLC_ENOMEM;
+    sys->count = 0;
+
+    es_format_Copy(&dec->fmt_out, &dec->fmt_in);
+    dec->p_sys = sys;
+    dec->pf_decode = Decode;
+    dec->pf_flush = Flush;
+    return VLC_SUCCESS;
+}
+
+static void CloseDecoder(vlc_object_t *obj)
+{
+    Flush((decoder_t *)obj);
+}
+
+static block_t *Encode(encoder_t *enc, picture_t *pic)
+{
+    vlc_tick_t *last = enc->p_sys;
+
+    if (pic == NULL)
+        return NULL;
+    if (*last != VLC_TICK_INVALID && pic->date <= *last)
+        atomic_store(&out_of_order, true);
+    *last = pic->date;
+    atomic_fetch_add(&encoded, 1);
+
+    block_t *block = block_Alloc(1);
+    if (block != NULL)
+        block->i_dts = block->i_pts = pic->date;
+    return block;
+}
+
+static int OpenEncoder(vlc_object_t *obj)
+{
+    encoder_t *enc = (encoder_t *)obj;
+
+    vlc_tick_t *last = vlc_obj_malloc(obj, sizeof (*last));
+    if (last == NULL)
+        return VLC_ENOMEM;
+    *last = VLC_TICK_INVALID;
+
+    enc->fmt_in.i_codec = VLC_CODEC_I420;
+    enc->fmt_in.video.i_chroma = VLC_CODEC_I420;
+    enc->p_sys = last;
+    enc->pf_encode_video = Encode;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("video decoder", 1000)
+    set_callbacks(OpenDecoder, CloseDecoder)
+    add_submodule()
+        set_capability("encoder", 0)
+        set_callback(OpenEncoder)
+        add_shortcut("test_queue_enc")
+vlc_module_end()
+
+typedef int (*vlc_plugin_cb)(int (*)(void *, void *, int, ...), void *);
+
+VLC_EXPORT vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+static void OnEvent(const libvlc_event_t *event, void *data)
+{
+    vlc_sem_t *ended = data;
+    (void) event;
+    vlc_sem_post(ended);
+}
+
+static void Transcode(libvlc_instance_t *vlc, const char *sout)
+{
+    char mrl[128];
+
+    atomic_store(&decoded, 0);
+    atomic_store(&encoded, 0);
+    atomic_store(&held_max, 0);
+    atomic_store(&out_of_order, false);
+
+    snprintf(mrl, sizeof (mrl), "mock://video_track_count=1;"
+             "video_width=64;video_height=64;video_frame_rate=%u;"
+             "length=%"PRId64, FRAME_RATE, LENGTH);
+    libvlc_media_t *md = libvlc_media_new_location(vlc, mrl);
+    assert(md != NULL);
+    libvlc_media_add_option(md, sout);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    vlc_sem_t ended;
+    vlc_sem_init(&ended, 0);
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    libvlc_event_attach(em, libvlc_MediaPlayerEndReached, OnEvent, &ended);
+    libvlc_event_attach(em, libvlc_MediaPlayerEncounteredError, OnEvent,
+                        &ended);
+
+    int ret = libvlc_media_player_play(mp);
+    assert(ret == 0);
+    vlc_sem_wait(&ended);
+
+    /* the stream output is drained and closed with the input */
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+
+    test_log("%s: %u pictures decoded, %u encoded\n", sout,
+             atomic_load(&decoded), atomic_load(&encoded));
+    assert(atomic_load(&held_max) == DECODER_DELAY);
+    assert(atomic_load(&decoded) > DECODER_DELAY);
+    assert(atomic_load(&encoded) == atomic_load(&decoded));
+    assert(!atomic_load(&out_of_order));
+}
+
+int main(void)
+{
+    const char *args[] = {
+        "-v", "--ignore-config", "--vout=none", "--aout=none",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    Transcode(vlc, ":sout=#transcode{vcodec=h264,venc=test_queue_enc}:dummy");
+    Transcode(vlc, ":sout=#transcode{vcodec=h264,venc=test_queue_enc,"
+                   "decode-queue=2}:dummy");
+    Transcode(vlc, ":sout=#transcode{vcodec=h264,venc=test_queue_enc,"
+                   "decode-queue=1,vfilter-threads=2}:dummy");
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * yuv_rgb.c: YUV to RGB converters benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Reports the frame rate of the yuv_rgb converter, with one thread and with
+ * all CPUs, and of swscale, for each YUV to RGB pair that yuv_rgb handles,
+ * at 1080p and 2160p. It also prints the mean difference of the outputs of
+ * both converters. Set VLC_YUV_RGB_FRAMES to change the number of frames per
+ * run (default: 50).
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+static const vlc_fourcc_t inputs[] = {
+    VLC_CODEC_I420, VLC_CODEC_NV12, VLC_CODEC_P010, VLC_CODEC_I420_10L,
+};
+
+static const vlc_fourcc_t outputs[] = {
+    VLC_CODEC_RGB32, VLC_CODEC_BGRA,
+};
+
+static const unsigned sizes[][2] = {
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+struct run
+{
+    const char *module;
+    unsigned threads; /* 0 for all CPUs */
+};
+
+static const struct run runs[] = {
+    { "yuv_rgb", 1 },
+    { "yuv_rgb", 0 },
+    { "swscale", 1 },
+};
+
+static filter_t *CreateFilter(vlc_object_t *parent, const char *module,
+                              const video_format_t *fmt, vlc_fourcc_t chroma,
+                              unsigned threads)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "filter-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "filter-threads", threads);
+
+    es_format_InitFromVideo(&filter->fmt_in, fmt);
+    es_format_InitFromVideo(&filter->fmt_out, fmt);
+    filter->fmt_out.i_codec = filter->fmt_out.video.i_chroma = chroma;
+    if (chroma == VLC_CODEC_RGB32)
+    {
+        filter->fmt_out.video.i_rmask = 0x00ff0000;
+        filter->fmt_out.video.i_gmask = 0x0000ff00;
+        filter->fmt_out.video.i_bmask = 0x000000ff;
+    }
+
+    filter->p_module = module_need(filter, "video converter", module, true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_out);
+        es_format_Clean(&filter->fmt_in);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static void DeleteFilter(filter_t *filter)
+{
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_out);
+    es_format_Clean(&filter->fmt_in);
+    vlc_object_delete(filter);
+}
+
+/* Smooth gradients, so that the chroma upsampling of the converters does
+ * not dominate their differences */
+static void FillPicture(picture_t *pic)
+{
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(pic->format.i_chroma);
+    const unsigned depth = dsc->pixel_bits;
+    const bool high = pic->format.i_chroma == VLC_CODEC_P010;
+
+    for (int p = 0; p < pic->i_planes; p++)
+    {
+        plane_t *plane = &pic->p[p];
+        const unsigned samples = plane->i_pitch / dsc->pixel_size;
+
+        for (int y = 0; y < plane->i_lines; y++)
+            for (unsigned x = 0; x < samples; x++)
+            {
+                unsigned v;
+
+                if (p == 0)
+                    v = 16 + (x + y) * 219 / (samples + plane->i_lines);
+                else if (pic->i_planes == 2 ? x & 1 : p == 2)
+                    v = 16 + y * 224 / plane->i_lines;
+                else
+                    v = 240 - x * 224 / samples;
+
+                if (dsc->pixel_size == 1)
+                    plane->p_pixels[y * plane->i_pitch + x] = v;
+                else
+                {
+                    v <<= depth - 8;
+                    if (high)
+                        v <<= 16 - depth;
+                    ((uint16_t *)plane->p_pixels)[y * plane->i_pitch / 2 + x] = v;
+                }
+            }
+    }
+}
+
+static double Compare(const picture_t *a, const picture_t *b)
+{
+    const plane_t *pa = &a->p[0], *pb = &b->p[0];
+    uint64_t sum = 0;
+
+    for (int y = 0; y < pa->i_visible_lines; y++)
+        for (int x = 0; x < pa->i_visible_pitch; x++)
+            if ((x & 3) != 3) /* skip alpha */
+                sum += abs(pa->p_pixels[y * pa->i_pitch + x]
+                           - pb->p_pixels[y * pb->i_pitch + x]);
+    return (double)sum / (pa->i_visible_lines * pa->i_visible_pitch * 3 / 4);
+}
+
+static picture_t *Bench(vlc_object_t *parent, const struct run *run,
+                        const video_format_t *fmt, vlc_fourcc_t chroma,
+                        picture_t *src, unsigned frames)
+{
+    filter_t *filter = CreateFilter(parent, run->module, fmt, chroma,
+                                    run->threads);
+    if (filter == NULL)
+    {
+        printf("%4.4s -> %4.4s %4ux%-4u %-7s: not available\n",
+               (const char *)&fmt->i_chroma, (const char *)&chroma,
+               fmt->i_visible_width, fmt->i_visible_height, run->module);
+        return NULL;
+    }
+
+    picture_t *res = filter->pf_video_filter(filter, picture_Hold(src));
+    assert(res != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < frames; i++)
+    {
+        picture_t *pic = filter->pf_video_filter(filter, picture_Hold(src));
+        assert(pic != NULL);
+        picture_Release(pic);
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("%4.4s -> %4.4s %4ux%-4u %-7s %s: %7.1f fps\n",
+           (const char *)&fmt->i_chroma, (const char *)&chroma,
+           fmt->i_visible_width, fmt->i_visible_height, run->module,
+           run->threads ? "1 thread  " : "all CPUs  ",
+           frames / secf_from_vlc_tick(elapsed));
+
+    DeleteFilter(filter);
+    return res;
+}
+
+int main(void)
+{
+    unsigned frames = 50;
+    const char *env = getenv("VLC_YUV_RGB_FRAMES");
+    if (env != NULL)
+        frames = strtoul(env, NULL, 10);
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    for (size_t i = 0; i < ARRAY_SIZE(inputs); i++)
+        for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+        {
+            video_format_t fmt;
+
+            video_format_Init(&fmt, inputs[i]);
+            video_format_Setup(&fmt, inputs[i], sizes[s][0], sizes[s][1],
+                               sizes[s][0], sizes[s][1], 1, 1);
+            /* the swscale module does not pass the color space */
+            fmt.space = COLOR_SPACE_BT601;
+            fmt.color_range = COLOR_RANGE_LIMITED;
+
+            picture_t *src = picture_NewFromFormat(&fmt);
+            assert(src != NULL);
+            FillPicture(src);
+
+            for (size_t o = 0; o < ARRAY_SIZE(outputs); o++)
+            {
+                picture_t *res[ARRAY_SIZE(runs)];
+
+                for (size_t r = 0; r < ARRAY_SIZE(runs); r++)
+                    res[r] = Bench(parent, &runs[r], &fmt, outputs[o], src,
+                                   frames);
+
+                if (res[0] != NULL && res[2] != NULL)
+                    printf("%4.4s -> %4.4s %4ux%-4u mean difference: %.2f\n",
+                           (const char *)&fmt.i_chroma,
+                           (const char *)&outputs[o],
+                           sizes[s][0], sizes[s][1], Compare(res[0], res[2]));
+                for (size_t r = 0; r < ARRAY_SIZE(runs); r++)
+                    if (res[r] != NULL)
+                        picture_Release(res[r]);
+            }
+            picture_Release(src);
+        }
+
+    libvlc_release(vlc);
+    return 0;
+}
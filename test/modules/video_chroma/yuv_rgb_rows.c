@@ -0,0 +1,276 @@
+/*****************************************************************************
+ * yuv_rgb_rows.c: YUV to RGB converter rows accuracy test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Checks each row function of the yuv_rgb converter, in plain C and in every
+ * SIMD flavour that the CPU supports, against a floating point conversion:
+ * no component may be more than 1 off. The SIMD rows must also match the
+ * plain C rows exactly.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#define MODULE_NAME test_yuv_rgb_rows
+#define MODULE_STRING "test_yuv_rgb_rows"
+#undef __PLUGIN__
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../modules/video_chroma/yuv_rgb.c"
+
+const char vlc_module_name[] = MODULE_STRING;
+
+/* Odd, so that every row also runs its plain C tail */
+#define WIDTH 203
+/* Room for the widest SIMD loads past the last sample */
+#define PADDING 64
+
+struct rows
+{
+    const char *name;
+    const yuv_rgb_row_t *rows;
+};
+
+static const char *const layout_names[LAYOUT_COUNT] = {
+    "I420", "NV12", "I420_10", "P010",
+};
+
+static void FillLine(void *buf, unsigned count, int layout, unsigned *seed,
+                     bool edges)
+{
+    uint8_t *line = buf;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        /* Alternate the extreme values, then use random ones */
+        unsigned v = edges ? ((i / 3) & 1 ? 0x3ff : 0) ^ (i & 1 ? 0x200 : 0)
+                           : (unsigned)rand_r(seed);
+
+        switch (layout)
+        {
+            case LAYOUT_I420:
+            case LAYOUT_NV12:
+                line[i] = v >> 2;
+                break;
+            case LAYOUT_I420_10:
+                ((uint16_t *)line)[i] = v & 0x3ff;
+                break;
+            default:
+                ((uint16_t *)line)[i] = (v & 0x3ff) << 6;
+                break;
+        }
+    }
+}
+
+/* Reads a sample, on the 8-bit scale */
+static double Sample8(const uint8_t *line, unsigned i, int layout)
+{
+    switch (layout)
+    {
+        case LAYOUT_I420:
+        case LAYOUT_NV12:
+            return line[i];
+        case LAYOUT_I420_10:
+            return ((const uint16_t *)line)[i] / 4.;
+        default:
+            return (((const uint16_t *)line)[i] >> 6) / 4.;
+    }
+}
+
+static int Round8(double v)
+{
+    v = round(v);
+    return v < 0. ? 0 : v > 255. ? 255 : (int)v;
+}
+
+/* Converts one pixel, with the matrices of the specifications */
+static void Reference(uint8_t rgb[3], const uint8_t *const src[3],
+                      unsigned x, int layout, video_color_space_t space,
+                      bool full_range)
+{
+    const bool planar = layout == LAYOUT_I420 || layout == LAYOUT_I420_10;
+    double kr, kb;
+
+    switch (space)
+    {
+        case COLOR_SPACE_BT601:
+            kr = 0.299;
+            kb = 0.114;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627;
+            kb = 0.0593;
+            break;
+        default:
+            kr = 0.2126;
+            kb = 0.0722;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    double y = Sample8(src[0], x, layout);
+    double u, v;
+
+    if (planar)
+    {
+        u = Sample8(src[1], x / 2, layout);
+        v = Sample8(src[2], x / 2, layout);
+    }
+    else
+    {
+        u = Sample8(src[1], 2 * (x / 2), layout);
+        v = Sample8(src[1], 2 * (x / 2) + 1, layout);
+    }
+
+    if (full_range)
+    {
+        u -= 128.;
+        v -= 128.;
+    }
+    else
+    {
+        y = (y - 16.) * 255. / 219.;
+        u = (u - 128.) * 255. / 224.;
+        v = (v - 128.) * 255. / 224.;
+    }
+
+    rgb[0] = Round8(y + 2. * (1. - kr) * v);
+    rgb[1] = Round8(y - 2. * (1. - kb) * kb / kg * u
+                      - 2. * (1. - kr) * kr / kg * v);
+    rgb[2] = Round8(y + 2. * (1. - kb) * u);
+}
+
+static unsigned CheckRow(const struct rows *r, const struct rows *c,
+                         int layout, video_color_space_t space,
+                         bool full_range, bool rgba,
+                         const uint8_t *const src[3])
+{
+    struct yuv_rgb_coefs coefs;
+    uint8_t dst[4 * WIDTH + PADDING], ref[4 * WIDTH + PADDING];
+    unsigned failures = 0;
+
+    SetCoefs(&coefs, space, full_range, rgba);
+    r->rows[layout](&coefs, dst, src, 0, WIDTH);
+
+    for (unsigned x = 0; x < WIDTH; x++)
+    {
+        const uint8_t *px = &dst[4 * x];
+        uint8_t rgb[3];
+
+        Reference(rgb, src, x, layout, space, full_range);
+
+        const int got[3] = {
+            px[rgba ? 0 : 2], px[1], px[rgba ? 2 : 0],
+        };
+
+        for (unsigned i = 0; i < 3; i++)
+            if (abs(got[i] - rgb[i]) > 1 && failures++ == 0)
+                fprintf(stderr, "%s %s, space %d, %s range, pixel %u: "
+                        "component %u is %d instead of %u\n", r->name,
+                        layout_names[layout], space,
+                        full_range ? "full" : "limited", x, i, got[i],
+                        rgb[i]);
+        if (px[3] != 0xff && failures++ == 0)
+            fprintf(stderr, "%s %s: pixel %u is not opaque\n", r->name,
+                    layout_names[layout], x);
+    }
+
+    if (r != c)
+    {
+        c->rows[layout](&coefs, ref, src, 0, WIDTH);
+        if (memcmp(dst, ref, 4 * WIDTH))
+        {
+            fprintf(stderr, "%s %s, space %d, %s range: differs from C\n",
+                    r->name, layout_names[layout], space,
+                    full_range ? "full" : "limited");
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(void)
+{
+    static const video_color_space_t spaces[] = {
+        COLOR_SPACE_BT601, COLOR_SPACE_BT709, COLOR_SPACE_BT2020,
+    };
+    const struct rows all[] = {
+        { "C", C_rows },
+#ifdef HAVE_SSE2_INTRINSICS
+        { "SSE2", vlc_CPU_SSE2() ? SSE2_rows : NULL },
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+        { "AVX2", vlc_CPU_AVX2() ? AVX2_rows : NULL },
+#endif
+    };
+    /* Words, for the 10-bit layouts */
+    uint16_t lines[3][WIDTH + PADDING];
+    const uint8_t *const src[3] = {
+        (uint8_t *)lines[0], (uint8_t *)lines[1], (uint8_t *)lines[2],
+    };
+    unsigned seed = 42, failures = 0;
+
+    for (unsigned pass = 0; pass < 16; pass++)
+        for (int layout = 0; layout < LAYOUT_COUNT; layout++)
+        {
+            const bool planar = layout == LAYOUT_I420
+                             || layout == LAYOUT_I420_10;
+            const unsigned chroma_count = (WIDTH + 1) / 2;
+
+            memset(lines, 0, sizeof (lines));
+            FillLine(lines[0], WIDTH, layout, &seed, pass == 0);
+            if (planar)
+            {
+                FillLine(lines[1], chroma_count, layout, &seed, pass == 0);
+                FillLine(lines[2], chroma_count, layout, &seed, pass == 0);
+            }
+            else
+                FillLine(lines[1], 2 * chroma_count, layout, &seed, pass == 0);
+
+            for (size_t i = 0; i < ARRAY_SIZE(all); i++)
+            {
+                if (all[i].rows == NULL)
+                    continue;
+
+                for (size_t s = 0; s < ARRAY_SIZE(spaces); s++)
+                    for (unsigned flags = 0; flags < 4; flags++)
+                        failures += CheckRow(&all[i], &all[0], layout,
+                                             spaces[s], flags & 1,
+                                             flags & 2, src);
+            }
+        }
+
+    for (size_t i = 0; i < ARRAY_SIZE(all); i++)
+        printf("%s rows: %s\n", all[i].name,
+               all[i].rows != NULL ? "checked" : "not supported");
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "%u failure(s)\n", failures);
+        return 1;
+    }
+    return 0;
+}
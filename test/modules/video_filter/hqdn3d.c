@@ -0,0 +1,199 @@
+/*****************************************************************************
+ * hqdn3d.c: hqdn3d strips test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs the hqdn3d denoiser over the same pictures with one thread and with
+ * several ones, and checks that splitting the planes in strips does not
+ * change a single sample of the outputs.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+/* Not a multiple of the strip width, so that the last strip is narrower */
+#define WIDTH  712
+#define HEIGHT 200
+#define FRAMES 8
+
+static const unsigned threads[] = { 2, 3, 4, 8 };
+
+static filter_t *CreateFilter(vlc_object_t *parent, const video_format_t *fmt,
+                              unsigned count)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "filter-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "filter-threads", count);
+
+    es_format_InitFromVideo(&filter->fmt_in, fmt);
+    es_format_InitFromVideo(&filter->fmt_out, fmt);
+
+    filter->p_module = module_need(filter, "video filter", "hqdn3d", true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_out);
+        es_format_Clean(&filter->fmt_in);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static void DeleteFilter(filter_t *filter)
+{
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_out);
+    es_format_Clean(&filter->fmt_in);
+    vlc_object_delete(filter);
+}
+
+/* Filters all the pictures, and returns the outputs */
+static void Run(filter_t *filter, picture_t *const *in, picture_t **out)
+{
+    vlc_tick_t date = VLC_TICK_0;
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        picture_t *pic = picture_Hold(in[i]);
+        pic->date = date;
+        date += VLC_TICK_FROM_MS(40);
+
+        out[i] = filter->pf_video_filter(filter, pic);
+        assert(out[i] != NULL);
+        assert(out[i]->p_next == NULL);
+    }
+}
+
+static bool Compare(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+
+    for (int p = 0; p < a->i_planes; p++)
+    {
+        const plane_t *pa = &a->p[p], *pb = &b->p[p];
+
+        assert(pa->i_visible_lines == pb->i_visible_lines);
+        for (int y = 0; y < pa->i_visible_lines; y++)
+            if (memcmp(&pa->p_pixels[y * pa->i_pitch],
+                       &pb->p_pixels[y * pb->i_pitch],
+                       pa->i_visible_pitch))
+            {
+                fprintf(stderr, "plane %d, line %d differs\n", p, y);
+                return false;
+            }
+    }
+    return true;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, WIDTH, HEIGHT, WIDTH, HEIGHT,
+                       1, 1);
+
+    /* Noisy pictures, with edges, so that every filter stage has work */
+    picture_t *in[FRAMES];
+    unsigned seed = 42;
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        in[i] = picture_NewFromFormat(&fmt);
+        assert(in[i] != NULL);
+        for (int p = 0; p < in[i]->i_planes; p++)
+        {
+            plane_t *plane = &in[i]->p[p];
+            for (int y = 0; y < plane->i_lines; y++)
+                for (int x = 0; x < plane->i_pitch; x++)
+                    plane->p_pixels[y * plane->i_pitch + x] =
+                        ((x / 24 + y / 16 + i) & 1 ? 180 : 60)
+                        + rand_r(&seed) % 48;
+        }
+    }
+
+    filter_t *filter = CreateFilter(parent, &fmt, 1);
+    if (filter == NULL)
+    {
+        fprintf(stderr, "hqdn3d not available\n");
+        for (unsigned i = 0; i < FRAMES; i++)
+            picture_Release(in[i]);
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    picture_t *ref[FRAMES];
+    Run(filter, in, ref);
+    DeleteFilter(filter);
+
+    int ret = 0;
+
+    for (size_t t = 0; t < ARRAY_SIZE(threads); t++)
+    {
+        picture_t *out[FRAMES];
+
+        filter = CreateFilter(parent, &fmt, threads[t]);
+        assert(filter != NULL);
+        Run(filter, in, out);
+        DeleteFilter(filter);
+
+        for (unsigned i = 0; i < FRAMES; i++)
+        {
+            if (!Compare(ref[i], out[i]))
+            {
+                fprintf(stderr, "%u threads, picture %u differs\n",
+                        threads[t], i);
+                ret = 1;
+            }
+            picture_Release(out[i]);
+        }
+    }
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        picture_Release(ref[i]);
+        picture_Release(in[i]);
+    }
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * slices.c: slice-parallel video filters benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Reports the frame rate of the filters that split pictures in slices
+ * (yadif, hqdn3d and the I420 to RGB converter) at 1080p and 2160p, with
+ * 1, 2, 4 and 8 threads. Set VLC_SLICE_FRAMES to change the number of
+ * frames per run (default: 50).
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+struct bench
+{
+    const char *title;
+    const char *capability;
+    const char *modules;
+    vlc_fourcc_t chroma_out;
+};
+
+static const struct bench benches[] = {
+    { "yadif",    "video filter",    "deinterlace",               0 },
+    { "hqdn3d",   "video filter",    "hqdn3d",                    0 },
+    { "i420_rgb", "video converter", "i420_rgb_sse2,i420_rgb_mmx,i420_rgb",
+      VLC_CODEC_RGB32 },
+};
+
+static const unsigned sizes[][2] = {
+    { 1920, 1080 },
+    { 3840, 2160 },
+};
+
+static const unsigned threads[] = { 1, 2, 4, 8 };
+
+static filter_t *CreateFilter(vlc_object_t *parent, const struct bench *b,
+                              const video_format_t *fmt, unsigned count)
+{
+    filter_t *filter = vlc_object_create(parent, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "filter-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "filter-threads", count);
+    var_Create(filter, "sout-deinterlace-mode", VLC_VAR_STRING);
+    var_SetString(filter, "sout-deinterlace-mode", "yadif");
+
+    es_format_InitFromVideo(&filter->fmt_in, fmt);
+    es_format_InitFromVideo(&filter->fmt_out, fmt);
+    if (b->chroma_out != 0)
+    {
+        filter->fmt_out.i_codec = filter->fmt_out.video.i_chroma =
+            b->chroma_out;
+        filter->fmt_out.video.i_rmask = 0x00ff0000;
+        filter->fmt_out.video.i_gmask = 0x0000ff00;
+        filter->fmt_out.video.i_bmask = 0x000000ff;
+    }
+
+    filter->p_module = module_need(filter, b->capability, b->modules, true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_out);
+        es_format_Clean(&filter->fmt_in);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static void DeleteFilter(filter_t *filter)
+{
+    if (filter->pf_flush != NULL)
+        filter->pf_flush(filter);
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_out);
+    es_format_Clean(&filter->fmt_in);
+    vlc_object_delete(filter);
+}
+
+static void Bench(vlc_object_t *parent, const struct bench *b,
+                  unsigned width, unsigned height, unsigned count,
+                  unsigned frames)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, width, height, width, height,
+                       1, 1);
+    fmt.i_frame_rate = 25;
+    fmt.i_frame_rate_base = 1;
+
+    filter_t *filter = CreateFilter(parent, b, &fmt, count);
+    if (filter == NULL)
+    {
+        printf("%-8s %4ux%-4u %u threads: not available\n",
+               b->title, width, height, count);
+        return;
+    }
+
+    /* A few different pictures, so that the temporal filters work */
+    picture_t *pics[3];
+    for (unsigned i = 0; i < ARRAY_SIZE(pics); i++)
+    {
+        pics[i] = picture_NewFromFormat(&fmt);
+        assert(pics[i] != NULL);
+        for (int p = 0; p < pics[i]->i_planes; p++)
+        {
+            plane_t *plane = &pics[i]->p[p];
+            for (int y = 0; y < plane->i_lines; y++)
+                for (int x = 0; x < plane->i_pitch; x++)
+                    plane->p_pixels[y * plane->i_pitch + x] =
+                        (x * 7 + y * 13 + i * 61) ^ (y & 8 ? 0x55 : 0);
+        }
+        pics[i]->b_progressive = false;
+        pics[i]->i_nb_fields = 2;
+        pics[i]->b_top_field_first = true;
+    }
+
+    vlc_tick_t date = VLC_TICK_0;
+    vlc_tick_t start = 0;
+    unsigned out = 0;
+
+    /* Three warm up frames fill the history of the temporal filters */
+    for (unsigned i = 0; i < frames + 3; i++)
+    {
+        if (i == 3)
+            start = vlc_tick_now();
+
+        picture_t *pic = picture_Hold(pics[i % ARRAY_SIZE(pics)]);
+        pic->date = date;
+        date += VLC_TICK_FROM_MS(40);
+
+        for (picture_t *res = filter->pf_video_filter(filter, pic), *next;
+             res != NULL; res = next)
+        {
+            next = res->p_next;
+            res->p_next = NULL;
+            picture_Release(res);
+            if (i >= 3)
+                out++;
+        }
+    }
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("%-8s %4ux%-4u %u threads: %7.1f fps\n", b->title, width, height,
+           count, out / secf_from_vlc_tick(elapsed));
+
+    DeleteFilter(filter);
+    for (unsigned i = 0; i < ARRAY_SIZE(pics); i++)
+        picture_Release(pics[i]);
+}
+
+int main(void)
+{
+    unsigned frames = 50;
+    const char *env = getenv("VLC_SLICE_FRAMES");
+    if (env != NULL)
+        frames = strtoul(env, NULL, 10);
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    vlc_object_t *parent = VLC_OBJECT(vlc->p_libvlc_int);
+
+    for (size_t b = 0; b < ARRAY_SIZE(benches); b++)
+        for (size_t s = 0; s < ARRAY_SIZE(sizes); s++)
+            for (size_t t = 0; t < ARRAY_SIZE(threads); t++)
+                Bench(parent, &benches[b], sizes[s][0], sizes[s][1],
+                      threads[t], frames);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*****************************************************************************
+ * timeshift.c: timeshift benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Plays a live MPEG-TS stream at 100 Mbit/s, generated by the media
+ * callbacks, and pauses and resumes it a few times. As the stream cannot be
+ * paused, the input goes through the timeshift. For each round, it reports
+ * the pause and resume latencies, and how late the input read the stream
+ * while paused and after resuming, which grows when the timeshift storage
+ * cannot keep up.
+ *
+ * Environment variables:
+ *  VLC_TIMESHIFT_PAUSE: pause duration in seconds (default: 5)
+ *  VLC_TIMESHIFT_ROUNDS: number of pauses (default: 3)
+ * The timeshift options, such as --input-timeshift-path, can be given on
+ * the command line.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../libvlc/test.h"
+#include "../ts_gen.h"
+
+#include <vlc_common.h>
+
+#define BITRATE (100 * 1000 * 1000)
+#define FRAME_RATE 25
+#define FRAME_SIZE (BITRATE / 8 / FRAME_RATE)
+#define PID_PMT 0x1000
+#define PID_VIDEO 0x100
+
+struct source
+{
+    vlc_mutex_t lock;
+    vlc_tick_t  start;
+    uint64_t    sent;     /* bytes */
+    vlc_tick_t  max_lag;  /* since the last reset */
+    bool        stop;
+
+    /* Generator */
+    uint8_t     packet[TS_PACKET_SIZE];
+    size_t      packet_offset;
+    unsigned    packets;
+    uint64_t    frame;
+    size_t      frame_left;
+    uint8_t     cc[3]; /* PAT, PMT, video */
+};
+
+struct player
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    bool        playing;
+    bool        paused;
+};
+
+static void WritePAT(struct source *src)
+{
+    const uint8_t pat[] = {
+        0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0x00, 0x01, 0xe0 | (PID_PMT >> 8), PID_PMT & 0xff,
+    };
+    ts_write_section(src->packet, 0, &src->cc[0], pat, sizeof (pat));
+}
+
+static void WritePMT(struct source *src)
+{
+    const uint8_t pmt[] = {
+        0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00,
+        0x02, 0xe0 | (PID_VIDEO >> 8), PID_VIDEO & 0xff, 0xf0, 0x00,
+    };
+    ts_write_section(src->packet, PID_PMT, &src->cc[1], pmt, sizeof (pmt));
+}
+
+/* The first packet of a frame carries the PCR and the PES header */
+static void WriteFrameStart(struct source *src)
+{
+    uint8_t *p = src->packet;
+    const uint64_t ts = 90000 * src->frame / FRAME_RATE;
+    const uint64_t pcr = ts;
+
+    memset(p, 0, TS_PACKET_SIZE);
+    ts_write_header(p, PID_VIDEO, true, &src->cc[2]);
+    p[3] |= 0x20; /* adaptation field */
+    p[4] = 7;
+    p[5] = 0x10; /* PCR */
+    p[6] = pcr >> 25;
+    p[7] = pcr >> 17;
+    p[8] = pcr >> 9;
+    p[9] = pcr >> 1;
+    p[10] = ((pcr & 1) << 7) | 0x7e;
+    p[11] = 0;
+
+    uint8_t *pes = &p[12];
+    pes[0] = 0x00; pes[1] = 0x00; pes[2] = 0x01; pes[3] = 0xe0;
+    pes[4] = 0; pes[5] = 0; /* unbounded */
+    pes[6] = 0x80;
+    pes[7] = 0xc0; /* PTS and DTS */
+    pes[8] = 10;
+    ts_write_timestamp(&pes[9], 3, ts + 9000);
+    ts_write_timestamp(&pes[14], 1, ts);
+
+    /* Picture start code, the rest of the payload is zeroes */
+    uint8_t *es = &pes[19];
+    es[2] = 0x01;
+
+    src->frame_left = FRAME_SIZE - (TS_PACKET_SIZE - 12 - 19);
+    src->frame++;
+}
+
+static void NextPacket(struct source *src)
+{
+    if (src->packets % 2000 == 0)
+        WritePAT(src);
+    else if (src->packets % 2000 == 1)
+        WritePMT(src);
+    else if (src->frame_left == 0)
+        WriteFrameStart(src);
+    else
+    {
+        uint8_t *p = src->packet;
+
+        memset(p, 0, TS_PACKET_SIZE);
+        ts_write_header(p, PID_VIDEO, false, &src->cc[2]);
+        if (src->frame_left > TS_PACKET_SIZE - 4)
+            src->frame_left -= TS_PACKET_SIZE - 4;
+        else
+            src->frame_left = 0;
+    }
+    src->packets++;
+    src->packet_offset = 0;
+}
+
+static int Open(void *opaque, void **datap, uint64_t *sizep)
+{
+    struct source *src = opaque;
+
+    src->start = vlc_tick_now();
+    src->sent = 0;
+    src->packet_offset = TS_PACKET_SIZE;
+    *datap = src;
+    *sizep = UINT64_MAX;
+    return 0;
+}
+
+static ssize_t Read(void *opaque, unsigned char *buf, size_t len)
+{
+    struct source *src = opaque;
+    const size_t chunk = 7 * TS_PACKET_SIZE;
+
+    vlc_mutex_lock(&src->lock);
+    for (;;)
+    {
+        if (src->stop)
+        {
+            vlc_mutex_unlock(&src->lock);
+            return 0;
+        }
+
+        /* When the next chunk is due at the stream bitrate */
+        vlc_tick_t due = src->start
+                       + vlc_tick_from_samples(src->sent * 8, BITRATE);
+        vlc_tick_t now = vlc_tick_now();
+
+        if (now >= due)
+        {
+            if (now - due > src->max_lag)
+                src->max_lag = now - due;
+            break;
+        }
+        vlc_mutex_unlock(&src->lock);
+        vlc_tick_sleep(__MIN(due - now, VLC_TICK_FROM_MS(10)));
+        vlc_mutex_lock(&src->lock);
+    }
+
+    if (len > chunk)
+        len = chunk;
+    for (size_t done = 0; done < len;)
+    {
+        if (src->packet_offset >= TS_PACKET_SIZE)
+            NextPacket(src);
+
+        size_t copy = __MIN(len - done, TS_PACKET_SIZE - src->packet_offset);
+        memcpy(buf + done, src->packet + src->packet_offset, copy);
+        src->packet_offset += copy;
+        done += copy;
+    }
+    src->sent += len;
+    vlc_mutex_unlock(&src->lock);
+    return len;
+}
+
+static void Close(void *opaque)
+{
+    (void) opaque;
+}
+
+static vlc_tick_t ResetLag(struct source *src)
+{
+    vlc_mutex_lock(&src->lock);
+    vlc_tick_t lag = src->max_lag;
+    src->max_lag = 0;
+    vlc_mutex_unlock(&src->lock);
+    return lag;
+}
+
+static void OnEvent(const libvlc_event_t *event, void *data)
+{
+    struct player *p = data;
+
+    vlc_mutex_lock(&p->lock);
+    if (event->type == libvlc_MediaPlayerPlaying)
+        p->playing = true;
+    else
+        p->paused = true;
+    vlc_cond_signal(&p->wait);
+    vlc_mutex_unlock(&p->lock);
+}
+
+static vlc_tick_t WaitEvent(struct player *p, bool *flag)
+{
+    vlc_tick_t start = vlc_tick_now();
+
+    vlc_mutex_lock(&p->lock);
+    while (!*flag)
+        vlc_cond_wait(&p->wait, &p->lock);
+    *flag = false;
+    vlc_mutex_unlock(&p->lock);
+    return vlc_tick_now() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    const unsigned pause = test_getenv_uint("VLC_TIMESHIFT_PAUSE", 5);
+    const unsigned rounds = test_getenv_uint("VLC_TIMESHIFT_ROUNDS", 3);
+    const char *args[test_defaults_nargs + argc];
+    int nargs = 0;
+
+    test_init();
+
+    for (int i = 0; i < test_defaults_nargs; i++)
+        args[nargs++] = test_defaults_args[i];
+    for (int i = 1; i < argc; i++)
+        args[nargs++] = argv[i];
+
+    libvlc_instance_t *vlc = libvlc_new(nargs, args);
+    assert(vlc != NULL);
+
+    struct source src = { .max_lag = 0 };
+    vlc_mutex_init(&src.lock);
+
+    struct player p = { .playing = false };
+    vlc_mutex_init(&p.lock);
+    vlc_cond_init(&p.wait);
+
+    libvlc_media_t *md = libvlc_media_new_callbacks(vlc, Open, Read, NULL,
+                                                    Close, &src);
+    assert(md != NULL);
+    libvlc_media_add_option(md, ":demux=ts");
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    libvlc_event_attach(em, libvlc_MediaPlayerPlaying, OnEvent, &p);
+    libvlc_event_attach(em, libvlc_MediaPlayerPaused, OnEvent, &p);
+
+    int ret = libvlc_media_player_play(mp);
+    assert(ret == 0);
+    WaitEvent(&p, &p.playing);
+    vlc_tick_sleep(VLC_TICK_FROM_SEC(2));
+
+    printf("%u Mbit/s, %u s pauses (%u MiB each)\n", BITRATE / 1000000,
+           pause, (unsigned)((uint64_t)BITRATE / 8 * pause / (1024 * 1024)));
+
+    for (unsigned i = 0; i < rounds; i++)
+    {
+        ResetLag(&src);
+        libvlc_media_player_set_pause(mp, 1);
+        vlc_tick_t pause_latency = WaitEvent(&p, &p.paused);
+
+        vlc_tick_sleep(VLC_TICK_FROM_SEC(pause));
+        vlc_tick_t paused_lag = ResetLag(&src);
+
+        libvlc_media_player_set_pause(mp, 0);
+        vlc_tick_t resume_latency = WaitEvent(&p, &p.playing);
+
+        vlc_tick_sleep(VLC_TICK_FROM_SEC(pause));
+        vlc_tick_t playing_lag = ResetLag(&src);
+
+        printf("round %u: pause %6.1f ms, resume %6.1f ms, "
+               "input lag paused %6.1f ms, after resume %6.1f ms\n", i + 1,
+               secf_from_vlc_tick(pause_latency) * 1000.,
+               secf_from_vlc_tick(resume_latency) * 1000.,
+               secf_from_vlc_tick(paused_lag) * 1000.,
+               secf_from_vlc_tick(playing_lag) * 1000.);
+    }
+
+    vlc_mutex_lock(&src.lock);
+    src.stop = true;
+    vlc_mutex_unlock(&src.lock);
+
+    libvlc_media_player_release(mp);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*****************************************************************************
+ * filter_pipeline.c: pipelined video filter chain test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#define MODULE_NAME test_filter_pipeline
+#define MODULE_STRING "test_filter_pipeline"
+#undef __PLUGIN__
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define PICTURES 40
+#define FLUSH_AT 17
+/* Double outputs not taken yet: the queue of the second stage, with the
+ * two pictures of the last input, the picture being filtered, the output
+ * queue, and the pictures Double is returning */
+#define MAX_OUTSTANDING 8
+
+static atomic_uint produced;
+
+/* Outputs each picture followed by a copy dated one tick later */
+static picture_t *Double(filter_t *filter, picture_t *pic)
+{
+    picture_t *copy = filter_NewPicture(filter);
+    if (copy != NULL)
+    {
+        picture_CopyProperties(copy, pic);
+        copy->date = pic->date + 1;
+        pic->p_next = copy;
+    }
+    atomic_fetch_add(&produced, copy != NULL ? 2 : 1);
+    return pic;
+}
+
+/* Takes some time, so that the owner waits for the pipeline */
+static picture_t *Slow(filter_t *filter, picture_t *pic)
+{
+    (void) filter;
+    vlc_tick_sleep(VLC_TICK_FROM_MS(1));
+    return pic;
+}
+
+static int OpenDouble(vlc_object_t *obj)
+{
+    ((filter_t *)obj)->pf_video_filter = Double;
+    return VLC_SUCCESS;
+}
+
+static int OpenSlow(vlc_object_t *obj)
+{
+    ((filter_t *)obj)->pf_video_filter = Slow;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("video filter", 0)
+    set_callback(OpenDouble)
+    add_shortcut("test_double")
+    add_submodule()
+        set_capability("video filter", 0)
+        set_callback(OpenSlow)
+        add_shortcut("test_slow")
+vlc_module_end()
+
+typedef int (*vlc_plugin_cb)(int (*)(void *, void *, int, ...), void *);
+
+VLC_EXPORT vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+struct output
+{
+    vlc_tick_t next; /* expected date */
+    unsigned count;
+    unsigned received;
+};
+
+static void Receive(struct output *out, picture_t *pic)
+{
+    assert(pic->p_next == NULL);
+    assert(pic->date == out->next);
+    out->next = pic->date + 1;
+    out->count++;
+    out->received++;
+    picture_Release(pic);
+
+    /* a slow owner lets the pipeline fill up */
+    vlc_tick_sleep(VLC_TICK_FROM_US(500));
+}
+
+static void Push(filter_chain_t *chain, struct output *out, vlc_tick_t date)
+{
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_I420);
+    video_format_Setup(&fmt.video, VLC_CODEC_I420, 16, 16, 16, 16, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt.video);
+    assert(pic != NULL);
+    pic->date = date;
+
+    /* take all the ready pictures, as filter_chain_VideoFilter() callers
+     * must do */
+    for (pic = filter_chain_VideoFilter(chain, pic); pic != NULL;
+         pic = filter_chain_VideoFilter(chain, NULL))
+        Receive(out, pic);
+
+    unsigned outstanding = atomic_load(&produced) - out->received;
+    assert(outstanding <= MAX_OUTSTANDING);
+    es_format_Clean(&fmt);
+}
+
+static void Drain(filter_chain_t *chain, struct output *out)
+{
+    picture_t *pic;
+
+    while ((pic = filter_chain_VideoDrain(chain)) != NULL)
+        Receive(out, pic);
+}
+
+static void test_pipeline(vlc_object_t *obj, bool flush)
+{
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_I420);
+    video_format_Setup(&fmt.video, VLC_CODEC_I420, 16, 16, 16, 16, 1, 1);
+
+    filter_chain_t *chain = filter_chain_NewVideo(obj, false, NULL);
+    assert(chain != NULL);
+    filter_chain_Reset(chain, &fmt, NULL, &fmt);
+    filter_t *filter = filter_chain_AppendFilter(chain, "test_double", NULL,
+                                                 NULL);
+    assert(filter != NULL);
+    filter = filter_chain_AppendFilter(chain, "test_slow", NULL, NULL);
+    assert(filter != NULL);
+    filter_chain_SetPipeline(chain, 2);
+
+    atomic_store(&produced, 0);
+    struct output out = { .next = VLC_TICK_0, .count = 0, .received = 0 };
+    unsigned i = 0;
+
+    if (flush)
+    {
+        for (; i < FLUSH_AT; i++)
+            Push(chain, &out, VLC_TICK_0 + 2 * i);
+        filter_chain_VideoFlush(chain);
+
+        /* pictures queued before the flush are dropped */
+        atomic_store(&produced, out.received);
+        out.next = VLC_TICK_0 + 2 * i;
+        out.count = 0;
+    }
+
+    for (; i < PICTURES; i++)
+        Push(chain, &out, VLC_TICK_0 + 2 * i);
+    Drain(chain, &out);
+
+    assert(out.next == VLC_TICK_0 + 2 * PICTURES);
+    assert(out.count == 2 * (PICTURES - (flush ? FLUSH_AT : 0)));
+
+    filter_chain_Delete(chain);
+    es_format_Clean(&fmt);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    test_pipeline(obj, false);
+    test_pipeline(obj, true);
+
+    libvlc_release(vlc);
+    return 0;
+}
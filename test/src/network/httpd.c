@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * httpd.c: HTTP server load test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Streams data through an httpd_stream_t to many loopback clients, and
+ * measures the aggregated throughput. Tunables (environment):
+ *  VLC_HTTPD_CLIENTS  number of clients (default 1000)
+ *  VLC_HTTPD_THREADS  number of server threads (default 1, 0 = per CPU)
+ *  VLC_HTTPD_SECONDS  duration of the measurement (default 5)
+ * Set VLC_TEST_TIMEOUT accordingly for long runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_httpd.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define TEST_PORT 18081
+#define TEST_BLOCK_SIZE (7 * 188)
+
+static atomic_bool feeding;
+
+static void *Feed(void *data)
+{
+    httpd_stream_t *stream = data;
+    block_t *block = block_Alloc(TEST_BLOCK_SIZE);
+
+    assert(block != NULL);
+    memset(block->p_buffer, 0x47, block->i_buffer);
+
+    while (atomic_load(&feeding)) {
+        httpd_StreamSend(stream, block);
+        vlc_tick_sleep(VLC_TICK_FROM_US(100));
+    }
+    block_Release(block);
+    return NULL;
+}
+
+static int Connect(void)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    static const char req[] = "GET /stream HTTP/1.0\r\n\r\n";
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+        return -1;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof (addr))
+     || write(fd, req, strlen(req)) != (ssize_t)strlen(req)) {
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+int main(void)
+{
+    unsigned clients = test_getenv_uint("VLC_HTTPD_CLIENTS", 1000);
+    unsigned threads = test_getenv_uint("VLC_HTTPD_THREADS", 1);
+    unsigned seconds = test_getenv_uint("VLC_HTTPD_SECONDS", 5);
+    char port_arg[32], threads_arg[32];
+
+    test_init();
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < 2 * clients + 64)
+    {
+        rl.rlim_cur = __MIN(rl.rlim_max, 2 * clients + 64);
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    snprintf(port_arg, sizeof (port_arg), "--http-port=%u", TEST_PORT);
+    snprintf(threads_arg, sizeof (threads_arg), "--http-threads=%u", threads);
+
+    const char *argv[] = { "-v", port_arg, threads_arg };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    httpd_host_t *host = vlc_http_HostNew(obj);
+    assert(host != NULL);
+
+    httpd_stream_t *stream = httpd_StreamNew(host, "/stream",
+                                             "application/octet-stream",
+                                             NULL, NULL);
+    assert(stream != NULL);
+
+    atomic_init(&feeding, true);
+
+    vlc_thread_t feeder;
+    int ret = vlc_clone(&feeder, Feed, stream, VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+
+    struct pollfd *ufd = malloc(clients * sizeof (*ufd));
+    assert(ufd != NULL);
+
+    unsigned connected = 0;
+    for (unsigned i = 0; i < clients; i++) {
+        ufd[connected].fd = Connect();
+        ufd[connected].events = POLLIN;
+        if (ufd[connected].fd != -1)
+            connected++;
+    }
+    printf("%u/%u clients connected, %u server thread(s)\n", connected,
+           clients, threads);
+
+    static char buf[65536];
+    uint64_t total = 0;
+    unsigned closed = 0;
+    vlc_tick_t start = vlc_tick_now();
+    vlc_tick_t deadline = start + VLC_TICK_FROM_SEC(seconds);
+
+    while (vlc_tick_now() < deadline) {
+        if (poll(ufd, connected, 100) <= 0)
+            continue;
+
+        for (unsigned i = 0; i < connected; i++) {
+            if (ufd[i].fd == -1 || ufd[i].revents == 0)
+                continue;
+
+            ssize_t val = read(ufd[i].fd, buf, sizeof (buf));
+            if (val > 0)
+                total += val;
+            else if (val == 0 || errno != EAGAIN) {
+                close(ufd[i].fd);
+                ufd[i].fd = -1;
+                closed++;
+            }
+        }
+    }
+
+    double elapsed = secf_from_vlc_tick(vlc_tick_now() - start);
+    printf("received %"PRIu64" bytes in %.2f s: %.1f MiB/s "
+           "(%.1f kiB/s per client), %u disconnection(s)\n", total, elapsed,
+           total / elapsed / 1048576., total / elapsed / 1024. / connected,
+           closed);
+
+    for (unsigned i = 0; i < connected; i++)
+        if (ufd[i].fd != -1)
+            close(ufd[i].fd);
+    free(ufd);
+
+    atomic_store(&feeding, false);
+    vlc_join(feeder, NULL);
+
+    httpd_StreamDelete(stream);
+    httpd_HostDelete(host);
+    libvlc_release(vlc);
+    return (connected > 0 && total > 0) ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * ts_gen.h: MPEG transport stream generation helpers for tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TEST_TS_GEN_H
+#define TEST_TS_GEN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TS_PACKET_SIZE 188
+
+/* MPEG-2 CRC of the PSI sections */
+static inline uint32_t ts_crc32(const uint8_t *data, size_t size)
+{
+    uint32_t crc = 0xffffffff;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= (uint32_t)data[i] << 24;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+    }
+    return crc;
+}
+
+/* Writes the 4 bytes packet header, with a payload only */
+static inline void ts_write_header(uint8_t *p, unsigned pid, bool start,
+                                   uint8_t *cc)
+{
+    p[0] = 0x47;
+    p[1] = (start ? 0x40 : 0) | (pid >> 8);
+    p[2] = pid & 0xff;
+    p[3] = 0x10 | (*cc & 0x0f);
+    *cc = (*cc + 1) & 0x0f;
+}
+
+/* Writes a whole packet carrying a section, without its CRC, which is
+ * appended */
+static inline void ts_write_section(uint8_t *p, unsigned pid, uint8_t *cc,
+                                    const uint8_t *section, size_t size)
+{
+    memset(p, 0xff, TS_PACKET_SIZE);
+    ts_write_header(p, pid, true, cc);
+    p[4] = 0; /* pointer field */
+    memcpy(&p[5], section, size);
+
+    uint32_t crc = ts_crc32(section, size);
+    p[5 + size] = crc >> 24;
+    p[6 + size] = crc >> 16;
+    p[7 + size] = crc >> 8;
+    p[8 + size] = crc;
+}
+
+/* Writes a PES PTS or DTS field */
+static inline void ts_write_timestamp(uint8_t *p, unsigned prefix,
+                                      uint64_t ts)
+{
+    p[0] = (prefix << 4) | ((ts >> 29) & 0x0e) | 1;
+    p[1] = ts >> 22;
+    p[2] = ((ts >> 14) & 0xfe) | 1;
+    p[3] = ts >> 7;
+    p[4] = ((ts << 1) & 0xfe) | 1;
+}
+
+#endif /* TEST_TS_GEN_H */